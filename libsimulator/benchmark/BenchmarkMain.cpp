@@ -1,5 +1,10 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
+#include "benchmarkAgentInsertion.hpp"
+#include "benchmarkAgentReordering.hpp"
 #include "benchmarkCollisionGeometry.hpp"
+#include "benchmarkLineSegment.hpp"
+#include "benchmarkNeighborhoodSearch.hpp"
+#include "benchmarkRoutingEngine.hpp"
 
 #include <benchmark/benchmark.h>
 
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "CollisionFreeSpeedModel.hpp"
+#include "CollisionFreeSpeedModelData.hpp"
+#include "GenericAgent.hpp"
+#include "GeometryBuilder.hpp"
+#include "Journey.hpp"
+#include "Point.hpp"
+#include "Polygon.hpp"
+#include "Simulation.hpp"
+#include "StageDescription.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+/// Adds 20k agents to an empty simulation using 4 threads.
+///
+/// The argument selects how agents are added: 0 adds them one by one with 'AddAgent', 1 adds all
+/// of them with a single 'AddAgents'.
+void bmAddAgents(benchmark::State& state)
+{
+    constexpr double extent = 200;
+    constexpr double spacing = 0.8;
+    constexpr size_t agentCount = 20000;
+    const auto geometry =
+        GeometryBuilder()
+            .AddAccessibleArea({{0, 0}, {extent, 0}, {extent, extent}, {0, extent}})
+            .Build();
+
+    std::vector<Point> positions{};
+    for(double x = 1; x < extent - 20 && positions.size() < agentCount; x += spacing) {
+        for(double y = 1; y < extent - 1 && positions.size() < agentCount; y += spacing) {
+            positions.push_back({x, y});
+        }
+    }
+
+    for(auto _ : state) {
+        state.PauseTiming();
+        auto simulation = std::make_unique<Simulation>(
+            std::make_unique<CollisionFreeSpeedModel>(8, 0.1, 5, 0.02),
+            std::make_unique<CollisionGeometry>(geometry),
+            0.01,
+            4);
+        const auto exit = simulation->AddStage(ExitDescription{Polygon(
+            {{extent - 1, 0}, {extent, 0}, {extent, extent}, {extent - 1, extent}})});
+        const auto journey = simulation->AddJourney({{exit, NonTransitionDescription{}}});
+        std::vector<GenericAgent> agents{};
+        agents.reserve(positions.size());
+        for(const auto& pos : positions) {
+            agents.emplace_back(
+                GenericAgent::ID{}, journey, exit, pos, Point{1, 0}, CollisionFreeSpeedModelData{});
+        }
+        state.ResumeTiming();
+
+        if(state.range(0) == 0) {
+            for(const auto& agent : agents) {
+                simulation->AddAgent(agent);
+            }
+        } else {
+            simulation->AddAgents(agents);
+        }
+        benchmark::DoNotOptimize(simulation->AgentCount());
+
+        // Destroying the simulation is not part of the measurement
+        state.PauseTiming();
+        simulation.reset();
+        state.ResumeTiming();
+    }
+}
+
+BENCHMARK(bmAddAgents)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "CollisionFreeSpeedModel.hpp"
+#include "CollisionFreeSpeedModelData.hpp"
+#include "GenericAgent.hpp"
+#include "GeometryBuilder.hpp"
+#include "Journey.hpp"
+#include "Point.hpp"
+#include "Polygon.hpp"
+#include "Simulation.hpp"
+#include "StageDescription.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+/// Iterates a simulation of 50k agents that have been added in random order.
+///
+/// The argument is the interval in iterations in which the agents are sorted along a space
+/// filling curve, 0 keeps the order in which they have been added. The counter
+/// 'operational_us' is the mean duration of the operational phase.
+void bmIterateShuffledAgents(benchmark::State& state)
+{
+    constexpr double extent = 200;
+    constexpr double spacing = 0.8;
+    auto geometry = GeometryBuilder()
+                        .AddAccessibleArea({{0, 0}, {extent, 0}, {extent, extent}, {0, extent}})
+                        .Build();
+    Simulation simulation(
+        std::make_unique<CollisionFreeSpeedModel>(8, 0.1, 5, 0.02),
+        std::make_unique<CollisionGeometry>(geometry),
+        0.01);
+    simulation.SetAgentReorderInterval(static_cast<uint64_t>(state.range(0)));
+    simulation.SetTracing(true);
+
+    const auto exit = simulation.AddStage(ExitDescription{Polygon(
+        {{extent - 1, 0}, {extent, 0}, {extent, extent}, {extent - 1, extent}})});
+    const auto journey = simulation.AddJourney({{exit, NonTransitionDescription{}}});
+
+    std::vector<Point> positions{};
+    for(double x = 1; x < extent - 20 && positions.size() < 50000; x += spacing) {
+        for(double y = 1; y < extent - 1 && positions.size() < 50000; y += spacing) {
+            positions.push_back({x, y});
+        }
+    }
+    std::shuffle(std::begin(positions), std::end(positions), std::mt19937{42});
+    for(const auto& pos : positions) {
+        simulation.AddAgent(GenericAgent(
+            GenericAgent::ID{}, journey, exit, pos, Point{1, 0}, CollisionFreeSpeedModelData{}));
+    }
+
+    uint64_t operationalDuration{0};
+    for(auto _ : state) {
+        simulation.Iterate();
+        operationalDuration += simulation.GetLastStats().OpDecSystemRunDuration();
+    }
+    state.counters["operational_us"] = benchmark::Counter(
+        static_cast<double>(operationalDuration), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(bmIterateShuffledAgents)
+    ->Arg(0)
+    ->Arg(100)
+    ->Iterations(200)
+    ->Unit(benchmark::kMillisecond);
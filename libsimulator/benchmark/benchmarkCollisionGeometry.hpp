@@ -29,6 +29,59 @@ void bmLineSegmentsInApproxDistanceTo(benchmark::State& state, Args&&... args)
     }
 }
 
+template <class... Args>
+void bmInsideGeometry(benchmark::State& state, Args&&... args)
+{
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto geometry = std::move(std::get<CollisionGeometry>(args_tuple));
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(geometry.InsideGeometry({0, 0}));
+        benchmark::ClobberMemory();
+    }
+}
+
+template <class... Args>
+void bmIntersectsAnyNearby(benchmark::State& state, Args&&... args)
+{
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto geometry = std::move(std::get<CollisionGeometry>(args_tuple));
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(geometry.IntersectsAny({{0, 0}, {2, 3}}));
+        benchmark::ClobberMemory();
+    }
+}
+
+/// Builds the collision geometry from its accessible area, including the point location grid and
+/// the cell visibility cache.
+template <class... Args>
+void bmConstructCollisionGeometry(benchmark::State& state, Args&&... args)
+{
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    const auto polygon = std::get<CollisionGeometry>(args_tuple).Polygon();
+
+    for(auto _ : state) {
+        CollisionGeometry geometry(polygon);
+        benchmark::DoNotOptimize(geometry);
+        benchmark::ClobberMemory();
+    }
+}
+
+/// Copies the collision geometry, as done by Simulation::Geo.
+template <class... Args>
+void bmCopyCollisionGeometry(benchmark::State& state, Args&&... args)
+{
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto geometry = std::move(std::get<CollisionGeometry>(args_tuple));
+
+    for(auto _ : state) {
+        CollisionGeometry copy(geometry);
+        benchmark::DoNotOptimize(copy);
+        benchmark::ClobberMemory();
+    }
+}
+
 BENCHMARK_CAPTURE(bmLineSegmentsInDistanceTo, large_street_network, buildLargeStreetNetwork());
 
 BENCHMARK_CAPTURE(bmLineSegmentsInDistanceTo, grosser_stern, buildGrosserStern());
@@ -39,3 +92,23 @@ BENCHMARK_CAPTURE(
     buildLargeStreetNetwork());
 
 BENCHMARK_CAPTURE(bmLineSegmentsInApproxDistanceTo, grosser_stern, buildGrosserStern());
+
+BENCHMARK_CAPTURE(bmInsideGeometry, large_street_network, buildLargeStreetNetwork());
+
+BENCHMARK_CAPTURE(bmInsideGeometry, grosser_stern, buildGrosserStern());
+
+BENCHMARK_CAPTURE(bmIntersectsAnyNearby, large_street_network, buildLargeStreetNetwork());
+
+BENCHMARK_CAPTURE(bmIntersectsAnyNearby, grosser_stern, buildGrosserStern());
+
+BENCHMARK_CAPTURE(bmConstructCollisionGeometry, large_street_network, buildLargeStreetNetwork())
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(bmConstructCollisionGeometry, grosser_stern, buildGrosserStern())
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(bmCopyCollisionGeometry, large_street_network, buildLargeStreetNetwork())
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(bmCopyCollisionGeometry, grosser_stern, buildGrosserStern())
+    ->Unit(benchmark::kMillisecond);
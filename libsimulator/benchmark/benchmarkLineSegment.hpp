@@ -2,11 +2,17 @@
 
 #pragma once
 
+#include "GeometricFunctions.hpp"
 #include "LineSegment.hpp"
 #include "Point.hpp"
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
 template <class... Args>
 void bmDistToOnLine(benchmark::State& state, Args&&... args)
 {
@@ -51,3 +57,70 @@ BENCHMARK_CAPTURE(bmDistTo, dist_to_point, LineSegment(Point(-1.3, 2.1), Point(3
     ->DenseRange(-50, 150, 10)
     ->Arg(-100000)
     ->Arg(100000);
+
+/// Random line segments of length up to 'maxLength' in a square of size 'extend'.
+inline std::vector<LineSegment> randomLineSegments(size_t count, double extend, double maxLength)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> position(0., extend);
+    std::uniform_real_distribution<double> offset(-maxLength, maxLength);
+    std::vector<LineSegment> segments{};
+    segments.reserve(count);
+    for(size_t index = 0; index < count; ++index) {
+        const Point p1{position(gen), position(gen)};
+        segments.emplace_back(p1, p1 + Point{offset(gen), offset(gen)});
+    }
+    return segments;
+}
+
+template <typename Predicate>
+void bmIntersects(benchmark::State& state, Predicate predicate)
+{
+    const auto segments = randomLineSegments(1024, 10., 2.);
+
+    size_t index = 0;
+    for(auto _ : state) {
+        const auto& l1 = segments[index % segments.size()];
+        const auto& l2 = segments[(index + 1) % segments.size()];
+        benchmark::DoNotOptimize(predicate(l1, l2));
+        ++index;
+    }
+}
+
+BENCHMARK_CAPTURE(bmIntersects, cgal, [](const auto& l1, const auto& l2) {
+    return intersectsWithCGAL(l1, l2);
+});
+
+BENCHMARK_CAPTURE(bmIntersects, filtered, [](const auto& l1, const auto& l2) {
+    return intersects(l1, l2);
+});
+
+/// Tests a line of sight against 'state.range(0)' walls, hardly any of which intersect it, so
+/// that all walls need to be checked.
+void bmIntersectsAnyScalar(benchmark::State& state)
+{
+    const auto walls = randomLineSegments(state.range(0), 100., 2.);
+    const LineSegment sight{{50., 50.}, {50.5, 51.}};
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(std::any_of(
+            std::begin(walls), std::end(walls), [&sight](const auto& wall) {
+                return intersects(sight, wall);
+            }));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void bmIntersectsAnyPacked(benchmark::State& state)
+{
+    const PackedLineSegments walls(randomLineSegments(state.range(0), 100., 2.));
+    const LineSegment sight{{50., 50.}, {50.5, 51.}};
+
+    for(auto _ : state) {
+        benchmark::DoNotOptimize(intersectsAny(sight, walls));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(bmIntersectsAnyScalar)->RangeMultiplier(4)->Range(4, 1024);
+BENCHMARK(bmIntersectsAnyPacked)->RangeMultiplier(4)->Range(4, 1024);
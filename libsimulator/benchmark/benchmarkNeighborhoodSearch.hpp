@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AABB.hpp"
+#include "AgentNeighborhoodSearch.hpp"
+#include "AgentStore.hpp"
+#include "AnticipationVelocityModel.hpp"
+#include "CollisionFreeSpeedModel.hpp"
+#include "CollisionFreeSpeedModelV2.hpp"
+#include "GeneralizedCentrifugalForceModel.hpp"
+#include "GenericAgent.hpp"
+#include "OperationalModel.hpp"
+#include "SocialForceModel.hpp"
+#include "WorkerPool.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+/// Queries the neighbors of all agents with the interaction range of 'model'.
+///
+/// Compares the cell size of 2.2 formerly used for all models with the cell size derived from the
+/// interaction range of the model. The argument is the density in agents per 100 m^2.
+template <typename ModelData>
+void neighborhoodQueries(benchmark::State& state, const OperationalModel& model, bool fixedCellSize)
+{
+    const auto interactionRange = model.InteractionRange();
+    const auto cellSize =
+        fixedCellSize ? 2.2 : AgentNeighborhoodSearch::CellSizeFor(interactionRange);
+    constexpr size_t agentCount = 15000;
+    const auto extent = std::sqrt(agentCount * 100.0 / static_cast<double>(state.range(0)));
+    AgentStore agents{};
+    std::mt19937 gen{42};
+    std::uniform_real_distribution<double> coordinate{0, extent};
+    for(size_t index = 0; index < agentCount; ++index) {
+        agents.Add(GenericAgent(
+            GenericAgent::ID{},
+            jps::UniqueID<Journey>::Invalid,
+            jps::UniqueID<BaseStage>::Invalid,
+            Point{coordinate(gen), coordinate(gen)},
+            Point{1, 0},
+            ModelData{}));
+    }
+    AgentNeighborhoodSearch neighborhoodSearch{agents, cellSize};
+    neighborhoodSearch.SetBounds(AABB{Point{0, 0}, Point{extent, extent}});
+    WorkerPool pool{1};
+    neighborhoodSearch.Update(pool);
+
+    for(auto _ : state) {
+        size_t count{};
+        for(const auto& pos : agents.Positions()) {
+            neighborhoodSearch.ForEachNeighbor(
+                pos, interactionRange, [&count](ConstAgentRef) { ++count; });
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * agentCount);
+}
+
+template <class... Args>
+void bmCollisionFreeSpeedModelQueries(benchmark::State& state, Args&&... args)
+{
+    const CollisionFreeSpeedModel model(8, 0.1, 5, 0.02);
+    neighborhoodQueries<CollisionFreeSpeedModelData>(state, model, args...);
+}
+
+template <class... Args>
+void bmCollisionFreeSpeedModelV2Queries(benchmark::State& state, Args&&... args)
+{
+    const CollisionFreeSpeedModelV2 model{};
+    neighborhoodQueries<CollisionFreeSpeedModelV2Data>(state, model, args...);
+}
+
+template <class... Args>
+void bmAnticipationVelocityModelQueries(benchmark::State& state, Args&&... args)
+{
+    const AnticipationVelocityModel model(0.1, 42);
+    neighborhoodQueries<AnticipationVelocityModelData>(state, model, args...);
+}
+
+template <class... Args>
+void bmSocialForceModelQueries(benchmark::State& state, Args&&... args)
+{
+    const SocialForceModel model(120000, 240000);
+    neighborhoodQueries<SocialForceModelData>(state, model, args...);
+}
+
+template <class... Args>
+void bmGeneralizedCentrifugalForceModelQueries(benchmark::State& state, Args&&... args)
+{
+    const GeneralizedCentrifugalForceModel model(0.3, 0.2, 2, 2, 0.1, 0.1, 3, 3);
+    neighborhoodQueries<GeneralizedCentrifugalForceModelData>(state, model, args...);
+}
+
+BENCHMARK_CAPTURE(bmCollisionFreeSpeedModelQueries, fixed_cell_size, true)->Arg(50)->Arg(150)->Arg(400);
+BENCHMARK_CAPTURE(bmCollisionFreeSpeedModelQueries, model_cell_size, false)->Arg(50)->Arg(150)->Arg(400);
+
+BENCHMARK_CAPTURE(bmCollisionFreeSpeedModelV2Queries, fixed_cell_size, true)->Arg(50)->Arg(150)->Arg(400);
+BENCHMARK_CAPTURE(bmCollisionFreeSpeedModelV2Queries, model_cell_size, false)->Arg(50)->Arg(150)->Arg(400);
+
+BENCHMARK_CAPTURE(bmAnticipationVelocityModelQueries, fixed_cell_size, true)->Arg(50)->Arg(150)->Arg(400);
+BENCHMARK_CAPTURE(bmAnticipationVelocityModelQueries, model_cell_size, false)->Arg(50)->Arg(150)->Arg(400);
+
+BENCHMARK_CAPTURE(bmSocialForceModelQueries, fixed_cell_size, true)->Arg(50)->Arg(150)->Arg(400);
+BENCHMARK_CAPTURE(bmSocialForceModelQueries, model_cell_size, false)->Arg(50)->Arg(150)->Arg(400);
+
+BENCHMARK_CAPTURE(bmGeneralizedCentrifugalForceModelQueries, fixed_cell_size, true)->Arg(50)->Arg(150)->Arg(400);
+BENCHMARK_CAPTURE(bmGeneralizedCentrifugalForceModelQueries, model_cell_size, false)->Arg(50)->Arg(150)->Arg(400);
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "CollisionGeometry.hpp"
+#include "Point.hpp"
+#include "RoutingEngine.hpp"
+#include "RoutingMode.hpp"
+#include "buildGeometries.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// Builds pairs of start and destination points spread over the whole navigation mesh, start and
+/// destination are taken from polygons half the mesh apart.
+inline std::vector<std::pair<Point, Point>> buildRouteQueries(const RoutingEngine& engine)
+{
+    const auto mesh = engine.MeshData();
+    const auto centroid = [mesh](size_t index) {
+        Point sum{};
+        const auto& vertices = mesh->Polygons(index).vertices;
+        for(const auto vertex : vertices) {
+            const auto v = mesh->Vertex(vertex);
+            sum += Point{v.x, v.y};
+        }
+        return sum / static_cast<double>(vertices.size());
+    };
+
+    constexpr size_t queryCount = 64;
+    const auto polygonCount = mesh->CountPolygons();
+    std::vector<std::pair<Point, Point>> queries{};
+    queries.reserve(queryCount);
+    for(size_t index = 0; index < queryCount; ++index) {
+        const auto from = index * polygonCount / queryCount;
+        const auto to = (from + polygonCount / 2) % polygonCount;
+        queries.emplace_back(centroid(from), centroid(to));
+    }
+    return queries;
+}
+
+/// Compares the routing modes on the same queries. Besides the time per query the mean length of
+/// the paths found is reported as 'path_length', approximate modes are compared to
+/// RoutingMode::SEARCH by it.
+template <class... Args>
+void bmComputeAllWaypoints(benchmark::State& state, Args&&... args)
+{
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    const auto geometry = std::move(std::get<CollisionGeometry>(args_tuple));
+    RoutingEngine engine{geometry.Polygon()};
+    engine.SetMode(std::get<RoutingMode>(args_tuple));
+    const auto queries = buildRouteQueries(engine);
+
+    double pathLength = 0;
+    for(const auto& [from, to] : queries) {
+        const auto waypoints = engine.ComputeAllWaypoints(from, to);
+        for(size_t index = 1; index < waypoints.size(); ++index) {
+            pathLength += Distance(waypoints[index - 1], waypoints[index]);
+        }
+    }
+    state.counters["path_length"] = pathLength / static_cast<double>(queries.size());
+
+    size_t index = 0;
+    for(auto _ : state) {
+        const auto& [from, to] = queries[index];
+        benchmark::DoNotOptimize(engine.ComputeAllWaypoints(from, to));
+        benchmark::ClobberMemory();
+        index = (index + 1) % queries.size();
+    }
+}
+
+BENCHMARK_CAPTURE(
+    bmComputeAllWaypoints,
+    large_street_network_search,
+    buildLargeStreetNetwork(),
+    RoutingMode::SEARCH)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(
+    bmComputeAllWaypoints,
+    large_street_network_polyanya,
+    buildLargeStreetNetwork(),
+    RoutingMode::POLYANYA)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(
+    bmComputeAllWaypoints,
+    large_street_network_hierarchical,
+    buildLargeStreetNetwork(),
+    RoutingMode::HIERARCHICAL)
+    ->Unit(benchmark::kMicrosecond);
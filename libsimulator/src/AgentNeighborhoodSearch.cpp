@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AgentNeighborhoodSearch.hpp"
+
+#include "AABB.hpp"
+#include "AgentStore.hpp"
+#include "CollisionGeometry.hpp"
+#include "Point.hpp"
+#include "WorkerPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+void AgentNeighborhoodSearch::SetNeighborLists(double range, double skin)
+{
+    neighborListRange = range;
+    neighborListSkin = skin;
+    neighborListsValid = false;
+}
+
+void AgentNeighborhoodSearch::SetBounds(const AABB& bounds)
+{
+    grid.SetBounds(bounds);
+    trackedIds.clear();
+    rebuildRequired = true;
+    neighborListsValid = false;
+}
+
+void AgentNeighborhoodSearch::AddAgent(size_t index)
+{
+    grid.Insert(index, agents.Positions()[index]);
+    neighborListsValid = false;
+    if(index == trackedIds.size()) {
+        trackedIds.push_back(agents.Ids()[index]);
+    } else {
+        // The store has been changed without an 'Update' in between
+        rebuildRequired = true;
+    }
+}
+
+void AgentNeighborhoodSearch::Update(WorkerPool& pool)
+{
+    if(agents.size() != trackedIds.size()) {
+        // Agents have been removed, the lists refer to old indices
+        neighborListsValid = false;
+    }
+    const auto reordered = agents.LayoutVersion() != trackedLayoutVersion;
+    if(rebuildRequired || reordered || grid.CountPending() > MaxPendingAgents || !reconcile()) {
+        rebuild(pool);
+    } else {
+        grid.MoveAll(agents.Positions(), pool);
+    }
+    if(neighborListSkin > 0 && (!neighborListsValid || movedOutOfSkin())) {
+        buildNeighborLists(pool);
+    }
+}
+
+std::vector<ConstAgentRef> AgentNeighborhoodSearch::GetNeighboringAgents(Point pos, double radius)
+    const
+{
+    std::vector<ConstAgentRef> result{};
+    ForEachNeighbor(pos, radius, [&result](ConstAgentRef agent) { result.push_back(agent); });
+    return result;
+}
+
+std::vector<ConstAgentRef> AgentNeighborhoodSearch::VisibleNeighbors(
+    Point pos,
+    double radius,
+    const CollisionGeometry& geometry) const
+{
+    const LineOfSight lineOfSight(geometry, pos, radius);
+    std::vector<ConstAgentRef> result{};
+    ForEachNeighbor(pos, radius, [&lineOfSight, &result](ConstAgentRef agent) {
+        if(lineOfSight.IsVisible(agent.pos)) {
+            result.push_back(agent);
+        }
+    });
+    return result;
+}
+
+void AgentNeighborhoodSearch::rebuild(WorkerPool& pool)
+{
+    grid.Update(agents.Positions(), pool);
+    trackedIds = agents.Ids();
+    trackedLayoutVersion = agents.LayoutVersion();
+    rebuildRequired = false;
+    neighborListsValid = false;
+}
+
+bool AgentNeighborhoodSearch::reconcile()
+{
+    const auto& ids = agents.Ids();
+    if(ids.size() == trackedIds.size()) {
+        // Agents are only appended or removed, equal sizes mean nothing has been removed
+        return ids.empty() || ids.back() == trackedIds.back();
+    }
+    // Removal keeps the order of the remaining agents, so the tracked agents are matched to the
+    // store in a single pass. Keys are renumbered in ascending order, the new key of an agent is
+    // never larger than its old one and therefore already free.
+    size_t next = 0;
+    for(size_t old = 0; old < trackedIds.size(); ++old) {
+        if(next < ids.size() && ids[next] == trackedIds[old]) {
+            if(next != old) {
+                grid.Rekey(old, next);
+            }
+            ++next;
+        } else {
+            grid.Erase(old);
+        }
+    }
+    if(next != ids.size()) {
+        return false;
+    }
+    trackedIds = ids;
+    return true;
+}
+
+void AgentNeighborhoodSearch::buildNeighborLists(WorkerPool& pool)
+{
+    const auto& positions = agents.Positions();
+    const auto radius = neighborListRange + neighborListSkin;
+    neighborListStarts.assign(positions.size() + 1, 0);
+    pool.ParallelFor(positions.size(), [this, &positions, radius](size_t begin, size_t end) {
+        for(auto index = begin; index < end; ++index) {
+            size_t count{0};
+            grid.ForEachNeighbor(positions[index], radius, [&count](size_t) { ++count; });
+            neighborListStarts[index + 1] = count;
+        }
+    });
+    std::partial_sum(
+        std::begin(neighborListStarts),
+        std::end(neighborListStarts),
+        std::begin(neighborListStarts));
+
+    neighborLists.resize(neighborListStarts.back());
+    pool.ParallelFor(positions.size(), [this, &positions, radius](size_t begin, size_t end) {
+        for(auto index = begin; index < end; ++index) {
+            auto next = neighborListStarts[index];
+            grid.ForEachNeighbor(positions[index], radius, [this, &next](size_t neighbor) {
+                neighborLists[next++] = static_cast<uint32_t>(neighbor);
+            });
+        }
+    });
+    neighborListPositions = positions;
+    neighborListsValid = true;
+}
+
+bool AgentNeighborhoodSearch::movedOutOfSkin() const
+{
+    const auto& positions = agents.Positions();
+    const auto maxDisplacement = neighborListSkin / 2;
+    for(size_t index = 0; index < positions.size(); ++index) {
+        if(DistanceSquared(positions[index], neighborListPositions[index]) >
+           maxDisplacement * maxDisplacement) {
+            return true;
+        }
+    }
+    return false;
+}
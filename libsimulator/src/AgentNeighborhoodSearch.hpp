@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "AABB.hpp"
+#include "AgentStore.hpp"
+#include "CollisionGeometry.hpp"
+#include "DenseNeighborhoodSearch.hpp"
+#include "Point.hpp"
+#include "WorkerPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/// Neighborhood search over the agents of an AgentStore.
+///
+/// The grid only stores position and index of each agent. Neighbors are resolved into references
+/// to the store when queried, so that the full agent data is not copied into the grid on each
+/// update. Use 'ForEachNeighbor' in hot paths, it does not allocate.
+///
+/// 'Update' changes the grid incrementally: agents removed from the store are erased, the
+/// remaining ones are renumbered to their new index and only agents that changed their cell are
+/// relocated. The grid is rebuilt from scratch when too many agents could not be placed into
+/// their cell, the bounds changed or the agents in the store have been reordered.
+///
+/// Optionally, neighbor lists (Verlet lists) are kept for queries around agents. Each agent stores
+/// all agents within the interaction range plus a skin margin. The lists stay valid as long as no
+/// agent moved more than half of the skin since they have been built, so that most iterations do
+/// not need to search the grid. Adding or removing agents invalidates the lists.
+///
+/// Agents added to the store after the last 'Update' need to be added with 'AddAgent', removing
+/// agents from the store requires an 'Update' before the next query.
+class AgentNeighborhoodSearch
+{
+public:
+    /// Number of agents outside of the grid cells that triggers a full rebuild on 'Update'.
+    static constexpr size_t MaxPendingAgents{32};
+
+    /// Ratio of the interaction range of a model to the cell size used for it, see 'CellSizeFor'.
+    static constexpr double CellsPerInteractionRange{1.5};
+
+private:
+    const AgentStore& agents;
+    DenseNeighborhoodSearch grid;
+    /// Ids of the agents in the grid, the position in this list is their key in the grid.
+    std::vector<GenericAgent::ID> trackedIds{};
+    /// AgentStore::LayoutVersion the keys refer to.
+    uint64_t trackedLayoutVersion{0};
+    bool rebuildRequired{true};
+
+    /// Largest query radius served by the neighbor lists.
+    double neighborListRange{0};
+    /// Margin added to 'neighborListRange' when building the lists, 0 disables them.
+    double neighborListSkin{0};
+    bool neighborListsValid{false};
+    /// Positions of the agents when the lists have been built.
+    std::vector<Point> neighborListPositions{};
+    /// Neighbors of agent i are 'neighborLists[neighborListStarts[i]...neighborListStarts[i + 1]]'
+    std::vector<size_t> neighborListStarts{};
+    std::vector<uint32_t> neighborLists{};
+
+public:
+    AgentNeighborhoodSearch(const AgentStore& agents_, double cellSize)
+        : agents(agents_), grid(cellSize)
+    {
+    }
+
+    /// Cell size for queries with a radius of 'interactionRange'.
+    ///
+    /// Smaller cells reduce the number of agents tested outside of the query radius, but increase
+    /// the number of cells visited. Cells somewhat smaller than the radius are a good compromise
+    /// from sparse to dense crowds, see the neighborhood search benchmarks.
+    static double CellSizeFor(double interactionRange)
+    {
+        return interactionRange / CellsPerInteractionRange;
+    }
+
+    /// Cell size of the grid, at least the cell size passed on construction.
+    double CellSize() const { return grid.CellSize(); }
+
+    /// Enables neighbor lists for queries around agents with a radius up to 'range'.
+    /// @param skin margin added to 'range' when building the lists, 0 disables the lists.
+    void SetNeighborLists(double range, double skin);
+    double NeighborListSkin() const { return neighborListSkin; }
+
+    /// Sets the area in which agents are expected, see DenseNeighborhoodSearch::SetBounds.
+    void SetBounds(const AABB& bounds);
+
+    /// Adds the agent at 'index' in the store.
+    void AddAgent(size_t index);
+
+    /// Brings the grid up to date with the current state of the store.
+    void Update(WorkerPool& pool);
+
+    /// Calls 'visitor' with a ConstAgentRef of each agent within 'radius' of 'pos'.
+    template <typename Visitor>
+    void ForEachNeighbor(Point pos, double radius, Visitor&& visitor) const
+    {
+        grid.ForEachNeighbor(
+            pos, radius, [this, &visitor](size_t index) { visitor(agents[index]); });
+    }
+
+    /// Calls 'visitor' with a ConstAgentRef of each agent within 'radius' of 'agent', including
+    /// 'agent' itself. Uses the neighbor lists if enabled and 'radius' does not exceed their range,
+    /// neighbors are then visited in a different order than by a query of the grid.
+    template <typename Visitor>
+    void ForEachNeighbor(ConstAgentRef agent, double radius, Visitor&& visitor) const
+    {
+        if(neighborListsValid && radius <= neighborListRange) {
+            const auto index = agents.IndexOf(agent.id);
+            if(index < neighborListStarts.size() - 1) {
+                const auto& positions = agents.Positions();
+                const auto radiusSquared = radius * radius;
+                for(auto entry = neighborListStarts[index]; entry < neighborListStarts[index + 1];
+                    ++entry) {
+                    const auto neighbor = neighborLists[entry];
+                    if(DistanceSquared(positions[neighbor], agent.pos) <= radiusSquared) {
+                        visitor(agents[neighbor]);
+                    }
+                }
+                return;
+            }
+        }
+        ForEachNeighbor(agent.pos, radius, std::forward<Visitor>(visitor));
+    }
+
+    /// Calls 'visitor' with a ConstAgentRef of each agent within 'radius' of 'agent', except
+    /// 'agent' itself, that is not hidden from 'agent' by a wall of 'geometry'.
+    template <typename Visitor>
+    void ForEachVisibleNeighbor(
+        ConstAgentRef agent,
+        double radius,
+        const CollisionGeometry& geometry,
+        Visitor&& visitor) const
+    {
+        const LineOfSight lineOfSight(geometry, agent.pos, radius);
+        ForEachNeighbor(agent, radius, [&agent, &lineOfSight, &visitor](ConstAgentRef neighbor) {
+            if(neighbor.id != agent.id && lineOfSight.IsVisible(neighbor.pos)) {
+                visitor(neighbor);
+            }
+        });
+    }
+
+    std::vector<ConstAgentRef> GetNeighboringAgents(Point pos, double radius) const;
+
+    /// Agents within 'radius' of 'pos' that are not hidden from 'pos' by a wall of 'geometry'.
+    std::vector<ConstAgentRef>
+    VisibleNeighbors(Point pos, double radius, const CollisionGeometry& geometry) const;
+
+private:
+    void rebuild(WorkerPool& pool);
+    /// Erases agents no longer in the store and renumbers the remaining ones.
+    /// @return false if the tracked agents cannot be matched to the store.
+    bool reconcile();
+    void buildNeighborLists(WorkerPool& pool);
+    /// True if an agent moved more than half of the skin since the lists have been built.
+    bool movedOutOfSkin() const;
+};
@@ -1,14 +1,16 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentStore.hpp"
 #include "GenericAgent.hpp"
+#include "Stage.hpp"
 #include "StageManager.hpp"
 
-#include <algorithm>
-#include <map>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
-template <typename Agent>
 class AgentRemovalSystem
 {
 public:
@@ -19,32 +21,29 @@ public:
     AgentRemovalSystem(AgentRemovalSystem&& other) = delete;
     AgentRemovalSystem& operator=(AgentRemovalSystem&& other) = delete;
 
+    /// Removes all agents in 'removedAgentIds' from 'agents' in a single pass and clears
+    /// 'removedAgentIds'. Unknown and repeated ids are ignored.
     void
-    Run(std::vector<Agent>& agents,
+    Run(AgentStore& agents,
         std::vector<GenericAgent::ID>& removedAgentIds,
-        StageManager& stageManager) const;
-};
-
-template <typename Agent>
-void AgentRemovalSystem<Agent>::Run(
-    std::vector<Agent>& agents,
-    std::vector<GenericAgent::ID>& removedAgentIds,
-    StageManager& stageManager) const
-{
-
-    auto iter = std::remove_if(
-        std::begin(agents),
-        std::end(agents),
-        [&removedAgentIds, &stageManager](const GenericAgent& agent) {
-            auto found =
-                std::find(std::begin(removedAgentIds), std::end(removedAgentIds), agent.id) !=
-                std::end(removedAgentIds);
-            if(found) {
-                stageManager.HandleRemoveAgent(agent.stageId);
+        StageManager& stageManager) const
+    {
+        if(removedAgentIds.empty()) {
+            return;
+        }
+        std::vector<bool> marked(agents.size(), false);
+        std::unordered_map<BaseStage::ID, size_t> removedPerStage{};
+        for(const auto id : removedAgentIds) {
+            const auto index = agents.IndexOf(id);
+            if(index == AgentStore::InvalidIndex || marked[index]) {
+                continue;
             }
-            return found;
-        });
-    agents.erase(iter, std::end(agents));
+            marked[index] = true;
+            ++removedPerStage[std::as_const(agents)[index].stageId];
+        }
+        stageManager.HandleRemoveAgents(removedPerStage);
+        agents.Remove(marked);
 
-    removedAgentIds.clear();
-}
+        removedAgentIds.clear();
+    }
+};
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AgentStore.hpp"
+
+#include "GenericAgent.hpp"
+#include "SimulationError.hpp"
+
+#include <cstddef>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace
+{
+template <typename T>
+void permute(std::vector<T>& values, const std::vector<size_t>& order)
+{
+    std::vector<T> permuted{};
+    permuted.reserve(values.size());
+    for(const auto index : order) {
+        permuted.push_back(std::move(values[index]));
+    }
+    values.swap(permuted);
+}
+} // namespace
+
+size_t AgentStore::Add(const GenericAgent& agent)
+{
+    if(Contains(agent.id)) {
+        throw SimulationError("Agent {} has already been added", agent.id);
+    }
+    if(empty()) {
+        // The first agent decides which model data is stored
+        models = std::visit(
+            [](const auto& model) -> ModelArrays {
+                return std::vector<std::decay_t<decltype(model)>>{};
+            },
+            agent.model);
+    }
+    std::visit(
+        [this, &agent](const auto& model) {
+            using ModelData = std::decay_t<decltype(model)>;
+            auto* modelArray = std::get_if<std::vector<ModelData>>(&models);
+            if(modelArray == nullptr) {
+                throw SimulationError(
+                    "Agent {} uses a different model than the other agents", agent.id);
+            }
+            modelArray->push_back(model);
+        },
+        agent.model);
+
+    const auto index = size();
+    ids.push_back(agent.id);
+    journeyIds.push_back(agent.journeyId);
+    stageIds.push_back(agent.stageId);
+    destinations.push_back(agent.destination);
+    targets.push_back(agent.target);
+    positions.push_back(agent.pos);
+    orientations.push_back(agent.orientation);
+    indices.emplace(agent.id, index);
+    return index;
+}
+
+void AgentStore::Reorder(const std::vector<size_t>& order)
+{
+    if(order.size() != size()) {
+        throw SimulationError("Reorder of {} agents with an order of {}", size(), order.size());
+    }
+    std::vector<bool> seen(size(), false);
+    for(const auto index : order) {
+        if(index >= size() || seen[index]) {
+            throw SimulationError("Reorder requires a permutation of all agents");
+        }
+        seen[index] = true;
+    }
+
+    permute(ids, order);
+    permute(journeyIds, order);
+    permute(stageIds, order);
+    permute(destinations, order);
+    permute(targets, order);
+    permute(positions, order);
+    permute(orientations, order);
+    std::visit([&order](auto& modelArray) { permute(modelArray, order); }, models);
+    for(size_t index = 0; index < ids.size(); ++index) {
+        indices.find(ids[index])->second = index;
+    }
+    ++layoutVersion;
+}
+
+void AgentStore::Remove(const std::vector<bool>& marked)
+{
+    if(marked.size() != size()) {
+        throw SimulationError("Remove of {} agents with {} marks", size(), marked.size());
+    }
+    compact([&marked](size_t index) { return marked[index]; });
+}
+
+size_t AgentStore::IndexOf(GenericAgent::ID id) const
+{
+    const auto iter = indices.find(id);
+    return iter == std::end(indices) ? InvalidIndex : iter->second;
+}
+
+AgentRef AgentStore::operator[](size_t index)
+{
+    return AgentRef{
+        ids[index],
+        journeyIds[index],
+        stageIds[index],
+        destinations[index],
+        targets[index],
+        positions[index],
+        orientations[index],
+        std::visit(
+            [index](auto& modelArray) { return BasicModelRef<false>{&modelArray[index]}; },
+            models)};
+}
+
+ConstAgentRef AgentStore::operator[](size_t index) const
+{
+    return ConstAgentRef{
+        ids[index],
+        journeyIds[index],
+        stageIds[index],
+        destinations[index],
+        targets[index],
+        positions[index],
+        orientations[index],
+        std::visit(
+            [index](const auto& modelArray) { return BasicModelRef<true>{&modelArray[index]}; },
+            models)};
+}
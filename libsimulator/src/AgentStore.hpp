@@ -0,0 +1,339 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "AnticipationVelocityModelData.hpp"
+#include "CollisionFreeSpeedModelData.hpp"
+#include "CollisionFreeSpeedModelV2Data.hpp"
+#include "GeneralizedCentrifugalForceModelData.hpp"
+#include "GenericAgent.hpp"
+#include "Point.hpp"
+#include "SocialForceModelData.hpp"
+#include "UniqueID.hpp"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+class Journey;
+class BaseStage;
+
+/// Reference to the model specific data of a single agent.
+template <bool IsConst>
+class BasicModelRef
+{
+    template <typename T>
+    using Ptr = std::conditional_t<IsConst, const T*, T*>;
+
+    std::variant<
+        Ptr<GeneralizedCentrifugalForceModelData>,
+        Ptr<CollisionFreeSpeedModelData>,
+        Ptr<CollisionFreeSpeedModelV2Data>,
+        Ptr<AnticipationVelocityModelData>,
+        Ptr<SocialForceModelData>>
+        data;
+
+public:
+    template <typename T>
+    explicit BasicModelRef(T* model) : data(model)
+    {
+    }
+
+    /// Data of model 'T', throws std::bad_variant_access if the agent uses a different model.
+    template <typename T>
+    std::conditional_t<IsConst, const T&, T&> As() const
+    {
+        return *std::get<Ptr<T>>(data);
+    }
+
+    template <typename T>
+    bool Holds() const
+    {
+        return std::holds_alternative<Ptr<T>>(data);
+    }
+
+    template <typename Visitor>
+    decltype(auto) Visit(Visitor&& visitor) const
+    {
+        return std::visit(
+            [&visitor](auto* model) -> decltype(auto) { return visitor(*model); }, data);
+    }
+};
+
+/// Reference to the data of a single agent.
+///
+/// Refers either to an agent inside an AgentStore or to a GenericAgent. Exposes the same
+/// members as GenericAgent, except for 'model', so that code can be written against both.
+/// References into an AgentStore are invalidated when agents are added to or removed from it.
+template <bool IsConst>
+struct BasicAgentRef {
+    template <typename T>
+    using Ref = std::conditional_t<IsConst, const T&, T&>;
+
+    const GenericAgent::ID& id;
+    Ref<jps::UniqueID<Journey>> journeyId;
+    Ref<jps::UniqueID<BaseStage>> stageId;
+    Ref<Point> destination;
+    Ref<Point> target;
+    Ref<Point> pos;
+    Ref<Point> orientation;
+    BasicModelRef<IsConst> model;
+
+    BasicAgentRef(
+        const GenericAgent::ID& id_,
+        Ref<jps::UniqueID<Journey>> journeyId_,
+        Ref<jps::UniqueID<BaseStage>> stageId_,
+        Ref<Point> destination_,
+        Ref<Point> target_,
+        Ref<Point> pos_,
+        Ref<Point> orientation_,
+        BasicModelRef<IsConst> model_)
+        : id(id_)
+        , journeyId(journeyId_)
+        , stageId(stageId_)
+        , destination(destination_)
+        , target(target_)
+        , pos(pos_)
+        , orientation(orientation_)
+        , model(model_)
+    {
+    }
+
+    // Implicit on purpose, a GenericAgent can be used wherever a reference is expected
+    BasicAgentRef(Ref<GenericAgent> agent)
+        : id(agent.id)
+        , journeyId(agent.journeyId)
+        , stageId(agent.stageId)
+        , destination(agent.destination)
+        , target(agent.target)
+        , pos(agent.pos)
+        , orientation(agent.orientation)
+        , model(std::visit(
+              [](auto& model) { return BasicModelRef<IsConst>{&model}; }, agent.model))
+    {
+    }
+
+    operator BasicAgentRef<true>() const
+        requires(!IsConst)
+    {
+        return BasicAgentRef<true>{
+            id, journeyId, stageId, destination, target, pos, orientation, constModel()};
+    }
+
+private:
+    BasicModelRef<true> constModel() const
+    {
+        return model.Visit([](const auto& data) { return BasicModelRef<true>{&data}; });
+    }
+};
+
+using AgentRef = BasicAgentRef<false>;
+using ConstAgentRef = BasicAgentRef<true>;
+
+/// Storage of all agents of a simulation as structure of arrays.
+///
+/// Each member of the agents is stored in its own contiguous array, so that code only touching
+/// e.g. positions does not need to load the remaining data of the agents. Model specific data is
+/// stored in an array of the model used by the agents, all agents in a store need to use the same
+/// model. Agents are accessed by index through AgentRef and ConstAgentRef, the order of the agents
+/// is the order in which they have been added, unless they have been reordered.
+///
+/// Indices are only stable until agents are removed or reordered, use the ids to refer to agents
+/// across iterations.
+class AgentStore
+{
+public:
+    static constexpr size_t InvalidIndex{std::numeric_limits<size_t>::max()};
+
+    using ModelArrays = std::variant<
+        std::vector<GeneralizedCentrifugalForceModelData>,
+        std::vector<CollisionFreeSpeedModelData>,
+        std::vector<CollisionFreeSpeedModelV2Data>,
+        std::vector<AnticipationVelocityModelData>,
+        std::vector<SocialForceModelData>>;
+
+    template <bool IsConst>
+    class Iterator
+    {
+        using Store = std::conditional_t<IsConst, const AgentStore, AgentStore>;
+        Store* store{};
+        size_t index{};
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = BasicAgentRef<IsConst>;
+        using difference_type = std::ptrdiff_t;
+        using reference = BasicAgentRef<IsConst>;
+        using pointer = void;
+
+        Iterator() = default;
+        Iterator(Store* store_, size_t index_) : store(store_), index(index_) {}
+
+        reference operator*() const { return (*store)[index]; }
+        reference operator[](difference_type offset) const { return (*store)[index + offset]; }
+
+        Iterator& operator++()
+        {
+            ++index;
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            auto copy = *this;
+            ++index;
+            return copy;
+        }
+        Iterator& operator--()
+        {
+            --index;
+            return *this;
+        }
+        Iterator operator--(int)
+        {
+            auto copy = *this;
+            --index;
+            return copy;
+        }
+        Iterator& operator+=(difference_type offset)
+        {
+            index += offset;
+            return *this;
+        }
+        Iterator& operator-=(difference_type offset)
+        {
+            index -= offset;
+            return *this;
+        }
+        friend Iterator operator+(Iterator it, difference_type offset) { return it += offset; }
+        friend Iterator operator+(difference_type offset, Iterator it) { return it += offset; }
+        friend Iterator operator-(Iterator it, difference_type offset) { return it -= offset; }
+        friend difference_type operator-(const Iterator& a, const Iterator& b)
+        {
+            return static_cast<difference_type>(a.index) - static_cast<difference_type>(b.index);
+        }
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.index == b.index; }
+        friend auto operator<=>(const Iterator& a, const Iterator& b)
+        {
+            return a.index <=> b.index;
+        }
+
+        /// Index of the agent in the store.
+        size_t Index() const { return index; }
+    };
+
+private:
+    std::vector<GenericAgent::ID> ids{};
+    std::vector<jps::UniqueID<Journey>> journeyIds{};
+    std::vector<jps::UniqueID<BaseStage>> stageIds{};
+    std::vector<Point> destinations{};
+    std::vector<Point> targets{};
+    std::vector<Point> positions{};
+    std::vector<Point> orientations{};
+    ModelArrays models{};
+    /// Index of each agent, updated in place when agents move within the store.
+    std::unordered_map<GenericAgent::ID, size_t> indices{};
+    uint64_t layoutVersion{0};
+
+public:
+    AgentStore() = default;
+    ~AgentStore() = default;
+    AgentStore(const AgentStore& other) = delete;
+    AgentStore& operator=(const AgentStore& other) = delete;
+    AgentStore(AgentStore&& other) = delete;
+    AgentStore& operator=(AgentStore&& other) = delete;
+
+    /// Appends 'agent' to the store.
+    /// @return index of the new agent.
+    size_t Add(const GenericAgent& agent);
+
+    /// Removes all agents for which 'predicate' returns true, the order of the remaining agents
+    /// is kept.
+    template <typename Predicate>
+    void RemoveIf(Predicate&& predicate);
+
+    /// Removes all agents at indices for which 'marked' is true, the order of the remaining agents
+    /// is kept. 'marked' needs to have one entry per agent.
+    void Remove(const std::vector<bool>& marked);
+
+    /// Moves the agent at index 'order[i]' to index i.
+    /// @param order permutation of [0, size())
+    void Reorder(const std::vector<size_t>& order);
+
+    /// Incremented by each 'Reorder', indices obtained before a reorder are invalid.
+    uint64_t LayoutVersion() const { return layoutVersion; }
+
+    /// Index of the agent with 'id', InvalidIndex if there is no such agent.
+    size_t IndexOf(GenericAgent::ID id) const;
+    bool Contains(GenericAgent::ID id) const { return indices.contains(id); }
+
+    size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+
+    AgentRef operator[](size_t index);
+    ConstAgentRef operator[](size_t index) const;
+
+    Iterator<false> begin() { return {this, 0}; }
+    Iterator<false> end() { return {this, size()}; }
+    Iterator<true> begin() const { return {this, 0}; }
+    Iterator<true> end() const { return {this, size()}; }
+
+    const std::vector<GenericAgent::ID>& Ids() const { return ids; }
+    const std::vector<Point>& Positions() const { return positions; }
+    const std::vector<Point>& Orientations() const { return orientations; }
+    const std::vector<Point>& Destinations() const { return destinations; }
+    const ModelArrays& Models() const { return models; }
+
+private:
+    /// Removes all agents at indices for which 'isRemoved' returns true in one pass.
+    template <typename IsRemoved>
+    void compact(IsRemoved&& isRemoved);
+};
+
+template <typename Predicate>
+void AgentStore::RemoveIf(Predicate&& predicate)
+{
+    compact([this, &predicate](size_t index) { return predicate(std::as_const(*this)[index]); });
+}
+
+template <typename IsRemoved>
+void AgentStore::compact(IsRemoved&& isRemoved)
+{
+    size_t kept = 0;
+    for(size_t index = 0; index < size(); ++index) {
+        if(isRemoved(index)) {
+            indices.erase(ids[index]);
+            continue;
+        }
+        if(kept != index) {
+            ids[kept] = ids[index];
+            indices.find(ids[kept])->second = kept;
+            journeyIds[kept] = journeyIds[index];
+            stageIds[kept] = stageIds[index];
+            destinations[kept] = destinations[index];
+            targets[kept] = targets[index];
+            positions[kept] = positions[index];
+            orientations[kept] = orientations[index];
+            std::visit(
+                [kept, index](auto& modelArray) { modelArray[kept] = modelArray[index]; },
+                models);
+        }
+        ++kept;
+    }
+    if(kept == size()) {
+        return;
+    }
+    ids.resize(kept);
+    journeyIds.resize(kept);
+    stageIds.resize(kept);
+    destinations.resize(kept);
+    targets.resize(kept);
+    positions.resize(kept);
+    orientations.resize(kept);
+    std::visit([kept](auto& modelArray) { modelArray.resize(kept); }, models);
+}
@@ -1,11 +1,10 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "AnticipationVelocityModel.hpp"
 
+#include "AgentStore.hpp"
 #include "AnticipationVelocityModelData.hpp"
 #include "AnticipationVelocityModelUpdate.hpp"
 #include "CollisionGeometry.hpp"
-#include "GenericAgent.hpp"
-#include "GeometricFunctions.hpp"
 #include "LineSegment.hpp"
 #include "Macros.hpp"
 #include "OperationalModel.hpp"
@@ -14,6 +13,7 @@
 #include "SimulationError.hpp"
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
@@ -23,10 +23,30 @@
 #include <vector>
 
 AnticipationVelocityModel::AnticipationVelocityModel(double pushoutStrength, uint64_t rng_seed)
-    : _pushoutStrength(pushoutStrength), gen(rng_seed)
+    : _pushoutStrength(pushoutStrength), _rngSeed(rng_seed)
 {
 }
 
+namespace
+{
+uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+} // namespace
+
+uint64_t AnticipationVelocityModel::Draw(ConstAgentRef ped, uint64_t salt) const
+{
+    auto h = splitmix64(_rngSeed ^ ped.id.getID());
+    h = splitmix64(h ^ std::bit_cast<uint64_t>(_time));
+    h = splitmix64(h ^ std::bit_cast<uint64_t>(ped.pos.x));
+    h = splitmix64(h ^ std::bit_cast<uint64_t>(ped.pos.y));
+    return splitmix64(h ^ salt);
+}
+
 OperationalModelType AnticipationVelocityModel::Type() const
 {
     return OperationalModelType::ANTICIPATION_VELOCITY_MODEL;
@@ -34,36 +54,20 @@ OperationalModelType AnticipationVelocityModel::Type() const
 
 OperationalModelUpdate AnticipationVelocityModel::ComputeNewPosition(
     double dT,
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     const CollisionGeometry& geometry,
     const NeighborhoodSearchType& neighborhoodSearch) const
 {
-    auto neighborhood = neighborhoodSearch.GetNeighboringAgents(ped.pos, _cutOffRadius);
     const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(ped.pos);
 
-    // Remove any agent from the neighborhood that is obstructed by geometry and the current
-    // agent
-    neighborhood.erase(
-        std::remove_if(
-            std::begin(neighborhood),
-            std::end(neighborhood),
-            [&ped, &boundary](const auto& neighbor) {
-                if(ped.id == neighbor.id) {
-                    return true;
-                }
-                const auto agent_to_neighbor = LineSegment(ped.pos, neighbor.pos);
-                if(std::find_if(
-                       boundary.cbegin(),
-                       boundary.cend(),
-                       [&agent_to_neighbor](const auto& boundary_segment) {
-                           return intersects(agent_to_neighbor, boundary_segment);
-                       }) != boundary.end()) {
-                    return true;
-                }
-
-                return false;
-            }),
-        std::end(neighborhood));
+    // Neighbors are needed in multiple passes, the buffer is reused to not allocate per agent
+    thread_local std::vector<ConstAgentRef> neighborhood{};
+    neighborhood.clear();
+    // Skip any agent that is obstructed by geometry and the current agent
+    neighborhoodSearch.ForEachVisibleNeighbor(
+        ped, _cutOffRadius, geometry, [](ConstAgentRef neighbor) {
+            neighborhood.push_back(neighbor);
+        });
 
     const auto neighborRepulsion = std::accumulate(
         std::begin(neighborhood),
@@ -79,7 +83,7 @@ OperationalModelUpdate AnticipationVelocityModel::ComputeNewPosition(
         direction = ped.orientation;
     }
 
-    const auto& model = std::get<AnticipationVelocityModelData>(ped.model);
+    const auto& model = ped.model.As<AnticipationVelocityModelData>();
     const double wallBufferDistance = model.wallBufferDistance;
     // Wall sliding behavior
 
@@ -101,22 +105,22 @@ OperationalModelUpdate AnticipationVelocityModel::ComputeNewPosition(
         .position = ped.pos + velocity * dT, .velocity = velocity, .orientation = direction};
 };
 
-void AnticipationVelocityModel::ApplyUpdate(const OperationalModelUpdate& upd, GenericAgent& agent)
+void AnticipationVelocityModel::ApplyUpdate(const OperationalModelUpdate& upd, AgentRef agent)
     const
 {
     const auto& update = std::get<AnticipationVelocityModelUpdate>(upd);
-    auto& model = std::get<AnticipationVelocityModelData>(agent.model);
+    auto& model = agent.model.As<AnticipationVelocityModelData>();
     agent.pos = update.position;
     agent.orientation = update.orientation;
     model.velocity = update.velocity;
 }
 
 Point AnticipationVelocityModel::UpdateDirection(
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     const Point& calculatedDirection,
     double dt) const
 {
-    const auto& model = std::get<AnticipationVelocityModelData>(ped.model);
+    const auto& model = ped.model.As<AnticipationVelocityModelData>();
     const Point desiredDirection = (ped.destination - ped.pos).Normalized();
     const Point actualDirection = ped.orientation;
     Point updatedDirection;
@@ -136,11 +140,11 @@ Point AnticipationVelocityModel::UpdateDirection(
 }
 
 void AnticipationVelocityModel::CheckModelConstraint(
-    const GenericAgent& agent,
+    ConstAgentRef agent,
     const NeighborhoodSearchType& neighborhoodSearch,
     const CollisionGeometry& geometry) const
 {
-    const auto& model = std::get<AnticipationVelocityModelData>(agent.model);
+    const auto& model = agent.model.As<AnticipationVelocityModelData>();
     const auto r = model.radius;
     constexpr double rMin = 0.;
     constexpr double rMax = 2.;
@@ -187,7 +191,7 @@ void AnticipationVelocityModel::CheckModelConstraint(
         if(agent.id == neighbor.id) {
             continue;
         }
-        const auto& neighbor_model = std::get<AnticipationVelocityModelData>(neighbor.model);
+        const auto& neighbor_model = neighbor.model.As<AnticipationVelocityModelData>();
         const auto contanctdDist = r + neighbor_model.radius;
         const auto distance = (agent.pos - neighbor.pos).Norm();
         if(contanctdDist >= distance) {
@@ -215,30 +219,30 @@ std::unique_ptr<OperationalModel> AnticipationVelocityModel::Clone() const
 }
 
 double AnticipationVelocityModel::OptimalSpeed(
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     double spacing,
     double time_gap) const
 {
-    const auto& model = std::get<AnticipationVelocityModelData>(ped.model);
+    const auto& model = ped.model.As<AnticipationVelocityModelData>();
     constexpr double creep_speed = 0.01;
 
     double speed = spacing / time_gap;
 
     if(std::abs(speed) < creep_speed) {
         // Random shuffle: forward, backward, or stop
-        const auto r = gen() % 3;
+        const auto r = Draw(ped, 0) % 3;
         speed = (r == 0) ? creep_speed : (r == 1) ? -creep_speed : 0.0;
     }
 
     return std::min(std::max(speed, -creep_speed), model.v0);
 }
 double AnticipationVelocityModel::GetSpacing(
-    const GenericAgent& ped1,
-    const GenericAgent& ped2,
+    ConstAgentRef ped1,
+    ConstAgentRef ped2,
     const Point& direction) const
 {
-    const auto& model1 = std::get<AnticipationVelocityModelData>(ped1.model);
-    const auto& model2 = std::get<AnticipationVelocityModelData>(ped2.model);
+    const auto& model1 = ped1.model.As<AnticipationVelocityModelData>();
+    const auto& model2 = ped2.model.As<AnticipationVelocityModelData>();
     const auto distp12 = ped2.pos - ped1.pos;
     const auto inFront = direction.ScalarProduct(distp12) >= 0;
     if(!inFront) {
@@ -257,7 +261,8 @@ double AnticipationVelocityModel::GetSpacing(
 
 Point AnticipationVelocityModel::CalculateInfluenceDirection(
     const Point& desiredDirection,
-    const Point& predictedDirection) const
+    const Point& predictedDirection,
+    uint64_t tieBreakKey) const
 {
     // Eq. (5)
     const Point orthogonalDirection = Point(-desiredDirection.y, desiredDirection.x).Normalized();
@@ -265,7 +270,7 @@ Point AnticipationVelocityModel::CalculateInfluenceDirection(
     Point influenceDirection = orthogonalDirection;
     if(fabs(alignment) < J_EPS) {
         // Choose a random direction (left or right)
-        if(gen() % 2 == 0) {
+        if(tieBreakKey % 2 == 0) {
             influenceDirection = -orthogonalDirection;
         }
     } else if(alignment > 0) {
@@ -275,11 +280,11 @@ Point AnticipationVelocityModel::CalculateInfluenceDirection(
 }
 
 Point AnticipationVelocityModel::NeighborRepulsion(
-    const GenericAgent& ped1,
-    const GenericAgent& ped2) const
+    ConstAgentRef ped1,
+    ConstAgentRef ped2) const
 {
-    const auto& model1 = std::get<AnticipationVelocityModelData>(ped1.model);
-    const auto& model2 = std::get<AnticipationVelocityModelData>(ped2.model);
+    const auto& model1 = ped1.model.As<AnticipationVelocityModelData>();
+    const auto& model2 = ped2.model.As<AnticipationVelocityModelData>();
 
     const auto distp12 = ped2.pos - ped1.pos;
     const auto [distance, ep12] = distp12.NormAndNormalized();
@@ -309,7 +314,8 @@ Point AnticipationVelocityModel::NeighborRepulsion(
     const auto newep12 = distp12 + model2.velocity * model2.anticipationTime; // e_ij(t+ta)
 
     // Compute adjusted influence direction
-    const auto influenceDirection = CalculateInfluenceDirection(d1, newep12);
+    const auto influenceDirection =
+        CalculateInfluenceDirection(d1, newep12, Draw(ped1, ped2.id.getID()));
     return influenceDirection * interactionStrength;
 }
 
@@ -1,55 +1,62 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentNeighborhoodSearch.hpp"
+#include "AgentStore.hpp"
 #include "CollisionGeometry.hpp"
 #include "LineSegment.hpp"
-#include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
 #include "Point.hpp"
 
 #include <cstdint>
 #include <memory>
-#include <random>
 #include <vector>
 
-struct GenericAgent;
-
 class AnticipationVelocityModel : public OperationalModel
 {
 public:
-    using NeighborhoodSearchType = NeighborhoodSearch<GenericAgent>;
+    using NeighborhoodSearchType = AgentNeighborhoodSearch;
 
 private:
     double _cutOffRadius{3};
     /// Add a small outward component to maintain minimum distance from walls.
     double _pushoutStrength;
-    mutable std::mt19937 gen;
+    /// Seed for the tie-breaking decisions. Decisions are derived from a hash of the seed, the
+    /// current time and the involved agents' state instead of a shared generator, so that the
+    /// result does not depend on the order in which agents are processed.
+    uint64_t _rngSeed;
+    /// Time of the current iteration, lets stopped agents draw a new decision in the next one.
+    double _time{0};
 
 public:
     AnticipationVelocityModel(double pushoutStrength, uint64_t rng_seed);
     ~AnticipationVelocityModel() override = default;
     OperationalModelType Type() const override;
+    double InteractionRange() const override { return _cutOffRadius; }
+    void BeginIteration(double t_in_sec) override { _time = t_in_sec; }
     OperationalModelUpdate ComputeNewPosition(
         double dT,
-        const GenericAgent& ped,
+        ConstAgentRef ped,
         const CollisionGeometry& geometry,
         const NeighborhoodSearchType& neighborhoodSearch) const override;
-    void ApplyUpdate(const OperationalModelUpdate& update, GenericAgent& agent) const override;
+    void ApplyUpdate(const OperationalModelUpdate& update, AgentRef agent) const override;
     void CheckModelConstraint(
-        const GenericAgent& agent,
+        ConstAgentRef agent,
         const NeighborhoodSearchType& neighborhoodSearch,
         const CollisionGeometry& geometry) const override;
     std::unique_ptr<OperationalModel> Clone() const override;
 
 private:
-    double OptimalSpeed(const GenericAgent& ped, double spacing, double time_gap) const;
+    double OptimalSpeed(ConstAgentRef ped, double spacing, double time_gap) const;
     Point CalculateInfluenceDirection(
         const Point& desiredDirection,
-        const Point& predictedDirection) const;
+        const Point& predictedDirection,
+        uint64_t tieBreakKey) const;
+    uint64_t Draw(ConstAgentRef ped, uint64_t salt) const;
     double
-    GetSpacing(const GenericAgent& ped1, const GenericAgent& ped2, const Point& direction) const;
-    Point NeighborRepulsion(const GenericAgent& ped1, const GenericAgent& ped2) const;
+    GetSpacing(ConstAgentRef ped1, ConstAgentRef ped2, const Point& direction) const;
+    Point NeighborRepulsion(ConstAgentRef ped1, ConstAgentRef ped2) const;
 
     Point HandleWallAvoidance(
         const Point& direction,
@@ -59,5 +66,5 @@ private:
         double wallBufferDistance) const;
 
     Point
-    UpdateDirection(const GenericAgent& ped, const Point& calculatedDirection, double dt) const;
+    UpdateDirection(ConstAgentRef ped, const Point& calculatedDirection, double dt) const;
 };
@@ -1,11 +1,10 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "CollisionFreeSpeedModel.hpp"
 
+#include "AgentStore.hpp"
 #include "CollisionFreeSpeedModelData.hpp"
 #include "CollisionFreeSpeedModelUpdate.hpp"
 #include "CollisionGeometry.hpp"
-#include "GenericAgent.hpp"
-#include "GeometricFunctions.hpp"
 #include "LineSegment.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
@@ -39,36 +38,20 @@ OperationalModelType CollisionFreeSpeedModel::Type() const
 
 OperationalModelUpdate CollisionFreeSpeedModel::ComputeNewPosition(
     double dT,
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     const CollisionGeometry& geometry,
     const NeighborhoodSearchType& neighborhoodSearch) const
 {
-    auto neighborhood = neighborhoodSearch.GetNeighboringAgents(ped.pos, _cutOffRadius);
     const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(ped.pos);
 
-    // Remove any agent from the neighborhood that is obstructed by geometry and the current
-    // agent
-    neighborhood.erase(
-        std::remove_if(
-            std::begin(neighborhood),
-            std::end(neighborhood),
-            [&ped, &boundary](const auto& neighbor) {
-                if(ped.id == neighbor.id) {
-                    return true;
-                }
-                const auto agent_to_neighbor = LineSegment(ped.pos, neighbor.pos);
-                if(std::find_if(
-                       boundary.cbegin(),
-                       boundary.cend(),
-                       [&agent_to_neighbor](const auto& boundary_segment) {
-                           return intersects(agent_to_neighbor, boundary_segment);
-                       }) != boundary.end()) {
-                    return true;
-                }
-
-                return false;
-            }),
-        std::end(neighborhood));
+    // Neighbors are needed in multiple passes, the buffer is reused to not allocate per agent
+    thread_local std::vector<ConstAgentRef> neighborhood{};
+    neighborhood.clear();
+    // Skip any agent that is obstructed by geometry and the current agent
+    neighborhoodSearch.ForEachVisibleNeighbor(
+        ped, _cutOffRadius, geometry, [](ConstAgentRef neighbor) {
+            neighborhood.push_back(neighbor);
+        });
 
     const auto neighborRepulsion = std::accumulate(
         std::begin(neighborhood),
@@ -99,13 +82,13 @@ OperationalModelUpdate CollisionFreeSpeedModel::ComputeNewPosition(
             return std::min(res, GetSpacing(ped, neighbor, direction));
         });
 
-    const auto& model = std::get<CollisionFreeSpeedModelData>(ped.model);
+    const auto& model = ped.model.As<CollisionFreeSpeedModelData>();
     const auto optimal_speed = OptimalSpeed(ped, spacing, model.timeGap);
     const auto velocity = direction * optimal_speed;
     return CollisionFreeSpeedModelUpdate{ped.pos + velocity * dT, direction};
 };
 
-void CollisionFreeSpeedModel::ApplyUpdate(const OperationalModelUpdate& upd, GenericAgent& agent)
+void CollisionFreeSpeedModel::ApplyUpdate(const OperationalModelUpdate& upd, AgentRef agent)
     const
 {
     const auto& update = std::get<CollisionFreeSpeedModelUpdate>(upd);
@@ -114,11 +97,11 @@ void CollisionFreeSpeedModel::ApplyUpdate(const OperationalModelUpdate& upd, Gen
 }
 
 void CollisionFreeSpeedModel::CheckModelConstraint(
-    const GenericAgent& agent,
+    ConstAgentRef agent,
     const NeighborhoodSearchType& neighborhoodSearch,
     const CollisionGeometry& geometry) const
 {
-    const auto& model = std::get<CollisionFreeSpeedModelData>(agent.model);
+    const auto& model = agent.model.As<CollisionFreeSpeedModelData>();
 
     const auto r = model.radius;
     constexpr double rMin = 0.;
@@ -140,7 +123,7 @@ void CollisionFreeSpeedModel::CheckModelConstraint(
         if(agent.id == neighbor.id) {
             continue;
         }
-        const auto& neighbor_model = std::get<CollisionFreeSpeedModelData>(neighbor.model);
+        const auto& neighbor_model = neighbor.model.As<CollisionFreeSpeedModelData>();
         const auto contanctdDist = r + neighbor_model.radius;
         const auto distance = (agent.pos - neighbor.pos).Norm();
         if(contanctdDist >= distance) {
@@ -168,21 +151,21 @@ std::unique_ptr<OperationalModel> CollisionFreeSpeedModel::Clone() const
 }
 
 double CollisionFreeSpeedModel::OptimalSpeed(
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     double spacing,
     double time_gap) const
 {
-    const auto& model = std::get<CollisionFreeSpeedModelData>(ped.model);
+    const auto& model = ped.model.As<CollisionFreeSpeedModelData>();
     return std::min(std::max(spacing / time_gap, 0.0), model.v0);
 }
 
 double CollisionFreeSpeedModel::GetSpacing(
-    const GenericAgent& ped1,
-    const GenericAgent& ped2,
+    ConstAgentRef ped1,
+    ConstAgentRef ped2,
     const Point& direction) const
 {
-    const auto& model1 = std::get<CollisionFreeSpeedModelData>(ped1.model);
-    const auto& model2 = std::get<CollisionFreeSpeedModelData>(ped2.model);
+    const auto& model1 = ped1.model.As<CollisionFreeSpeedModelData>();
+    const auto& model2 = ped2.model.As<CollisionFreeSpeedModelData>();
     const auto distp12 = ped2.pos - ped1.pos;
     const auto inFront = direction.ScalarProduct(distp12) >= 0;
     if(!inFront) {
@@ -197,25 +180,25 @@ double CollisionFreeSpeedModel::GetSpacing(
     }
     return distp12.Norm() - l;
 }
-Point CollisionFreeSpeedModel::NeighborRepulsion(const GenericAgent& ped1, const GenericAgent& ped2)
+Point CollisionFreeSpeedModel::NeighborRepulsion(ConstAgentRef ped1, ConstAgentRef ped2)
     const
 {
     const auto distp12 = ped2.pos - ped1.pos;
     const auto [distance, direction] = distp12.NormAndNormalized();
-    const auto& model1 = std::get<CollisionFreeSpeedModelData>(ped1.model);
-    const auto& model2 = std::get<CollisionFreeSpeedModelData>(ped2.model);
+    const auto& model1 = ped1.model.As<CollisionFreeSpeedModelData>();
+    const auto& model2 = ped2.model.As<CollisionFreeSpeedModelData>();
     const auto l = model1.radius + model2.radius;
     return direction * -(strengthNeighborRepulsion * exp((l - distance) / rangeNeighborRepulsion));
 }
 
 Point CollisionFreeSpeedModel::BoundaryRepulsion(
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     const LineSegment& boundary_segment) const
 {
     const auto pt = boundary_segment.ShortestPoint(ped.pos);
     const auto dist_vec = pt - ped.pos;
     const auto [dist, e_iw] = dist_vec.NormAndNormalized();
-    const auto& model = std::get<CollisionFreeSpeedModelData>(ped.model);
+    const auto& model = ped.model.As<CollisionFreeSpeedModelData>();
     const auto l = model.radius;
     const auto R_iw = -strengthGeometryRepulsion * exp((l - dist) / rangeGeometryRepulsion);
     return e_iw * R_iw;
@@ -1,21 +1,20 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentNeighborhoodSearch.hpp"
+#include "AgentStore.hpp"
 #include "CollisionGeometry.hpp"
 #include "LineSegment.hpp"
-#include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
 #include "Point.hpp"
 
 #include <memory>
 
-struct GenericAgent;
-
 class CollisionFreeSpeedModel : public OperationalModel
 {
 public:
-    using NeighborhoodSearchType = NeighborhoodSearch<GenericAgent>;
+    using NeighborhoodSearchType = AgentNeighborhoodSearch;
 
 private:
     double _cutOffRadius{3};
@@ -32,22 +31,23 @@ public:
         double rangeGeometryRepulsion);
     ~CollisionFreeSpeedModel() override = default;
     OperationalModelType Type() const override;
+    double InteractionRange() const override { return _cutOffRadius; }
     OperationalModelUpdate ComputeNewPosition(
         double dT,
-        const GenericAgent& ped,
+        ConstAgentRef ped,
         const CollisionGeometry& geometry,
         const NeighborhoodSearchType& neighborhoodSearch) const override;
-    void ApplyUpdate(const OperationalModelUpdate& update, GenericAgent& agent) const override;
+    void ApplyUpdate(const OperationalModelUpdate& update, AgentRef agent) const override;
     void CheckModelConstraint(
-        const GenericAgent& agent,
+        ConstAgentRef agent,
         const NeighborhoodSearchType& neighborhoodSearch,
         const CollisionGeometry& geometry) const override;
     std::unique_ptr<OperationalModel> Clone() const override;
 
 private:
-    double OptimalSpeed(const GenericAgent& ped, double spacing, double time_gap) const;
+    double OptimalSpeed(ConstAgentRef ped, double spacing, double time_gap) const;
     double
-    GetSpacing(const GenericAgent& ped1, const GenericAgent& ped2, const Point& direction) const;
-    Point NeighborRepulsion(const GenericAgent& ped1, const GenericAgent& ped2) const;
-    Point BoundaryRepulsion(const GenericAgent& ped, const LineSegment& boundary_segment) const;
+    GetSpacing(ConstAgentRef ped1, ConstAgentRef ped2, const Point& direction) const;
+    Point NeighborRepulsion(ConstAgentRef ped1, ConstAgentRef ped2) const;
+    Point BoundaryRepulsion(ConstAgentRef ped, const LineSegment& boundary_segment) const;
 };
@@ -1,11 +1,10 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "CollisionFreeSpeedModelV2.hpp"
 
+#include "AgentStore.hpp"
 #include "CollisionFreeSpeedModelV2Data.hpp"
 #include "CollisionFreeSpeedModelV2Update.hpp"
 #include "CollisionGeometry.hpp"
-#include "GenericAgent.hpp"
-#include "GeometricFunctions.hpp"
 #include "LineSegment.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
@@ -27,36 +26,20 @@ OperationalModelType CollisionFreeSpeedModelV2::Type() const
 
 OperationalModelUpdate CollisionFreeSpeedModelV2::ComputeNewPosition(
     double dT,
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     const CollisionGeometry& geometry,
     const NeighborhoodSearchType& neighborhoodSearch) const
 {
-    auto neighborhood = neighborhoodSearch.GetNeighboringAgents(ped.pos, _cutOffRadius);
     const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(ped.pos);
 
-    // Remove any agent from the neighborhood that is obstructed by geometry and the current
-    // agent
-    neighborhood.erase(
-        std::remove_if(
-            std::begin(neighborhood),
-            std::end(neighborhood),
-            [&ped, &boundary](const auto& neighbor) {
-                if(ped.id == neighbor.id) {
-                    return true;
-                }
-                const auto agent_to_neighbor = LineSegment(ped.pos, neighbor.pos);
-                if(std::find_if(
-                       boundary.cbegin(),
-                       boundary.cend(),
-                       [&agent_to_neighbor](const auto& boundary_segment) {
-                           return intersects(agent_to_neighbor, boundary_segment);
-                       }) != boundary.end()) {
-                    return true;
-                }
-
-                return false;
-            }),
-        std::end(neighborhood));
+    // Neighbors are needed in multiple passes, the buffer is reused to not allocate per agent
+    thread_local std::vector<ConstAgentRef> neighborhood{};
+    neighborhood.clear();
+    // Skip any agent that is obstructed by geometry and the current agent
+    neighborhoodSearch.ForEachVisibleNeighbor(
+        ped, _cutOffRadius, geometry, [](ConstAgentRef neighbor) {
+            neighborhood.push_back(neighbor);
+        });
 
     const auto neighborRepulsion = std::accumulate(
         std::begin(neighborhood),
@@ -87,13 +70,13 @@ OperationalModelUpdate CollisionFreeSpeedModelV2::ComputeNewPosition(
             return std::min(res, GetSpacing(ped, neighbor, direction));
         });
 
-    const auto& model = std::get<CollisionFreeSpeedModelV2Data>(ped.model);
+    const auto& model = ped.model.As<CollisionFreeSpeedModelV2Data>();
     const auto optimal_speed = OptimalSpeed(ped, spacing, model.timeGap);
     const auto velocity = direction * optimal_speed;
     return CollisionFreeSpeedModelV2Update{ped.pos + velocity * dT, direction};
 };
 
-void CollisionFreeSpeedModelV2::ApplyUpdate(const OperationalModelUpdate& upd, GenericAgent& agent)
+void CollisionFreeSpeedModelV2::ApplyUpdate(const OperationalModelUpdate& upd, AgentRef agent)
     const
 {
     const auto& update = std::get<CollisionFreeSpeedModelV2Update>(upd);
@@ -102,11 +85,11 @@ void CollisionFreeSpeedModelV2::ApplyUpdate(const OperationalModelUpdate& upd, G
 }
 
 void CollisionFreeSpeedModelV2::CheckModelConstraint(
-    const GenericAgent& agent,
+    ConstAgentRef agent,
     const NeighborhoodSearchType& neighborhoodSearch,
     const CollisionGeometry& geometry) const
 {
-    const auto& model = std::get<CollisionFreeSpeedModelV2Data>(agent.model);
+    const auto& model = agent.model.As<CollisionFreeSpeedModelV2Data>();
 
     const auto r = model.radius;
     constexpr double rMin = 0.;
@@ -128,7 +111,7 @@ void CollisionFreeSpeedModelV2::CheckModelConstraint(
         if(agent.id == neighbor.id) {
             continue;
         }
-        const auto& neighbor_model = std::get<CollisionFreeSpeedModelV2Data>(neighbor.model);
+        const auto& neighbor_model = neighbor.model.As<CollisionFreeSpeedModelV2Data>();
         const auto contanctdDist = r + neighbor_model.radius;
         const auto distance = (agent.pos - neighbor.pos).Norm();
         if(contanctdDist >= distance) {
@@ -156,21 +139,21 @@ std::unique_ptr<OperationalModel> CollisionFreeSpeedModelV2::Clone() const
 }
 
 double CollisionFreeSpeedModelV2::OptimalSpeed(
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     double spacing,
     double time_gap) const
 {
-    const auto& model = std::get<CollisionFreeSpeedModelV2Data>(ped.model);
+    const auto& model = ped.model.As<CollisionFreeSpeedModelV2Data>();
     return std::min(std::max(spacing / time_gap, 0.0), model.v0);
 }
 
 double CollisionFreeSpeedModelV2::GetSpacing(
-    const GenericAgent& ped1,
-    const GenericAgent& ped2,
+    ConstAgentRef ped1,
+    ConstAgentRef ped2,
     const Point& direction) const
 {
-    const auto& model1 = std::get<CollisionFreeSpeedModelV2Data>(ped1.model);
-    const auto& model2 = std::get<CollisionFreeSpeedModelV2Data>(ped2.model);
+    const auto& model1 = ped1.model.As<CollisionFreeSpeedModelV2Data>();
+    const auto& model2 = ped2.model.As<CollisionFreeSpeedModelV2Data>();
     const auto distp12 = ped2.pos - ped1.pos;
     const auto inFront = direction.ScalarProduct(distp12) >= 0;
     if(!inFront) {
@@ -186,26 +169,26 @@ double CollisionFreeSpeedModelV2::GetSpacing(
     return distp12.Norm() - l;
 }
 Point CollisionFreeSpeedModelV2::NeighborRepulsion(
-    const GenericAgent& ped1,
-    const GenericAgent& ped2) const
+    ConstAgentRef ped1,
+    ConstAgentRef ped2) const
 {
     const auto distp12 = ped2.pos - ped1.pos;
     const auto [distance, direction] = distp12.NormAndNormalized();
-    const auto& model1 = std::get<CollisionFreeSpeedModelV2Data>(ped1.model);
-    const auto& model2 = std::get<CollisionFreeSpeedModelV2Data>(ped2.model);
+    const auto& model1 = ped1.model.As<CollisionFreeSpeedModelV2Data>();
+    const auto& model2 = ped2.model.As<CollisionFreeSpeedModelV2Data>();
     const auto l = model1.radius + model2.radius;
     return direction * -(model1.strengthNeighborRepulsion *
                          exp((l - distance) / model1.rangeNeighborRepulsion));
 }
 
 Point CollisionFreeSpeedModelV2::BoundaryRepulsion(
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     const LineSegment& boundary_segment) const
 {
     const auto pt = boundary_segment.ShortestPoint(ped.pos);
     const auto dist_vec = pt - ped.pos;
     const auto [dist, e_iw] = dist_vec.NormAndNormalized();
-    const auto& model = std::get<CollisionFreeSpeedModelV2Data>(ped.model);
+    const auto& model = ped.model.As<CollisionFreeSpeedModelV2Data>();
     const auto l = model.radius;
     const auto R_iw =
         -model.strengthGeometryRepulsion * exp((l - dist) / model.rangeGeometryRepulsion);
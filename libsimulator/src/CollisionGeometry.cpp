@@ -12,9 +12,12 @@
 #include <CGAL/number_utils.h>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
+#include <numeric>
+#include <optional>
 #include <set>
 #include <tuple>
 #include <vector>
@@ -42,10 +45,6 @@ std::set<Cell> cellsFromLineSegment(LineSegment ls)
         return {firstCell};
     }
 
-    if(IsN8Adjacent(firstCell, lastCell)) {
-        return {firstCell, lastCell};
-    }
-
     std::set<Cell> cells{firstCell, lastCell};
 
     const auto toMultiple = [](double x) { return ceil(x / CELL_EXTEND) * CELL_EXTEND; };
@@ -97,6 +96,162 @@ void ExtractSegmentsFromPolygon(const Poly& p, std::vector<LineSegment>& segment
     segments.emplace_back(fromPoint_2(boundary.back()), fromPoint_2(boundary.front()));
 }
 
+/// Classifies 'path.p2' from the classification of 'path.p1' by counting how often 'path' crosses
+/// the line segments in [begin, end). Returns std::nullopt if 'path' touches a line segment without
+/// properly crossing it, e.g. passes through a vertex or ends on a line segment.
+template <typename Iter>
+static std::optional<bool>
+classifyAlong(bool startInside, const LineSegment& path, Iter begin, Iter end)
+{
+    const AABB pathBounds(path.p1, path.p2);
+    bool inside = startInside;
+    for(auto iter = begin; iter != end; ++iter) {
+        const auto& ls = *iter;
+        const int o1 = orientationSign(path.p1, path.p2, ls.p1);
+        const int o2 = orientationSign(path.p1, path.p2, ls.p2);
+        const int o3 = orientationSign(ls.p1, ls.p2, path.p1);
+        const int o4 = orientationSign(ls.p1, ls.p2, path.p2);
+        if(o1 == 0 || o2 == 0 || o3 == 0 || o4 == 0) {
+            if(pathBounds.Overlap(AABB(ls.p1, ls.p2))) {
+                return std::nullopt;
+            }
+            continue;
+        }
+        if((o1 > 0) != (o2 > 0) && (o3 > 0) != (o4 > 0)) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+/// Corners of the closed cell with the lower left corner 'min'.
+static std::array<Point, 4> cellCorners(Point min)
+{
+    return {
+        min,
+        min + Point(CELL_EXTEND, 0),
+        min + Point(CELL_EXTEND, CELL_EXTEND),
+        min + Point(0, CELL_EXTEND)};
+}
+
+/// Tests if 'ls' touches the closed cell with the lower left corner 'min'. Uses exact predicates
+/// only, a line segment grazing a corner of the cell touches it.
+static bool touchesCell(const LineSegment& ls, Point min)
+{
+    const auto max = min + Point(CELL_EXTEND, CELL_EXTEND);
+    if(std::max(ls.p1.x, ls.p2.x) < min.x || std::min(ls.p1.x, ls.p2.x) > max.x ||
+       std::max(ls.p1.y, ls.p2.y) < min.y || std::min(ls.p1.y, ls.p2.y) > max.y) {
+        return false;
+    }
+    // The bounding boxes overlap, so 'ls' touches the cell unless all corners are strictly on
+    // the same side of the line through it
+    int minOrientation = 1;
+    int maxOrientation = -1;
+    for(const auto& corner : cellCorners(min)) {
+        const int orientation = orientationSign(ls.p1, ls.p2, corner);
+        minOrientation = std::min(minOrientation, orientation);
+        maxOrientation = std::max(maxOrientation, orientation);
+    }
+    return minOrientation <= 0 && maxOrientation >= 0;
+}
+
+/// Convex hull of 'points' in counterclockwise order, points on its edges are dropped. 'points' is
+/// sorted in place, the hull is written to 'hull' to reuse its storage.
+static void convexHull(std::vector<Point>& points, std::vector<Point>& hull)
+{
+    std::sort(std::begin(points), std::end(points));
+    points.erase(std::unique(std::begin(points), std::end(points)), std::end(points));
+    if(points.size() < 3) {
+        hull = points;
+        return;
+    }
+    // Andrew's monotone chain, lower hull from left to right then upper hull from right to left
+    hull.resize(2 * points.size());
+    size_t count = 0;
+    for(size_t index = 0; index < points.size(); ++index) {
+        while(count >= 2 && orientationSign(hull[count - 2], hull[count - 1], points[index]) <= 0) {
+            --count;
+        }
+        hull[count++] = points[index];
+    }
+    const auto lowerCount = count + 1;
+    for(size_t index = points.size() - 1; index > 0; --index) {
+        while(count >= lowerCount &&
+              orientationSign(hull[count - 2], hull[count - 1], points[index - 1]) <= 0) {
+            --count;
+        }
+        hull[count++] = points[index - 1];
+    }
+    // The first point has been added again as last point
+    hull.resize(count - 1);
+}
+
+/// Tests if 'ls' touches the convex polygon 'hull', given in counterclockwise order.
+static bool touchesConvexPolygon(const LineSegment& ls, const std::vector<Point>& hull)
+{
+    const auto inside = [&hull](Point p) {
+        for(size_t index = 0; index < hull.size(); ++index) {
+            if(orientationSign(hull[index], hull[(index + 1) % hull.size()], p) < 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if(inside(ls.p1) || inside(ls.p2)) {
+        return true;
+    }
+    for(size_t index = 0; index < hull.size(); ++index) {
+        if(intersects(ls, LineSegment(hull[index], hull[(index + 1) % hull.size()]))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Tests if 'ls' intersects every line from a point of cell 'a' to a point of cell 'b'. 'hull' is
+/// the convex hull of both cells.
+/// This holds if both cells are on different sides of the line through 'ls' and the line crosses
+/// the hull only within 'ls', as every such line from 'a' to 'b' crosses the hull in between.
+static bool separates(
+    const LineSegment& ls,
+    const std::array<Point, 4>& a,
+    const std::array<Point, 4>& b,
+    const std::vector<Point>& hull)
+{
+    // 1 or -1 if all corners are on the positive or negative side of 'ls' or on it, 0 otherwise
+    const auto side = [&ls](const std::array<Point, 4>& corners) {
+        int min = 1;
+        int max = -1;
+        for(const auto& corner : corners) {
+            const int orientation = orientationSign(ls.p1, ls.p2, corner);
+            min = std::min(min, orientation);
+            max = std::max(max, orientation);
+        }
+        return min >= 0 ? 1 : (max <= 0 ? -1 : 0);
+    };
+    const int sideA = side(a);
+    const int sideB = side(b);
+    if(sideA == 0 || sideB == 0 || sideA == sideB) {
+        return false;
+    }
+    const AABB segmentBounds(ls.p1, ls.p2);
+    for(size_t index = 0; index < hull.size(); ++index) {
+        const LineSegment edge(hull[index], hull[(index + 1) % hull.size()]);
+        const int o1 = orientationSign(ls.p1, ls.p2, edge.p1);
+        const int o2 = orientationSign(ls.p1, ls.p2, edge.p2);
+        if(o1 == 0 && o2 == 0) {
+            if(!segmentBounds.Inside(edge.p1) || !segmentBounds.Inside(edge.p2)) {
+                return false;
+            }
+        } else if(o1 != o2 || o1 == 0) {
+            if(!intersects(edge, ls)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 CollisionGeometry::CollisionGeometry(PolyWithHoles accessibleArea)
     : _accessibleAreaPolygon(accessibleArea)
 {
@@ -115,8 +270,9 @@ CollisionGeometry::CollisionGeometry(PolyWithHoles accessibleArea)
         insertIntoApproximateGrid(ls);
     }
 
-    for(auto& [_, vec] : _approximateGrid) {
+    for(auto& [cell, vec] : _approximateGrid) {
         vec.shrink_to_fit();
+        _packedApproximateGrid.emplace(cell, PackedLineSegments(vec));
     }
 
     const auto cvt = [](const auto& c) {
@@ -135,7 +291,10 @@ CollisionGeometry::CollisionGeometry(PolyWithHoles accessibleArea)
         std::end(_accessibleAreaPolygon.holes()),
         std::back_inserter(holes),
         [&cvt](auto&& c) { return cvt(c); });
+    _bounds = AABB(exterior);
     _accessibleArea = std::make_tuple(exterior, holes);
+    buildPointLocation();
+    buildCellVisibility();
 }
 
 const std::vector<LineSegment>& CollisionGeometry::LineSegmentsInApproxDistanceTo(Point p) const
@@ -148,9 +307,19 @@ const std::vector<LineSegment>& CollisionGeometry::LineSegmentsInApproxDistanceT
     return empty;
 }
 
+const PackedLineSegments& CollisionGeometry::PackedLineSegmentsInApproxDistanceTo(Point p) const
+{
+    const auto cell = makeCell(p);
+    if(const auto it = _packedApproximateGrid.find(cell); it != _packedApproximateGrid.end()) {
+        return it->second;
+    }
+    static const PackedLineSegments empty{};
+    return empty;
+}
+
 void CollisionGeometry::insertIntoApproximateGrid(const LineSegment& ls)
 {
-    constexpr double searchRadius = 4.;
+    constexpr double searchRadius = ApproxDistanceRange;
 
     const auto searchExtend = Point(searchRadius, searchRadius);
     const AABB lineSegmentBounds({ls.p1, ls.p2});
@@ -176,16 +345,75 @@ void CollisionGeometry::insertIntoApproximateGrid(const LineSegment& ls)
     }
 }
 
-CollisionGeometry::LineSegmentRange
-CollisionGeometry::LineSegmentsInDistanceTo(double distance, Point p) const
+std::vector<LineSegment> CollisionGeometry::LineSegmentsInDistanceTo(double distance, Point p) const
 {
-    return LineSegmentRange{
-        DistanceQueryIterator<LineSegment>{distance, p, _segments.cbegin(), _segments.cend()},
-        DistanceQueryIterator<LineSegment>{distance, p, _segments.cend(), _segments.cend()}};
+    const AABB searchBounds(p - Point(distance, distance), p + Point(distance, distance));
+    if(!searchBounds.Overlap(_bounds)) {
+        return {};
+    }
+    const auto cellBottomLeft = makeCell(
+        {std::max(searchBounds.xmin, _bounds.xmin), std::max(searchBounds.ymin, _bounds.ymin)});
+    const auto cellTopRight = makeCell(
+        {std::min(searchBounds.xmax, _bounds.xmax), std::min(searchBounds.ymax, _bounds.ymax)});
+
+    const auto firstColumn =
+        static_cast<size_t>((cellBottomLeft.x - _locationOrigin.x) / CELL_EXTEND);
+    const auto firstRow = static_cast<size_t>((cellBottomLeft.y - _locationOrigin.y) / CELL_EXTEND);
+    const auto lastColumn = std::min(
+        static_cast<size_t>((cellTopRight.x - _locationOrigin.x) / CELL_EXTEND),
+        _locationColumns - 1);
+    const auto lastRow = std::min(
+        static_cast<size_t>((cellTopRight.y - _locationOrigin.y) / CELL_EXTEND), _locationRows - 1);
+
+    // The cells of the point location grid list every line segment touching them
+    std::vector<LineSegment> result{};
+    for(size_t row = firstRow; row <= lastRow; ++row) {
+        for(size_t column = firstColumn; column <= lastColumn; ++column) {
+            const auto index = row * _locationColumns + column;
+            std::copy_if(
+                std::next(std::begin(_cellSegments), _cellSegmentOffsets[index]),
+                std::next(std::begin(_cellSegments), _cellSegmentOffsets[index + 1]),
+                std::back_inserter(result),
+                [distance, p](const auto& ls) { return dist(ls, p) <= distance; });
+        }
+    }
+    // Linesegments spanning multiple cells are found once per cell
+    std::sort(std::begin(result), std::end(result));
+    result.erase(std::unique(std::begin(result), std::end(result)), std::end(result));
+    return result;
 }
 
 bool CollisionGeometry::IntersectsAny(const LineSegment& linesegment) const
 {
+    if(const auto cells = neighboringCells(linesegment.p1, linesegment.p2); cells) {
+        switch(_cellVisibility[visibilityIndex(*cells)]) {
+            case CellVisibility::Visible:
+                return false;
+            case CellVisibility::Blocked:
+                return true;
+            case CellVisibility::Partial:
+                break;
+        }
+        // The line segment does not leave the cells spanned by both of its ends
+        for(auto row = std::min(cells->row, cells->neighborRow);
+            row <= std::max(cells->row, cells->neighborRow);
+            ++row) {
+            for(auto column = std::min(cells->column, cells->neighborColumn);
+                column <= std::max(cells->column, cells->neighborColumn);
+                ++column) {
+                const auto index = row * _locationColumns + column;
+                if(std::any_of(
+                       std::next(std::begin(_cellSegments), _cellSegmentOffsets[index]),
+                       std::next(std::begin(_cellSegments), _cellSegmentOffsets[index + 1]),
+                       [&linesegment](const auto& candidate) {
+                           return intersects(linesegment, candidate);
+                       })) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
     const auto cellsToQuery = cellsFromLineSegment(linesegment);
     for(const auto& cell : cellsToQuery) {
         const auto iter = _grid.find(cell);
@@ -202,14 +430,238 @@ bool CollisionGeometry::IntersectsAny(const LineSegment& linesegment) const
     return false;
 }
 
+CellVisibility CollisionGeometry::VisibilityBetween(Point a, Point b) const
+{
+    const auto cells = neighboringCells(a, b);
+    return cells ? _cellVisibility[visibilityIndex(*cells)] : CellVisibility::Partial;
+}
+
+std::optional<CollisionGeometry::NeighboringCells>
+CollisionGeometry::neighboringCells(Point a, Point b) const
+{
+    if(!_bounds.Inside(a) || !_bounds.Inside(b)) {
+        return std::nullopt;
+    }
+    const auto cellA = (makeCell(a) - _locationOrigin) / CELL_EXTEND;
+    const auto cellB = (makeCell(b) - _locationOrigin) / CELL_EXTEND;
+    if(std::abs(cellA.x - cellB.x) > 1 || std::abs(cellA.y - cellB.y) > 1) {
+        return std::nullopt;
+    }
+    return NeighboringCells{
+        static_cast<size_t>(cellA.x),
+        static_cast<size_t>(cellA.y),
+        static_cast<size_t>(cellB.x),
+        static_cast<size_t>(cellB.y)};
+}
+
+size_t CollisionGeometry::visibilityIndex(const NeighboringCells& cells) const
+{
+    const auto index = cells.row * _locationColumns + cells.column;
+    return index * 9 + (cells.neighborRow + 1 - cells.row) * 3 + cells.neighborColumn + 1 -
+           cells.column;
+}
+
 bool CollisionGeometry::InsideGeometry(Point p) const
+{
+    if(!_bounds.Inside(p)) {
+        return false;
+    }
+    const auto cell = makeCell(p);
+    const auto column = static_cast<size_t>((cell.x - _locationOrigin.x) / CELL_EXTEND);
+    const auto row = static_cast<size_t>((cell.y - _locationOrigin.y) / CELL_EXTEND);
+    const auto index = row * _locationColumns + column;
+    const auto center = cell + Point{CELL_EXTEND / 2., CELL_EXTEND / 2.};
+    const auto inside = classifyAlong(
+        _centerInside[index],
+        {center, p},
+        std::next(std::begin(_cellSegments), _cellSegmentOffsets[index]),
+        std::next(std::begin(_cellSegments), _cellSegmentOffsets[index + 1]));
+    return inside ? *inside : insideAccessibleArea(p);
+}
+
+bool CollisionGeometry::insideAccessibleArea(Point p) const
 {
     return CGAL::oriented_side(K::Point_2(p.x, p.y), _accessibleAreaPolygon) !=
            CGAL::ON_NEGATIVE_SIDE;
 }
 
+void CollisionGeometry::buildPointLocation()
+{
+    _locationOrigin = makeCell(_bounds.BottomLeft());
+    const auto lastCell = makeCell(_bounds.TopRight());
+    _locationColumns = static_cast<size_t>((lastCell.x - _locationOrigin.x) / CELL_EXTEND) + 1;
+    _locationRows = static_cast<size_t>((lastCell.y - _locationOrigin.y) / CELL_EXTEND) + 1;
+    const auto cellCount = _locationColumns * _locationRows;
+
+    const auto cellMin = [this](size_t column, size_t row) {
+        return _locationOrigin + Point(column * CELL_EXTEND, row * CELL_EXTEND);
+    };
+    // Visits all cells whose closed area touches 'ls', a line segment on the border between two
+    // cells belongs to both.
+    const auto forEachCellTouching = [this, &cellMin](const LineSegment& ls, auto&& func) {
+        const AABB segmentBounds(ls.p1, ls.p2);
+        const auto first = makeCell(segmentBounds.BottomLeft()) - _locationOrigin;
+        const auto last = makeCell(segmentBounds.TopRight()) - _locationOrigin;
+        const auto firstColumn = static_cast<size_t>(std::max(first.x / CELL_EXTEND - 1, 0.));
+        const auto firstRow = static_cast<size_t>(std::max(first.y / CELL_EXTEND - 1, 0.));
+        const auto lastColumn = static_cast<size_t>(last.x / CELL_EXTEND);
+        const auto lastRow = static_cast<size_t>(last.y / CELL_EXTEND);
+        for(size_t row = firstRow; row <= lastRow; ++row) {
+            for(size_t column = firstColumn; column <= lastColumn; ++column) {
+                if(touchesCell(ls, cellMin(column, row))) {
+                    func(row * _locationColumns + column);
+                }
+            }
+        }
+    };
+
+    _cellSegmentOffsets.assign(cellCount + 1, 0);
+    for(const auto& ls : _segments) {
+        forEachCellTouching(ls, [this](size_t index) { ++_cellSegmentOffsets[index + 1]; });
+    }
+    std::partial_sum(
+        std::begin(_cellSegmentOffsets),
+        std::end(_cellSegmentOffsets),
+        std::begin(_cellSegmentOffsets));
+    _cellSegments.resize(_cellSegmentOffsets.back());
+    std::vector<size_t> insertAt(
+        std::begin(_cellSegmentOffsets), std::prev(std::end(_cellSegmentOffsets)));
+    for(const auto& ls : _segments) {
+        forEachCellTouching(
+            ls, [this, &ls, &insertAt](size_t index) { _cellSegments[insertAt[index]++] = ls; });
+    }
+
+    const auto classify = [this](bool startInside, const LineSegment& path, size_t index) {
+        const auto inside = classifyAlong(
+            startInside,
+            path,
+            std::next(std::begin(_cellSegments), _cellSegmentOffsets[index]),
+            std::next(std::begin(_cellSegments), _cellSegmentOffsets[index + 1]));
+        return inside ? *inside : insideAccessibleArea(path.p2);
+    };
+
+    // Each row is walked from left to right, stepping from the center of one cell to the next.
+    // Each step only needs to check the line segments of the cells it passes through.
+    _centerInside.assign(cellCount, false);
+    for(size_t row = 0; row < _locationRows; ++row) {
+        // The left border of the grid is outside of the accessible area, unless it touches the
+        // boundary, which is detected when leaving it.
+        auto from = cellMin(0, row) + Point(0, CELL_EXTEND / 2.);
+        bool fromInside = false;
+        for(size_t column = 0; column < _locationColumns; ++column) {
+            const auto index = row * _locationColumns + column;
+            const auto center = cellMin(column, row) + Point(CELL_EXTEND / 2., CELL_EXTEND / 2.);
+            const auto right = center + Point(CELL_EXTEND / 2., 0);
+            _centerInside[index] = classify(fromInside, {from, center}, index);
+            fromInside = classify(_centerInside[index], {center, right}, index);
+            from = right;
+        }
+    }
+}
+
+void CollisionGeometry::buildCellVisibility()
+{
+    const auto cellMin = [this](size_t column, size_t row) {
+        return _locationOrigin + Point(column * CELL_EXTEND, row * CELL_EXTEND);
+    };
+
+    // Pairs with a cell outside of the grid stay partial
+    _cellVisibility.assign(_locationColumns * _locationRows * 9, CellVisibility::Partial);
+    // Reused for all pairs, so that only few pairs allocate
+    std::vector<Point> corners{};
+    std::vector<Point> hull{};
+    std::vector<LineSegment> candidates{};
+    const auto classify = [&](const NeighboringCells& cells) {
+        // Line segments touching the hull touch one of the cells spanned by both cells
+        candidates.clear();
+        for(auto row = std::min(cells.row, cells.neighborRow);
+            row <= std::max(cells.row, cells.neighborRow);
+            ++row) {
+            for(auto column = std::min(cells.column, cells.neighborColumn);
+                column <= std::max(cells.column, cells.neighborColumn);
+                ++column) {
+                const auto index = row * _locationColumns + column;
+                candidates.insert(
+                    std::end(candidates),
+                    std::next(std::begin(_cellSegments), _cellSegmentOffsets[index]),
+                    std::next(std::begin(_cellSegments), _cellSegmentOffsets[index + 1]));
+            }
+        }
+        // Most cells are far from any wall
+        if(candidates.empty()) {
+            return CellVisibility::Visible;
+        }
+
+        const auto cornersA = cellCorners(cellMin(cells.column, cells.row));
+        const auto cornersB = cellCorners(cellMin(cells.neighborColumn, cells.neighborRow));
+        corners.assign(std::begin(cornersA), std::end(cornersA));
+        corners.insert(std::end(corners), std::begin(cornersB), std::end(cornersB));
+        convexHull(corners, hull);
+
+        if(std::none_of(std::begin(candidates), std::end(candidates), [&hull](const auto& ls) {
+               return touchesConvexPolygon(ls, hull);
+           })) {
+            return CellVisibility::Visible;
+        }
+        if(std::any_of(std::begin(candidates), std::end(candidates), [&](const auto& ls) {
+               return separates(ls, cornersA, cornersB, hull);
+           })) {
+            return CellVisibility::Blocked;
+        }
+        return CellVisibility::Partial;
+    };
+
+    // The visibility is symmetric, each pair is classified once and stored for both cells
+    for(size_t row = 0; row < _locationRows; ++row) {
+        for(size_t column = 0; column < _locationColumns; ++column) {
+            for(auto neighborRow = row; neighborRow <= std::min(row + 1, _locationRows - 1);
+                ++neighborRow) {
+                for(auto neighborColumn = std::max(column, size_t{1}) - 1;
+                    neighborColumn <= std::min(column + 1, _locationColumns - 1);
+                    ++neighborColumn) {
+                    if(neighborRow == row && neighborColumn < column) {
+                        continue;
+                    }
+                    const NeighboringCells cells{column, row, neighborColumn, neighborRow};
+                    const auto visibility = classify(cells);
+                    _cellVisibility[visibilityIndex(cells)] = visibility;
+                    _cellVisibility[visibilityIndex(
+                        {neighborColumn, neighborRow, column, row})] = visibility;
+                }
+            }
+        }
+    }
+}
+
 const std::tuple<std::vector<Point>, std::vector<std::vector<Point>>>&
 CollisionGeometry::AccessibleArea() const
 {
     return _accessibleArea;
 }
+
+LineOfSight::LineOfSight(const CollisionGeometry& geometry_, Point origin_, double radius)
+    : geometry(geometry_), origin(origin_)
+{
+    if(radius <= CollisionGeometry::ApproxDistanceRange) {
+        segments = &geometry.PackedLineSegmentsInApproxDistanceTo(origin);
+    } else {
+        segmentsInRange = PackedLineSegments(geometry.LineSegmentsInDistanceTo(radius, origin));
+        segments = &segmentsInRange;
+    }
+}
+
+bool LineOfSight::IsVisible(Point target) const
+{
+    if(segments->empty()) {
+        return true;
+    }
+    switch(geometry.VisibilityBetween(origin, target)) {
+        case CellVisibility::Visible:
+            return true;
+        case CellVisibility::Blocked:
+            return false;
+        case CellVisibility::Partial:
+            break;
+    }
+    return !intersectsAny(LineSegment(origin, target), *segments);
+}
@@ -1,16 +1,18 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AABB.hpp"
 #include "CfgCgal.hpp"
+#include "GeometricFunctions.hpp"
 #include "HashCombine.hpp"
-#include "IteratorPair.hpp"
 #include "LineSegment.hpp"
 #include "Point.hpp"
 #include "UniqueID.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <iterator>
+#include <optional>
 #include <set>
 #include <tuple>
 #include <unordered_map>
@@ -20,52 +22,6 @@ class CollisionGeometry;
 
 double dist(LineSegment l, Point p);
 
-template <typename T>
-class DistanceQueryIterator
-{
-private:
-    using BackingIterator = typename std::vector<T>::const_iterator;
-    double _distance;
-    Point _p;
-    BackingIterator _current;
-    BackingIterator _end;
-
-public:
-    using iterator_category = std::input_iterator_tag;
-    using value_type = T;
-    using difference_type = std::ptrdiff_t;
-    using pointer = T*;
-    using reference = T&;
-    DistanceQueryIterator(double distance, Point p, BackingIterator current, BackingIterator end)
-        : _distance(distance)
-        , _p(p)
-        , _current(
-              std::find_if(
-                  current,
-                  end,
-                  [this](const auto& t) { return dist(t, _p) <= _distance; }))
-        , _end(end)
-    {
-    }
-    ~DistanceQueryIterator() = default;
-    DistanceQueryIterator(const DistanceQueryIterator& other) = default;
-    DistanceQueryIterator& operator=(const DistanceQueryIterator& other) = default;
-
-    bool operator==(const DistanceQueryIterator& other) const { return _current == other._current; }
-
-    bool operator!=(const DistanceQueryIterator& other) const { return !(*this == other); }
-
-    DistanceQueryIterator& operator++()
-    {
-        do {
-            ++_current;
-        } while(_current != _end && dist(*_current, _p) > _distance);
-        return *this;
-    }
-
-    const T& operator*() const { return *_current; }
-};
-
 /// Encodes a cell in the geometry grid.
 /// Cells are defined on the intervalls [min.x, min.x + extend), [min.y, min.y + extend)
 const int CELL_EXTEND = 4;
@@ -92,21 +48,50 @@ struct std::hash<Cell> {
 /// Creates all cells that are trouched by the linesegment
 std::set<Cell> cellsFromLineSegment(LineSegment ls);
 
+/// Visibility between all points of two cells of the geometry grid.
+enum class CellVisibility : uint8_t {
+    /// No linesegment intersects the line between any point of one cell and any of the other cell
+    Visible,
+    /// Some linesegment intersects the line between any point of one cell and any of the other cell
+    Blocked,
+    /// Needs to be decided for each pair of points
+    Partial
+};
+
 class CollisionGeometry
 {
 public:
     using ID = jps::UniqueID<CollisionGeometry>;
+    /// All linesegments within this distance of a point are returned by
+    /// 'LineSegmentsInApproxDistanceTo'.
+    static constexpr double ApproxDistanceRange{4.};
 
 private:
     ID _id{};
     PolyWithHoles _accessibleAreaPolygon;
     std::vector<LineSegment> _segments;
     std::unordered_map<Cell, std::set<LineSegment>> _grid{};
+    /// Bounds of all line segments, limits the cells visited by distance queries.
+    AABB _bounds{};
+    /// Point location grid used by 'InsideGeometry', covers '_bounds' with cells of CELL_EXTEND.
+    /// Stores for each cell if its center is inside the accessible area and the line segments
+    /// touching the cell. Cell 'i' is at row 'i / _locationColumns' and owns the line segments
+    /// in [_cellSegmentOffsets[i], _cellSegmentOffsets[i + 1]).
+    Cell _locationOrigin{};
+    size_t _locationColumns{};
+    size_t _locationRows{};
+    std::vector<bool> _centerInside{};
+    std::vector<size_t> _cellSegmentOffsets{};
+    std::vector<LineSegment> _cellSegments{};
+    /// Visibility of each cell of the point location grid to itself and its N8 neighbors. The
+    /// visibility of cell 'i' to the cell at offset (dx, dy) is at 'i * 9 + (dy + 1) * 3 + dx + 1'.
+    std::vector<CellVisibility> _cellVisibility{};
     std::unordered_map<Cell, std::vector<LineSegment>> _approximateGrid{};
+    /// Same content as '_approximateGrid', packed for batched intersection tests.
+    std::unordered_map<Cell, PackedLineSegments> _packedApproximateGrid{};
     std::tuple<std::vector<Point>, std::vector<std::vector<Point>>> _accessibleArea{};
 
 public:
-    using LineSegmentRange = IteratorPair<DistanceQueryIterator<LineSegment>>;
     /// Do not call constructor drectly use 'GeometryBuilder'
     /// @param segments line segments constituting the geometry
     explicit CollisionGeometry(PolyWithHoles accessibleArea);
@@ -120,20 +105,35 @@ public:
     CollisionGeometry(CollisionGeometry&& other) = default;
     /// Moveable
     CollisionGeometry& operator=(CollisionGeometry&& other) = default;
-    /// Returns an iterator pair to all linesegments <= 'distance' away from 'p'
+    /// Returns all linesegments <= 'distance' away from 'p'
+    /// Only the grid cells overlapping the circle around 'p' are searched, so the cost depends on
+    /// the number of linesegments close to 'p' and not on the size of the geometry.
     /// @param distance from reference point
     /// @param p reference point
-    /// @return iterator_pair to all linesegments in range
-    LineSegmentRange LineSegmentsInDistanceTo(double distance, Point p) const;
+    /// @return linesegments in range, in no particular order
+    std::vector<LineSegment> LineSegmentsInDistanceTo(double distance, Point p) const;
 
     const std::vector<LineSegment>& LineSegmentsInApproxDistanceTo(Point p) const;
 
+    /// Same as 'LineSegmentsInApproxDistanceTo', packed for 'intersectsAny'.
+    const PackedLineSegments& PackedLineSegmentsInApproxDistanceTo(Point p) const;
+
     /// Will perfrom a linesegment intersection versus the whole geometry, i.e. walls and closed
     /// doors.
+    /// Line segments with both ends in the same or in neighboring cells only need to be tested
+    /// against the walls near them, if 'VisibilityBetween' does not already decide the test.
     /// @param linesegment to test for intersection with geometry
     /// @return if any linesegment of the geometry was intersected.
     bool IntersectsAny(const LineSegment& linesegment) const;
 
+    /// Visibility between the cells containing 'a' and 'b'.
+    /// Precomputed on construction for cells that are the same or N8 neighbors, all other pairs
+    /// and cells outside of the geometry are 'Partial'.
+    CellVisibility VisibilityBetween(Point a, Point b) const;
+
+    /// Tests if 'p' is inside the accessible area or on its boundary.
+    /// Classifies 'p' relative to the center of its cell in the point location grid, only points
+    /// touching the boundary in a degenerate way need an exact test against the whole polygon.
     bool InsideGeometry(Point p) const;
 
     const std::tuple<std::vector<Point>, std::vector<std::vector<Point>>>& AccessibleArea() const;
@@ -144,4 +144,44 @@ public:
 
 private:
     void insertIntoApproximateGrid(const LineSegment& ls);
+    void buildPointLocation();
+    void buildCellVisibility();
+    /// Cells of the point location grid containing 'a' and 'b', if they are the same or N8
+    /// neighbors.
+    struct NeighboringCells {
+        size_t column;
+        size_t row;
+        size_t neighborColumn;
+        size_t neighborRow;
+    };
+    std::optional<NeighboringCells> neighboringCells(Point a, Point b) const;
+    size_t visibilityIndex(const NeighboringCells& cells) const;
+    bool insideAccessibleArea(Point p) const;
+};
+
+/// Line of sight tests from 'origin' to points within 'radius' of it.
+///
+/// The linesegments that may block the view are looked up once on construction, so that each test
+/// only checks those. For radii within CollisionGeometry::ApproxDistanceRange the approximate grid
+/// is used without copying, tests are skipped entirely if the cell of 'origin' has no walls nearby.
+/// The linesegments are packed, so that each test checks several of them at once. Targets in cells
+/// that are entirely visible or blocked from the cell of 'origin' need no test at all.
+class LineOfSight
+{
+    const CollisionGeometry& geometry;
+    Point origin;
+    PackedLineSegments segmentsInRange{};
+    const PackedLineSegments* segments;
+
+public:
+    LineOfSight(const CollisionGeometry& geometry_, Point origin_, double radius);
+    ~LineOfSight() = default;
+    /// Non-copyable, may refer to its own member
+    LineOfSight(const LineOfSight& other) = delete;
+    /// Non-copyable, may refer to its own member
+    LineOfSight& operator=(const LineOfSight& other) = delete;
+
+    /// Tests if no linesegment of the geometry intersects the line from the origin to 'target'.
+    /// @param target needs to be within 'radius' of the origin
+    bool IsVisible(Point target) const;
 };
@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "DenseNeighborhoodSearch.hpp"
+
+#include "AABB.hpp"
+#include "Point.hpp"
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+/// Spare slots of a cell holding 'count' keys after a rebuild.
+uint32_t spareSlots(uint32_t count, bool nearOccupied)
+{
+    if(count > 0) {
+        return count / 2 + 2;
+    }
+    // Empty cells next to agents are entered first
+    return nearOccupied ? 2 : 0;
+}
+} // namespace
+
+DenseNeighborhoodSearch::DenseNeighborhoodSearch(double cellSize)
+    : _minCellSize(cellSize), _cellSize(cellSize)
+{
+}
+
+void DenseNeighborhoodSearch::SetBounds(const AABB& bounds)
+{
+    const auto width = std::max(bounds.xmax - bounds.xmin, 0.0);
+    const auto height = std::max(bounds.ymax - bounds.ymin, 0.0);
+    _cellSize =
+        std::max(_minCellSize, std::sqrt(width * height / static_cast<double>(MaxCellCount)));
+    _origin = {bounds.xmin, bounds.ymin};
+    _columns = static_cast<size_t>(width / _cellSize) + 1;
+    _rows = static_cast<size_t>(height / _cellSize) + 1;
+    _cellStarts.assign(_columns * _rows + 1, 0);
+    _cellCounts.assign(_columns * _rows, 0);
+    _slotPositions.clear();
+    _slotKeys.clear();
+    _slotOfKey.clear();
+    _cellOfKey.clear();
+    _pendingPositions.clear();
+    _pendingKeys.clear();
+}
+
+void DenseNeighborhoodSearch::Update(const std::vector<Point>& positions, WorkerPool& pool)
+{
+    const auto count = positions.size();
+    _slotOfKey.assign(count, NotPresent);
+    _cellOfKey.resize(count);
+    _pendingPositions.clear();
+    _pendingKeys.clear();
+
+    pool.ParallelFor(count, [this, &positions](size_t begin, size_t end) {
+        for(auto key = begin; key < end; ++key) {
+            _cellOfKey[key] = static_cast<uint32_t>(cellOf(positions[key]));
+        }
+    });
+
+    std::fill(std::begin(_cellCounts), std::end(_cellCounts), 0);
+    for(const auto cell : _cellOfKey) {
+        ++_cellCounts[cell];
+    }
+
+    // '_moved' marks cells next to an occupied cell here
+    _moved.assign(_cellCounts.size(), 0);
+    for(size_t y = 0; y < _rows; ++y) {
+        for(size_t x = 0; x < _columns; ++x) {
+            if(_cellCounts[y * _columns + x] == 0) {
+                continue;
+            }
+            for(auto ny = y == 0 ? 0 : y - 1; ny <= std::min(y + 1, _rows - 1); ++ny) {
+                for(auto nx = x == 0 ? 0 : x - 1; nx <= std::min(x + 1, _columns - 1); ++nx) {
+                    _moved[ny * _columns + nx] = 1;
+                }
+            }
+        }
+    }
+
+    _cellStarts[0] = 0;
+    for(size_t cell = 0; cell < _cellCounts.size(); ++cell) {
+        _cellStarts[cell + 1] = _cellStarts[cell] + _cellCounts[cell] +
+                                spareSlots(_cellCounts[cell], _moved[cell] != 0);
+    }
+    _slotPositions.resize(_cellStarts.back());
+    _slotKeys.resize(_cellStarts.back());
+
+    _cursors.assign(std::begin(_cellStarts), std::end(_cellStarts) - 1);
+    for(size_t key = 0; key < count; ++key) {
+        const auto slot = _cursors[_cellOfKey[key]]++;
+        _slotPositions[slot] = positions[key];
+        _slotKeys[slot] = key;
+        _slotOfKey[key] = slot;
+    }
+}
+
+size_t DenseNeighborhoodSearch::MoveAll(const std::vector<Point>& positions, WorkerPool& pool)
+{
+    resizeKeys(positions.size());
+    _moved.resize(positions.size());
+    pool.ParallelFor(positions.size(), [this, &positions](size_t begin, size_t end) {
+        for(auto key = begin; key < end; ++key) {
+            const auto slot = _slotOfKey[key];
+            if(slot == NotPresent || slot == Pending) {
+                // Retry to place pending keys into their cell
+                _moved[key] = 1;
+                continue;
+            }
+            _slotPositions[slot] = positions[key];
+            _moved[key] = cellOf(positions[key]) != _cellOfKey[key];
+        }
+    });
+
+    size_t movedCount{0};
+    for(size_t key = 0; key < positions.size(); ++key) {
+        if(_moved[key] == 0) {
+            continue;
+        }
+        if(_slotOfKey[key] != NotPresent) {
+            unplace(key);
+        }
+        place(key, positions[key], cellOf(positions[key]));
+        ++movedCount;
+    }
+    return movedCount;
+}
+
+void DenseNeighborhoodSearch::Insert(size_t key, Point pos)
+{
+    resizeKeys(key + 1);
+    if(_slotOfKey[key] != NotPresent) {
+        unplace(key);
+    }
+    place(key, pos, cellOf(pos));
+}
+
+void DenseNeighborhoodSearch::Erase(size_t key)
+{
+    if(Contains(key)) {
+        unplace(key);
+    }
+}
+
+void DenseNeighborhoodSearch::Rekey(size_t from, size_t to)
+{
+    resizeKeys(to + 1);
+    const auto slot = _slotOfKey[from];
+    if(slot == Pending) {
+        *std::find(std::begin(_pendingKeys), std::end(_pendingKeys), from) = to;
+    } else {
+        _slotKeys[slot] = to;
+    }
+    _slotOfKey[to] = slot;
+    _cellOfKey[to] = _cellOfKey[from];
+    _slotOfKey[from] = NotPresent;
+}
+
+std::vector<size_t> DenseNeighborhoodSearch::GetNeighbors(Point pos, double radius) const
+{
+    std::vector<size_t> result{};
+    ForEachNeighbor(pos, radius, [&result](size_t key) { result.push_back(key); });
+    return result;
+}
+
+size_t DenseNeighborhoodSearch::column(double x) const
+{
+    const auto column = std::floor((x - _origin.x) / _cellSize);
+    return static_cast<size_t>(std::clamp(column, 0.0, static_cast<double>(_columns - 1)));
+}
+
+size_t DenseNeighborhoodSearch::row(double y) const
+{
+    const auto row = std::floor((y - _origin.y) / _cellSize);
+    return static_cast<size_t>(std::clamp(row, 0.0, static_cast<double>(_rows - 1)));
+}
+
+void DenseNeighborhoodSearch::resizeKeys(size_t count)
+{
+    if(count > _slotOfKey.size()) {
+        _slotOfKey.resize(count, NotPresent);
+        _cellOfKey.resize(count, 0);
+    }
+}
+
+void DenseNeighborhoodSearch::place(size_t key, Point pos, size_t cell)
+{
+    _cellOfKey[key] = static_cast<uint32_t>(cell);
+    if(_cellStarts[cell] + _cellCounts[cell] < _cellStarts[cell + 1]) {
+        const auto slot = _cellStarts[cell] + _cellCounts[cell]++;
+        _slotPositions[slot] = pos;
+        _slotKeys[slot] = key;
+        _slotOfKey[key] = slot;
+    } else {
+        _pendingPositions.push_back(pos);
+        _pendingKeys.push_back(key);
+        _slotOfKey[key] = Pending;
+    }
+}
+
+void DenseNeighborhoodSearch::unplace(size_t key)
+{
+    const auto slot = _slotOfKey[key];
+    _slotOfKey[key] = NotPresent;
+    if(slot == Pending) {
+        const auto index = static_cast<size_t>(std::distance(
+            std::begin(_pendingKeys),
+            std::find(std::begin(_pendingKeys), std::end(_pendingKeys), key)));
+        _pendingKeys[index] = _pendingKeys.back();
+        _pendingPositions[index] = _pendingPositions.back();
+        _pendingKeys.pop_back();
+        _pendingPositions.pop_back();
+        return;
+    }
+    // Fill the gap with the last key of the cell
+    const auto cell = _cellOfKey[key];
+    const auto last = _cellStarts[cell] + --_cellCounts[cell];
+    if(last != slot) {
+        _slotPositions[slot] = _slotPositions[last];
+        _slotKeys[slot] = _slotKeys[last];
+        _slotOfKey[_slotKeys[slot]] = slot;
+    }
+}
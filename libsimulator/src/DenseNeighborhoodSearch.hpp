@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "AABB.hpp"
+#include "Point.hpp"
+#include "WorkerPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/// Uniform grid over a fixed rectangle storing keyed positions, e.g. agents by index.
+///
+/// Positions are stored sorted by cell in flat arrays. Each cell owns the range
+/// ['_cellStarts[c]', '_cellStarts[c + 1]') of which the first '_cellCounts[c]' slots are in use.
+/// The remaining slots are spare capacity, so that keys can move between cells without
+/// rebuilding the grid. A full rebuild with 'Update' is a counting sort, linear in the number of
+/// keys. 'MoveAll' only relocates the keys that changed their cell.
+///
+/// Keys that do not fit into their cell are kept in a separate pending list that is scanned
+/// linearly by queries, until the next full rebuild.
+///
+/// Positions outside of the rectangle are stored in the closest border cell, so the bounds only
+/// affect performance, not the result of a query.
+class DenseNeighborhoodSearch
+{
+public:
+    /// Upper bound for the number of cells, on very large bounds the cells get larger instead.
+    static constexpr size_t MaxCellCount{size_t{1} << 20};
+
+private:
+    static constexpr size_t NotPresent{std::numeric_limits<size_t>::max()};
+    static constexpr size_t Pending{NotPresent - 1};
+
+    double _minCellSize;
+    double _cellSize;
+    Point _origin{};
+    size_t _columns{1};
+    size_t _rows{1};
+
+    std::vector<uint32_t> _cellStarts{0, 0};
+    std::vector<uint32_t> _cellCounts{0};
+    std::vector<Point> _slotPositions{};
+    std::vector<size_t> _slotKeys{};
+
+    /// Slot of each key, 'Pending' or 'NotPresent'.
+    std::vector<size_t> _slotOfKey{};
+    std::vector<uint32_t> _cellOfKey{};
+
+    std::vector<Point> _pendingPositions{};
+    std::vector<size_t> _pendingKeys{};
+
+    // Scratch space of 'Update' and 'MoveAll'
+    std::vector<uint8_t> _moved{};
+    std::vector<uint32_t> _cursors{};
+
+public:
+    explicit DenseNeighborhoodSearch(double cellSize);
+
+    /// Sets the area covered by the grid and removes all keys.
+    void SetBounds(const AABB& bounds);
+
+    /// Replaces the content of the grid, key i is placed at 'positions[i]'. Cells are computed on
+    /// 'pool', the keys are then placed sequentially so that the order within a cell does not
+    /// depend on the number of threads.
+    void Update(const std::vector<Point>& positions, WorkerPool& pool);
+
+    /// Moves key i to 'positions[i]', all keys in [0, positions.size()) need to be present.
+    /// Only keys that changed their cell are relocated.
+    /// @return number of keys that changed their cell.
+    size_t MoveAll(const std::vector<Point>& positions, WorkerPool& pool);
+
+    void Insert(size_t key, Point pos);
+    void Erase(size_t key);
+    /// Renames 'from' to 'to', 'to' must not be present.
+    void Rekey(size_t from, size_t to);
+
+    bool Contains(size_t key) const
+    {
+        return key < _slotOfKey.size() && _slotOfKey[key] != NotPresent;
+    }
+    size_t CountPending() const { return _pendingKeys.size(); }
+    double CellSize() const { return _cellSize; }
+
+    /// Calls 'visitor' with the key of each position within 'radius' of 'pos'.
+    template <typename Visitor>
+    void ForEachNeighbor(Point pos, double radius, Visitor&& visitor) const
+    {
+        const auto radiusSquared = radius * radius;
+        const auto xMin = column(pos.x - radius);
+        const auto xMax = column(pos.x + radius);
+        const auto yMin = row(pos.y - radius);
+        const auto yMax = row(pos.y + radius);
+
+        for(auto y = yMin; y <= yMax; ++y) {
+            for(auto cell = y * _columns + xMin; cell <= y * _columns + xMax; ++cell) {
+                const auto first = _cellStarts[cell];
+                const auto last = first + _cellCounts[cell];
+                for(auto slot = first; slot < last; ++slot) {
+                    if(DistanceSquared(_slotPositions[slot], pos) <= radiusSquared) {
+                        visitor(_slotKeys[slot]);
+                    }
+                }
+            }
+        }
+        for(size_t index = 0; index < _pendingKeys.size(); ++index) {
+            if(DistanceSquared(_pendingPositions[index], pos) <= radiusSquared) {
+                visitor(_pendingKeys[index]);
+            }
+        }
+    }
+
+    std::vector<size_t> GetNeighbors(Point pos, double radius) const;
+
+private:
+    size_t column(double x) const;
+    size_t row(double y) const;
+    size_t cellOf(Point pos) const { return row(pos.y) * _columns + column(pos.x); }
+
+    void resizeKeys(size_t count);
+    /// Places 'key' into its cell or the pending list.
+    void place(size_t key, Point pos, size_t cell);
+    /// Removes 'key' from its cell or the pending list.
+    void unplace(size_t key);
+};
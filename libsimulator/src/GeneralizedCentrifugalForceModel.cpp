@@ -1,18 +1,19 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "GeneralizedCentrifugalForceModel.hpp"
 
+#include "AgentNeighborhoodSearch.hpp"
+#include "AgentStore.hpp"
 #include "Ellipse.hpp"
 #include "GeneralizedCentrifugalForceModelData.hpp"
-#include "GenericAgent.hpp"
 #include "Macros.hpp"
 #include "Mathematics.hpp"
-#include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
 #include "Simulation.hpp"
 
 #include <Logger.hpp>
 
+#include <numeric>
 #include <stdexcept>
 
 GeneralizedCentrifugalForceModel::GeneralizedCentrifugalForceModel(
@@ -42,29 +43,27 @@ OperationalModelType GeneralizedCentrifugalForceModel::Type() const
 
 OperationalModelUpdate GeneralizedCentrifugalForceModel::ComputeNewPosition(
     double dT,
-    const GenericAgent& agent,
+    ConstAgentRef agent,
     const CollisionGeometry& geometry,
     const NeighborhoodSearchType& neighborhoodSearch) const
 {
-    const double radius = 4.0; // TODO (MC) check this free parameter
-    const auto neighborhood = neighborhoodSearch.GetNeighboringAgents(agent.pos, radius);
     const auto p1 = agent.pos;
     Point F_rep;
-    for(const auto& neighbor : neighborhood) {
+    neighborhoodSearch.ForEachNeighbor(agent, _cutOffRadius, [&](ConstAgentRef neighbor) {
         // TODO(schroedtert): Only use neighbors who have an unobstructed line of sight to the
         // current agent
         if(neighbor.id == agent.id) {
-            continue;
+            return;
         }
         if(!geometry.IntersectsAny(LineSegment(p1, neighbor.pos))) {
             F_rep += ForceRepPed(agent, neighbor);
         }
-    }
+    });
 
     GeneralizedCentrifugalForceModelUpdate update{};
     // repulsive forces to the walls and transitions that are not my target
     Point repwall = ForceRepRoom(agent, geometry);
-    const auto& model = std::get<GeneralizedCentrifugalForceModelData>(agent.model);
+    const auto& model = agent.model.As<GeneralizedCentrifugalForceModelData>();
     Point fd = ForceDriv(agent, agent.destination, model.mass, model.tau, dT, update);
     Point acc = (fd + F_rep + repwall) / model.mass;
 
@@ -75,9 +74,9 @@ OperationalModelUpdate GeneralizedCentrifugalForceModel::ComputeNewPosition(
 
 void GeneralizedCentrifugalForceModel::ApplyUpdate(
     const OperationalModelUpdate& upd,
-    GenericAgent& agent) const
+    AgentRef agent) const
 {
-    auto& model = std::get<GeneralizedCentrifugalForceModelData>(agent.model);
+    auto& model = agent.model.As<GeneralizedCentrifugalForceModelData>();
     const auto& update = std::get<GeneralizedCentrifugalForceModelUpdate>(upd);
     model.e0 = update.e0;
     ++model.orientationDelay;
@@ -91,11 +90,11 @@ void GeneralizedCentrifugalForceModel::ApplyUpdate(
 }
 
 void GeneralizedCentrifugalForceModel::CheckModelConstraint(
-    const GenericAgent& agent,
+    ConstAgentRef agent,
     const NeighborhoodSearchType& neighborhoodSearch,
     const CollisionGeometry& geometry) const
 {
-    const auto& model = std::get<GeneralizedCentrifugalForceModelData>(agent.model);
+    const auto& model = agent.model.As<GeneralizedCentrifugalForceModelData>();
 
     const auto mass = model.mass;
     constexpr double massMin = 1.;
@@ -169,7 +168,7 @@ std::unique_ptr<OperationalModel> GeneralizedCentrifugalForceModel::Clone() cons
 }
 
 Point GeneralizedCentrifugalForceModel::ForceDriv(
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     Point target,
     double mass,
     double tau,
@@ -180,7 +179,7 @@ Point GeneralizedCentrifugalForceModel::ForceDriv(
     const auto pos = ped.pos;
     const auto dest = ped.destination;
     const auto dist = (dest - pos).Norm();
-    const auto& model = std::get<GeneralizedCentrifugalForceModelData>(ped.model);
+    const auto& model = ped.model.As<GeneralizedCentrifugalForceModelData>();
     if(dist > J_EPS_GOAL) {
 
         const Point e0 = mollify_e0(target, pos, deltaT, model.orientationDelay, model.e0);
@@ -194,11 +193,11 @@ Point GeneralizedCentrifugalForceModel::ForceDriv(
 }
 
 Point GeneralizedCentrifugalForceModel::ForceRepPed(
-    const GenericAgent& ped1,
-    const GenericAgent& ped2) const
+    ConstAgentRef ped1,
+    ConstAgentRef ped2) const
 {
-    const auto& model1 = std::get<GeneralizedCentrifugalForceModelData>(ped1.model);
-    const auto& model2 = std::get<GeneralizedCentrifugalForceModelData>(ped2.model);
+    const auto& model1 = ped1.model.As<GeneralizedCentrifugalForceModelData>();
+    const auto& model2 = ped2.model.As<GeneralizedCentrifugalForceModelData>();
     Point F_rep;
     // x- and y-coordinate of the distance between p1 and p2
     Point distp12 = ped2.pos - ped1.pos;
@@ -315,7 +314,7 @@ Point GeneralizedCentrifugalForceModel::ForceRepPed(
  * */
 
 inline Point GeneralizedCentrifugalForceModel::ForceRepRoom(
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     const CollisionGeometry& geometry) const
 {
     const auto& walls = geometry.LineSegmentsInApproxDistanceTo(ped.pos);
@@ -331,7 +330,7 @@ inline Point GeneralizedCentrifugalForceModel::ForceRepRoom(
 }
 
 inline Point
-GeneralizedCentrifugalForceModel::ForceRepWall(const GenericAgent& ped, const LineSegment& w) const
+GeneralizedCentrifugalForceModel::ForceRepWall(ConstAgentRef ped, const LineSegment& w) const
 {
     Point F = Point(0.0, 0.0);
     Point pt = w.ShortestPoint(ped.pos);
@@ -346,7 +345,7 @@ GeneralizedCentrifugalForceModel::ForceRepWall(const GenericAgent& ped, const Li
         return F;
     }
     double mind = 0.5; // for performance reasons this distance is assumed to be constant
-    const auto& model = std::get<GeneralizedCentrifugalForceModelData>(ped.model);
+    const auto& model = ped.model.As<GeneralizedCentrifugalForceModelData>();
     double vn =
         w.NormalComp(ped.orientation * model.speed); // normal component of the velocity on the wall
     F = ForceRepStatPoint(ped, pt, mind, vn);
@@ -365,7 +364,7 @@ GeneralizedCentrifugalForceModel::ForceRepWall(const GenericAgent& ped, const Li
  * */
 // TODO: use effective DistanceToEllipse and simplify this function.
 Point GeneralizedCentrifugalForceModel::ForceRepStatPoint(
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     const Point& p,
     double l,
     double vn) const
@@ -373,7 +372,7 @@ Point GeneralizedCentrifugalForceModel::ForceRepStatPoint(
     Point F_rep = Point(0.0, 0.0);
     // TODO(kkratz): this will fail for speed 0.
     // I think the code can be rewritten to account for orientation and speed separately
-    const auto& model = std::get<GeneralizedCentrifugalForceModelData>(ped.model);
+    const auto& model = ped.model.As<GeneralizedCentrifugalForceModelData>();
     const Point v = ped.orientation * model.speed;
     Point dist = p - ped.pos; // x- and y-coordinate of the distance between ped and p
     double d = dist.Norm(); // distance between the centre of ped and point p
@@ -464,11 +463,11 @@ Point GeneralizedCentrifugalForceModel::ForceInterpolation(
     return F_rep;
 }
 double GeneralizedCentrifugalForceModel::AgentToAgentSpacing(
-    const GenericAgent& agent1,
-    const GenericAgent& agent2) const
+    ConstAgentRef agent1,
+    ConstAgentRef agent2) const
 {
-    const auto& model1 = std::get<GeneralizedCentrifugalForceModelData>(agent1.model);
-    const auto& model2 = std::get<GeneralizedCentrifugalForceModelData>(agent2.model);
+    const auto& model1 = agent1.model.As<GeneralizedCentrifugalForceModelData>();
+    const auto& model2 = agent2.model.As<GeneralizedCentrifugalForceModelData>();
     const Ellipse E1{model1.Av, model1.AMin, model1.BMax, model1.BMin};
     const Ellipse E2{model2.Av, model2.AMin, model2.BMax, model2.BMin};
     const auto v0_1 = model1.v0;
@@ -1,22 +1,23 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
+#include "AgentNeighborhoodSearch.hpp"
+#include "AgentStore.hpp"
 #include "CollisionGeometry.hpp"
 #include "LineSegment.hpp"
-#include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
 #include "Point.hpp"
 
 #include <memory>
 
-struct GenericAgent;
-
 class GeneralizedCentrifugalForceModel : public OperationalModel
 {
 public:
-    using NeighborhoodSearchType = NeighborhoodSearch<GenericAgent>;
+    using NeighborhoodSearchType = AgentNeighborhoodSearch;
 
 private:
+    // TODO (MC) check this free parameter
+    double _cutOffRadius{4};
     double strengthNeighborRepulsion;
     double strengthGeometryRepulsion;
     double maxNeighborInteractionDistance;
@@ -39,14 +40,15 @@ public:
     ~GeneralizedCentrifugalForceModel() override = default;
 
     OperationalModelType Type() const override;
+    double InteractionRange() const override { return _cutOffRadius; }
     OperationalModelUpdate ComputeNewPosition(
         double dT,
-        const GenericAgent& agent,
+        ConstAgentRef agent,
         const CollisionGeometry& geometry,
         const NeighborhoodSearchType& neighborhoodSearch) const override;
-    void ApplyUpdate(const OperationalModelUpdate& upate, GenericAgent& agent) const override;
+    void ApplyUpdate(const OperationalModelUpdate& upate, AgentRef agent) const override;
     void CheckModelConstraint(
-        const GenericAgent& agent,
+        ConstAgentRef agent,
         const NeighborhoodSearchType& neighborhoodSearch,
         const CollisionGeometry& geometry) const override;
     std::unique_ptr<OperationalModel> Clone() const override;
@@ -61,7 +63,7 @@ private:
      * @return Point
      */
     Point ForceDriv(
-        const GenericAgent& ped,
+        ConstAgentRef ped,
         Point target,
         double mass,
         double tau,
@@ -76,7 +78,7 @@ private:
      *
      * @return Point
      */
-    Point ForceRepPed(const GenericAgent& ped1, const GenericAgent& ped2) const;
+    Point ForceRepPed(ConstAgentRef ped1, ConstAgentRef ped2) const;
     /**
      * Repulsive force acting on pedestrian <ped> from the walls in
      * <subroom>. The sum of all repulsive forces of the walls in <subroom> is calculated
@@ -86,9 +88,9 @@ private:
      *
      * @return
      */
-    Point ForceRepRoom(const GenericAgent& ped, const CollisionGeometry& geometry) const;
-    Point ForceRepWall(const GenericAgent& ped, const LineSegment& l) const;
-    Point ForceRepStatPoint(const GenericAgent& ped, const Point& p, double l, double vn) const;
+    Point ForceRepRoom(ConstAgentRef ped, const CollisionGeometry& geometry) const;
+    Point ForceRepWall(ConstAgentRef ped, const LineSegment& l) const;
+    Point ForceRepStatPoint(ConstAgentRef ped, const Point& p, double l, double vn) const;
     Point ForceInterpolation(
         double v0,
         double K_ij,
@@ -97,5 +99,5 @@ private:
         double d,
         double r,
         double l) const;
-    double AgentToAgentSpacing(const GenericAgent& agent, const GenericAgent& otherAgent) const;
+    double AgentToAgentSpacing(ConstAgentRef agent, ConstAgentRef otherAgent) const;
 };
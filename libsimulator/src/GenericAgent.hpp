@@ -4,7 +4,6 @@
 #include "CollisionFreeSpeedModelData.hpp"
 #include "CollisionFreeSpeedModelV2Data.hpp"
 #include "GeneralizedCentrifugalForceModelData.hpp"
-#include "OperationalModel.hpp"
 #include "Point.hpp"
 #include "SocialForceModelData.hpp"
 #include "UniqueID.hpp"
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "GeometricFunctions.hpp"
+
+#include "LineSegment.hpp"
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+PackedLineSegments::PackedLineSegments(const std::vector<LineSegment>& segments)
+{
+    x1.reserve(segments.size());
+    y1.reserve(segments.size());
+    x2.reserve(segments.size());
+    y2.reserve(segments.size());
+    for(const auto& ls : segments) {
+        push_back(ls);
+    }
+}
+
+void PackedLineSegments::push_back(const LineSegment& ls)
+{
+    x1.push_back(ls.p1.x);
+    y1.push_back(ls.p1.y);
+    x2.push_back(ls.p2.x);
+    y2.push_back(ls.p2.y);
+}
+
+// If all four orientations are certain, two line segments intersect exactly if each one has the
+// endpoints of the other one on different sides. Determinants with different signs have the sign
+// bit set in their xor.
+#if defined(__AVX__)
+namespace
+{
+constexpr size_t Lanes = 4;
+
+/// Orientation determinant of 'r' relative to p->q, clears the lanes of 'certain' in which the
+/// sign of the determinant is not certain.
+__m256d orientationDeterminants(
+    __m256d px,
+    __m256d py,
+    __m256d qx,
+    __m256d qy,
+    __m256d rx,
+    __m256d ry,
+    __m256d& certain)
+{
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    const __m256d detLeft = _mm256_mul_pd(_mm256_sub_pd(px, rx), _mm256_sub_pd(qy, ry));
+    const __m256d detRight = _mm256_mul_pd(_mm256_sub_pd(py, ry), _mm256_sub_pd(qx, rx));
+    const __m256d det = _mm256_sub_pd(detLeft, detRight);
+    const __m256d errorBound = _mm256_mul_pd(
+        _mm256_set1_pd(OrientationErrorBound),
+        _mm256_add_pd(_mm256_andnot_pd(signBit, detLeft), _mm256_andnot_pd(signBit, detRight)));
+    certain = _mm256_and_pd(
+        certain, _mm256_cmp_pd(_mm256_andnot_pd(signBit, det), errorBound, _CMP_GT_OQ));
+    return det;
+}
+
+/// Evaluates the filter for 'ls' against the line segments [index, index + Lanes).
+/// @return bit masks of the lanes with a certain result and of the lanes that intersect 'ls'
+std::tuple<int, int>
+filterLanes(const LineSegment& ls, const PackedLineSegments& segments, size_t index)
+{
+    const __m256d ax1 = _mm256_set1_pd(ls.p1.x);
+    const __m256d ay1 = _mm256_set1_pd(ls.p1.y);
+    const __m256d ax2 = _mm256_set1_pd(ls.p2.x);
+    const __m256d ay2 = _mm256_set1_pd(ls.p2.y);
+    const __m256d bx1 = _mm256_loadu_pd(&segments.x1[index]);
+    const __m256d by1 = _mm256_loadu_pd(&segments.y1[index]);
+    const __m256d bx2 = _mm256_loadu_pd(&segments.x2[index]);
+    const __m256d by2 = _mm256_loadu_pd(&segments.y2[index]);
+    __m256d certain = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    const __m256d o1 = orientationDeterminants(ax1, ay1, ax2, ay2, bx1, by1, certain);
+    const __m256d o2 = orientationDeterminants(ax1, ay1, ax2, ay2, bx2, by2, certain);
+    // Most line segments have both endpoints on the same side of 'ls', skip the remaining tests
+    // if this holds for all lanes
+    constexpr int allLanes = (1 << Lanes) - 1;
+    if(_mm256_movemask_pd(_mm256_andnot_pd(_mm256_xor_pd(o1, o2), certain)) == allLanes) {
+        return {allLanes, 0};
+    }
+    const __m256d o3 = orientationDeterminants(bx1, by1, bx2, by2, ax1, ay1, certain);
+    const __m256d o4 = orientationDeterminants(bx1, by1, bx2, by2, ax2, ay2, certain);
+    const __m256d crossing = _mm256_and_pd(_mm256_xor_pd(o1, o2), _mm256_xor_pd(o3, o4));
+    return {_mm256_movemask_pd(certain), _mm256_movemask_pd(crossing)};
+}
+} // namespace
+#elif defined(__SSE2__)
+namespace
+{
+constexpr size_t Lanes = 2;
+
+/// Orientation determinant of 'r' relative to p->q, clears the lanes of 'certain' in which the
+/// sign of the determinant is not certain.
+__m128d orientationDeterminants(
+    __m128d px,
+    __m128d py,
+    __m128d qx,
+    __m128d qy,
+    __m128d rx,
+    __m128d ry,
+    __m128d& certain)
+{
+    const __m128d signBit = _mm_set1_pd(-0.0);
+    const __m128d detLeft = _mm_mul_pd(_mm_sub_pd(px, rx), _mm_sub_pd(qy, ry));
+    const __m128d detRight = _mm_mul_pd(_mm_sub_pd(py, ry), _mm_sub_pd(qx, rx));
+    const __m128d det = _mm_sub_pd(detLeft, detRight);
+    const __m128d errorBound = _mm_mul_pd(
+        _mm_set1_pd(OrientationErrorBound),
+        _mm_add_pd(_mm_andnot_pd(signBit, detLeft), _mm_andnot_pd(signBit, detRight)));
+    certain = _mm_and_pd(certain, _mm_cmpgt_pd(_mm_andnot_pd(signBit, det), errorBound));
+    return det;
+}
+
+/// Evaluates the filter for 'ls' against the line segments [index, index + Lanes).
+/// @return bit masks of the lanes with a certain result and of the lanes that intersect 'ls'
+std::tuple<int, int>
+filterLanes(const LineSegment& ls, const PackedLineSegments& segments, size_t index)
+{
+    const __m128d ax1 = _mm_set1_pd(ls.p1.x);
+    const __m128d ay1 = _mm_set1_pd(ls.p1.y);
+    const __m128d ax2 = _mm_set1_pd(ls.p2.x);
+    const __m128d ay2 = _mm_set1_pd(ls.p2.y);
+    const __m128d bx1 = _mm_loadu_pd(&segments.x1[index]);
+    const __m128d by1 = _mm_loadu_pd(&segments.y1[index]);
+    const __m128d bx2 = _mm_loadu_pd(&segments.x2[index]);
+    const __m128d by2 = _mm_loadu_pd(&segments.y2[index]);
+    __m128d certain = _mm_castsi128_pd(_mm_set1_epi64x(-1));
+    const __m128d o1 = orientationDeterminants(ax1, ay1, ax2, ay2, bx1, by1, certain);
+    const __m128d o2 = orientationDeterminants(ax1, ay1, ax2, ay2, bx2, by2, certain);
+    // Most line segments have both endpoints on the same side of 'ls', skip the remaining tests
+    // if this holds for all lanes
+    constexpr int allLanes = (1 << Lanes) - 1;
+    if(_mm_movemask_pd(_mm_andnot_pd(_mm_xor_pd(o1, o2), certain)) == allLanes) {
+        return {allLanes, 0};
+    }
+    const __m128d o3 = orientationDeterminants(bx1, by1, bx2, by2, ax1, ay1, certain);
+    const __m128d o4 = orientationDeterminants(bx1, by1, bx2, by2, ax2, ay2, certain);
+    const __m128d crossing = _mm_and_pd(_mm_xor_pd(o1, o2), _mm_xor_pd(o3, o4));
+    return {_mm_movemask_pd(certain), _mm_movemask_pd(crossing)};
+}
+} // namespace
+#endif
+
+bool intersectsAny(const LineSegment& ls, const PackedLineSegments& segments)
+{
+    size_t index = 0;
+#if defined(__AVX__) || defined(__SSE2__)
+    for(; index + Lanes <= segments.size(); index += Lanes) {
+        const auto [certainLanes, crossingLanes] = filterLanes(ls, segments, index);
+        if((crossingLanes & certainLanes) != 0) {
+            return true;
+        }
+        // Lanes close to a degenerate configuration are decided by the exact test
+        for(size_t lane = 0; lane < Lanes; ++lane) {
+            if((certainLanes & (1 << lane)) == 0 && intersects(ls, segments[index + lane])) {
+                return true;
+            }
+        }
+    }
+#endif
+    for(; index < segments.size(); ++index) {
+        if(intersects(ls, segments[index])) {
+            return true;
+        }
+    }
+    return false;
+}
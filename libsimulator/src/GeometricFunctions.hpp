@@ -7,6 +7,10 @@
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 #include <CGAL/Intersections_2/Segment_2_Segment_2.h>
 
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
 /// Computes the cross product 2D of vectors apex->a (A) and apex->b (B)
 /// Geometrically the absolute value of the cross product in 2d is also the area of the
 /// parallelogram of A and B. The sign of the cross product determines the relation of A and B.
@@ -79,7 +83,78 @@ inline bool intersectsWithCGAL(const LineSegment l1, const LineSegment l2)
     return CGAL::do_intersect(this_segment, other_segment);
 }
 
+/// Relative error bound of the double precision evaluation of the orientation determinant,
+/// (3 + 16 * eps) * eps with eps = 2^-53, see Shewchuk, "Adaptive Precision Floating-Point
+/// Arithmetic and Fast Robust Geometric Predicates".
+constexpr double OrientationErrorBound{3.3306690738754716e-16};
+
+/// Sign of the orientation of 'c' relative to the line from 'a' to 'b'.
+/// The determinant is evaluated in double precision, only if its magnitude is below the error
+/// bound of that evaluation it is computed exactly. The result is always exact.
+/// @return 1 if 'c' is left of a->b, -1 if 'c' is right of a->b, 0 if all points are collinear
+inline int orientationSign(Point a, Point b, Point c)
+{
+    const double detLeft = (a.x - c.x) * (b.y - c.y);
+    const double detRight = (a.y - c.y) * (b.x - c.x);
+    const double det = detLeft - detRight;
+    const double errorBound = OrientationErrorBound * (std::abs(detLeft) + std::abs(detRight));
+    if(det > errorBound) {
+        return 1;
+    }
+    if(-det > errorBound) {
+        return -1;
+    }
+    using K = CGAL::Exact_predicates_inexact_constructions_kernel;
+    using Point_2 = K::Point_2;
+    return static_cast<int>(
+        CGAL::orientation(Point_2(a.x, a.y), Point_2(b.x, b.y), Point_2(c.x, c.y)));
+}
+
+/// Tests if the closed line segments 'l1' and 'l2' have at least one point in common.
+/// Exact like 'intersectsWithCGAL', but without constructing CGAL objects in the common case.
 inline bool intersects(const LineSegment& l1, const LineSegment& l2)
 {
-    return intersectsWithCGAL(l1, l2);
+    const int o1 = orientationSign(l1.p1, l1.p2, l2.p1);
+    const int o2 = orientationSign(l1.p1, l1.p2, l2.p2);
+    // Both endpoints of 'l2' are strictly on the same side of 'l1'
+    if(o1 == o2 && o1 != 0) {
+        return false;
+    }
+    const int o3 = orientationSign(l2.p1, l2.p2, l1.p1);
+    const int o4 = orientationSign(l2.p1, l2.p2, l1.p2);
+    if(o1 != o2 && o3 != o4) {
+        return true;
+    }
+    // Collinear points only touch the other line segment if they are within its bounds
+    const auto within = [](Point a, Point b, Point c) { return AABB(a, b).Inside(c); };
+    return (o1 == 0 && within(l1.p1, l1.p2, l2.p1)) || (o2 == 0 && within(l1.p1, l1.p2, l2.p2)) ||
+           (o3 == 0 && within(l2.p1, l2.p2, l1.p1)) || (o4 == 0 && within(l2.p1, l2.p2, l1.p2));
 }
+
+/// Line segments stored as structure of arrays, so that a line segment can be tested against
+/// several of them at once, see 'intersectsAny'.
+struct PackedLineSegments {
+    std::vector<double> x1{};
+    std::vector<double> y1{};
+    std::vector<double> x2{};
+    std::vector<double> y2{};
+
+    PackedLineSegments() = default;
+    explicit PackedLineSegments(const std::vector<LineSegment>& segments);
+
+    void push_back(const LineSegment& ls);
+
+    size_t size() const { return x1.size(); }
+    bool empty() const { return x1.empty(); }
+    LineSegment operator[](size_t index) const
+    {
+        return {{x1[index], y1[index]}, {x2[index], y2[index]}};
+    }
+};
+
+/// Tests if 'ls' intersects any of 'segments', with the same result as calling 'intersects' for
+/// each of them.
+/// The filtered orientation tests are evaluated for 4 (AVX) or 2 (SSE2) line segments at once if
+/// the compiler targets these instruction sets. Only line segments for which the filter is not
+/// certain are tested with 'intersects'.
+bool intersectsAny(const LineSegment& ls, const PackedLineSegments& segments);
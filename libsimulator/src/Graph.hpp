@@ -56,32 +56,24 @@ public:
         {
             vertex_data.shrink_to_fit();
 
-            std::sort(std::begin(edges), std::end(edges), [](const auto& a, const auto& b) {
+            std::stable_sort(std::begin(edges), std::end(edges), [](const auto& a, const auto& b) {
                 return std::get<0>(a) < std::get<0>(b);
             });
 
             std::vector<std::tuple<VertexId, E>> adjacency_list{};
             adjacency_list.reserve(edges.size());
 
-            std::vector<EdgeAdjacencyInfo> edge_adjacency_info{};
-            edge_adjacency_info.reserve(vertex_data.size());
-
-            VertexId current_source_id{};
+            // Every vertex gets an entry, including vertices without outgoing edges
+            std::vector<EdgeAdjacencyInfo> edge_adjacency_info(vertex_data.size(), {0, 0});
             for(const auto& [from, to, data] : edges) {
-                if(edge_adjacency_info.empty()) {
-                    current_source_id = from;
-                    edge_adjacency_info.push_back({0, 1});
-
-                } else if(from != current_source_id) {
-                    current_source_id = from;
-                    const auto& last_info = edge_adjacency_info.back();
-                    const auto offset = last_info.offset + last_info.length;
-                    edge_adjacency_info.push_back({offset, 1});
-                } else {
-                    edge_adjacency_info.back().length += 1;
-                }
+                edge_adjacency_info.at(from).length += 1;
                 adjacency_list.push_back(std::make_tuple(to, data));
             }
+            size_t offset = 0;
+            for(auto& info : edge_adjacency_info) {
+                info.offset = offset;
+                offset += info.length;
+            }
 
             return DirectedGraph<V, E>{
                 std::move(vertex_data), std::move(edge_adjacency_info), std::move(adjacency_list)};
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentStore.hpp"
 #include "GenericAgent.hpp"
 #include "Point.hpp"
 #include "SimulationError.hpp"
@@ -181,7 +182,7 @@ public:
 
     ID Id() const { return id; }
 
-    std::tuple<Point, BaseStage::ID> Target(const GenericAgent& agent) const
+    std::tuple<Point, BaseStage::ID> Target(ConstAgentRef agent) const
     {
         auto& node = stages.at(agent.stageId);
         auto stage = node.stage;
@@ -18,6 +18,7 @@
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <queue>
 #include <set>
@@ -248,20 +249,19 @@ void Mesh::smartMerge(bool keep_deadends = true)
         rateMerge(i);
     }
 
-    size_t mergePartner = Polygon::InvalidIndex;
-    size_t firstCommonVertex = Polygon::InvalidIndex;
-
     while(!polygonQueue.empty()) {
         const auto node = polygonQueue.top();
         polygonQueue.pop();
 
-        if(abs(node.area - bestMerge[node.source]) > 1e-8) {
+        if(std::abs(node.area - bestMerge[node.source]) > 1e-8) {
             // Not the right node.
             continue;
         }
 
         const auto& polygon = polygons[node.source];
 
+        size_t mergePartner = Polygon::InvalidIndex;
+        size_t firstCommonVertex = Polygon::InvalidIndex;
         for(size_t i = 0; i < polygon.neighbors.size(); ++i) {
             const auto& neighbor = polygon.neighbors[i];
             if(neighbor == Polygon::InvalidIndex || neighbor == node.source ||
@@ -280,8 +280,10 @@ void Mesh::smartMerge(bool keep_deadends = true)
                 }
             }
         }
-        assert(mergePartner != Polygon::InvalidIndex);
-        assert(firstCommonVertex != Polygon::InvalidIndex);
+        if(mergePartner == Polygon::InvalidIndex) {
+            // The rated merge is no longer possible, the partner has been merged elsewhere.
+            continue;
+        }
 
         auto mergeSuccess = tryMerge(node.source, mergePartner, firstCommonVertex);
         if(!mergeSuccess) {
@@ -292,11 +294,16 @@ void Mesh::smartMerge(bool keep_deadends = true)
         bestMerge[mergePartner] = InvalidArea;
         polygons[mergePartner].neighbors.clear();
         polygons[mergePartner].vertices.clear();
-        for(size_t index = 0; index < polygons.size(); ++index) {
-            auto& polygon = polygons[index];
+        // Only former neighbors of the merge partner refer to it, all of them are neighbors of
+        // the merged polygon now.
+        for(const auto index : polygon.neighbors) {
+            if(index == Polygon::InvalidIndex) {
+                continue;
+            }
+            auto& neighbor = polygons[index];
             std::replace(
-                std::begin(polygon.neighbors),
-                std::end(polygon.neighbors),
+                std::begin(neighbor.neighbors),
+                std::end(neighbor.neighbors),
                 mergePartner,
                 node.source);
         }
@@ -358,6 +365,11 @@ bool Mesh::polygonIsConvex(const std::vector<size_t>& indices) const
             // This indicates CW winding between consecutive segments
             return false;
         }
+        if(cp.z == 0.0 && glm::dot(segment_a, segment_b) < 0.0) {
+            // Consecutive segments run in opposite directions, this happens when merging
+            // polygons that share more than one edge.
+            return false;
+        }
     }
     return true;
 }
@@ -517,32 +529,82 @@ void Mesh::updateBoundingBoxes()
         std::end(polygons),
         std::back_inserter(boundingBoxes),
         [this](const auto& polygon) {
-            float xMin = std::numeric_limits<float>::max();
-            float xMax = std::numeric_limits<float>::lowest();
-            float yMin = std::numeric_limits<float>::max();
-            float yMax = std::numeric_limits<float>::lowest();
+            double xMin = std::numeric_limits<double>::max();
+            double xMax = std::numeric_limits<double>::lowest();
+            double yMin = std::numeric_limits<double>::max();
+            double yMax = std::numeric_limits<double>::lowest();
 
             for(const auto& pIndex : polygon.vertices) {
                 const auto& p = vertices[pIndex];
-                xMin = std::min(xMin, static_cast<float>(p.x));
-                xMax = std::max(xMax, static_cast<float>(p.x));
-                yMin = std::min(yMin, static_cast<float>(p.y));
-                yMax = std::max(yMax, static_cast<float>(p.y));
+                xMin = std::min(xMin, p.x);
+                xMax = std::max(xMax, p.x);
+                yMin = std::min(yMin, p.y);
+                yMax = std::max(yMax, p.y);
             }
 
             return AABB{{xMin, yMin}, {xMax, yMax}};
         });
+    updatePolygonGrid();
 }
 
-size_t Mesh::FindContainingPolygon(const glm::dvec2& p) const
+void Mesh::updatePolygonGrid()
 {
-    for(size_t index = 0; index < polygons.size(); ++index) {
-        if(boundingBoxes[index].Inside({p.x, p.y}) && TriangleContains(index, p)) {
-            return index;
-        }
+    grid = PolygonGrid{};
+    if(polygons.empty()) {
+        return;
     }
 
-    return Polygon::InvalidIndex;
+    AABB bounds{};
+    for(const auto& box : boundingBoxes) {
+        bounds.xmin = std::min(bounds.xmin, box.xmin);
+        bounds.xmax = std::max(bounds.xmax, box.xmax);
+        bounds.ymin = std::min(bounds.ymin, box.ymin);
+        bounds.ymax = std::max(bounds.ymax, box.ymax);
+    }
+    const auto width = bounds.xmax - bounds.xmin;
+    const auto height = bounds.ymax - bounds.ymin;
+
+    // Aim for about one polygon per cell
+    const auto cellSize = std::sqrt(width * height / static_cast<double>(polygons.size()));
+    grid.cellSize = cellSize > 0 ? cellSize : std::max({width, height, 1.0});
+    grid.origin = {bounds.xmin, bounds.ymin};
+    grid.columns = static_cast<size_t>(width / grid.cellSize) + 1;
+    grid.rows = static_cast<size_t>(height / grid.cellSize) + 1;
+
+    const auto cellRange = [this](const AABB& box) {
+        const auto column = [this](double x) {
+            return std::min(
+                static_cast<size_t>((x - grid.origin.x) / grid.cellSize), grid.columns - 1);
+        };
+        const auto row = [this](double y) {
+            return std::min(
+                static_cast<size_t>((y - grid.origin.y) / grid.cellSize), grid.rows - 1);
+        };
+        return std::make_tuple(column(box.xmin), column(box.xmax), row(box.ymin), row(box.ymax));
+    };
+
+    // Count the polygons per cell first, then fill the cells in a second pass
+    grid.cellStarts.assign(grid.columns * grid.rows + 1, 0);
+    for(const auto& box : boundingBoxes) {
+        const auto [columnMin, columnMax, rowMin, rowMax] = cellRange(box);
+        for(auto row = rowMin; row <= rowMax; ++row) {
+            for(auto column = columnMin; column <= columnMax; ++column) {
+                ++grid.cellStarts[row * grid.columns + column + 1];
+            }
+        }
+    }
+    std::partial_sum(
+        std::begin(grid.cellStarts), std::end(grid.cellStarts), std::begin(grid.cellStarts));
+    grid.polygons.resize(grid.cellStarts.back());
+    auto fill = grid.cellStarts;
+    for(size_t index = 0; index < boundingBoxes.size(); ++index) {
+        const auto [columnMin, columnMax, rowMin, rowMax] = cellRange(boundingBoxes[index]);
+        for(auto row = rowMin; row <= rowMax; ++row) {
+            for(auto column = columnMin; column <= columnMax; ++column) {
+                grid.polygons[fill[row * grid.columns + column]++] = index;
+            }
+        }
+    }
 }
 
 glm::dvec2 Mesh::Vertex(size_t index) const
@@ -682,3 +744,63 @@ bool Mesh::TriangleContains(const size_t polygonIndex, glm::dvec2 p) const
     }
     return true;
 }
+
+size_t Mesh::FindContainingPolygon(const glm::dvec2& p, size_t hint) const
+{
+    // Most queries are close to the hint, walking there is cheaper than looking up the grid. The
+    // walk may circle on meshes that are not Delaunay, hence the number of steps is limited.
+    constexpr size_t maxWalkSteps{16};
+    auto current = hint;
+    for(size_t step = 0; step < maxWalkSteps && current < polygons.size(); ++step) {
+        const auto next = walkTowards(current, p);
+        if(next == current) {
+            return current;
+        }
+        current = next;
+    }
+
+    if(grid.cellStarts.empty()) {
+        return Polygon::InvalidIndex;
+    }
+    const auto column = std::floor((p.x - grid.origin.x) / grid.cellSize);
+    const auto row = std::floor((p.y - grid.origin.y) / grid.cellSize);
+    if(!(column >= 0 && row >= 0 && column < grid.columns && row < grid.rows)) {
+        return Polygon::InvalidIndex;
+    }
+    const auto cell = static_cast<size_t>(row) * grid.columns + static_cast<size_t>(column);
+    for(auto index = grid.cellStarts[cell]; index < grid.cellStarts[cell + 1]; ++index) {
+        const auto polygon = grid.polygons[index];
+        if(boundingBoxes[polygon].Inside({p.x, p.y}) && PolygonContains(polygon, p)) {
+            return polygon;
+        }
+    }
+    return Polygon::InvalidIndex;
+}
+
+size_t Mesh::walkTowards(size_t polygonIndex, glm::dvec2 p) const
+{
+    const auto& poly = polygons[polygonIndex];
+    const auto count = poly.vertices.size();
+    for(size_t index = 0; index < count; ++index) {
+        const auto a = vertices[poly.vertices[index]];
+        const auto b = vertices[poly.vertices[(index + 1) % count]];
+        if(cross2D(p - a, b - a) < 0) {
+            return poly.neighbors[index];
+        }
+    }
+    return polygonIndex;
+}
+
+bool Mesh::PolygonContains(const size_t polygonIndex, glm::dvec2 p) const
+{
+    const auto& poly = polygons[polygonIndex];
+    const auto count = poly.vertices.size();
+    for(size_t index = 0; index < count; ++index) {
+        const auto a = vertices[poly.vertices[index]];
+        const auto b = vertices[poly.vertices[(index + 1) % count]];
+        if(cross2D(p - a, b - a) < 0) {
+            return false;
+        }
+    }
+    return count > 0;
+}
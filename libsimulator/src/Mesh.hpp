@@ -35,6 +35,19 @@ private:
     std::vector<Polygon> polygons{};
     std::vector<AABB> boundingBoxes{};
 
+    /// Uniform grid over the bounding boxes of all polygons for point location.
+    struct PolygonGrid {
+        glm::dvec2 origin{};
+        double cellSize{1.0};
+        size_t columns{};
+        size_t rows{};
+        /// Polygons overlapping cell 'i' are stored in 'polygons' from 'cellStarts[i]' up to
+        /// 'cellStarts[i + 1]'.
+        std::vector<size_t> cellStarts{};
+        std::vector<size_t> polygons{};
+    };
+    PolygonGrid grid{};
+
 public:
     explicit Mesh(const CDT& cdt);
     ~Mesh() override = default;
@@ -47,7 +60,11 @@ public:
     std::vector<glm::vec2> FVertices() const;
     std::vector<uint16_t> TriangleIndices() const;
     std::vector<uint16_t> SegmentIndices() const;
-    size_t FindContainingPolygon(const glm::dvec2& p) const;
+    /// Finds the polygon containing 'p'.
+    /// @param hint polygon to start from, e.g. the result of a previous query close to 'p'. Points
+    /// near the hint are found by walking across the neighboring polygons.
+    /// @return Polygon::InvalidIndex if 'p' is outside of all polygons.
+    size_t FindContainingPolygon(const glm::dvec2& p, size_t hint = InvalidIndex) const;
     glm::dvec2 Vertex(size_t index) const;
     size_t CountVertices() const { return vertices.size(); }
     size_t CountPolygons() const { return polygons.size(); }
@@ -55,6 +72,8 @@ public:
     const Mesh::Polygon& Polygons(size_t index) const { return polygons.at(index); }
     const AABB& AxisAlignedBoundingBox(size_t index) const { return boundingBoxes.at(index); }
     bool TriangleContains(const size_t, glm::dvec2 p) const;
+    /// Tests if 'p' is inside or on the boundary of the convex polygon at 'polygonIndex'.
+    bool PolygonContains(const size_t polygonIndex, glm::dvec2 p) const;
 
 private:
     void mergeDeadEnds();
@@ -69,4 +88,8 @@ private:
     double polygonArea(const std::vector<size_t> indices) const;
     void trimEmptyPolygons();
     void updateBoundingBoxes();
+    void updatePolygonGrid();
+    /// Next polygon on the way from 'polygonIndex' towards 'p', 'polygonIndex' itself if it
+    /// contains 'p'.
+    size_t walkTowards(size_t polygonIndex, glm::dvec2 p) const;
 };
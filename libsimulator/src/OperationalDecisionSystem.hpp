@@ -1,17 +1,14 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentNeighborhoodSearch.hpp"
+#include "AgentStore.hpp"
 #include "CollisionGeometry.hpp"
-#include "GenericAgent.hpp"
-#include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
+#include "WorkerPool.hpp"
 
-#include <boost/iterator/zip_iterator.hpp>
-#include <boost/tuple/tuple.hpp>
-
-#include <algorithm>
-#include <iterator>
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -32,39 +29,41 @@ public:
     OperationalDecisionSystem& operator=(OperationalDecisionSystem&& other) = delete;
 
     OperationalModelType ModelType() const { return _model->Type(); }
+    double InteractionRange() const { return _model->InteractionRange(); }
 
+    /// Computes and applies the operational update of all agents.
+    ///
+    /// Computing the updates only reads the simulation state and is distributed on 'pool', the
+    /// updates are then applied in agent order on the calling thread. The outcome is therefore
+    /// independent of the number of threads in 'pool'.
     void
     Run(double dT,
-        double /*t_in_sec*/,
-        const NeighborhoodSearch<GenericAgent>& neighborhoodSearch,
+        double t_in_sec,
+        const AgentNeighborhoodSearch& neighborhoodSearch,
         const CollisionGeometry& geometry,
-        std::vector<GenericAgent>& agents) const
+        AgentStore& agents,
+        WorkerPool& pool)
     {
-        std::vector<std::optional<OperationalModelUpdate>> updates{};
-        updates.reserve(agents.size());
+        _model->BeginIteration(t_in_sec);
+        std::vector<std::optional<OperationalModelUpdate>> updates(agents.size());
 
-        std::transform(
-            std::begin(agents),
-            std::end(agents),
-            std::back_inserter(updates),
-            [this, &dT, &geometry, &neighborhoodSearch](const auto& agent) {
-                return _model->ComputeNewPosition(dT, agent, geometry, neighborhoodSearch);
-            });
+        pool.ParallelFor(agents.size(), [&](size_t begin, size_t end) {
+            for(auto index = begin; index < end; ++index) {
+                updates[index] = _model->ComputeNewPosition(
+                    dT, std::as_const(agents)[index], geometry, neighborhoodSearch);
+            }
+        });
 
-        std::for_each(
-            boost::make_zip_iterator(boost::make_tuple(std::begin(agents), std::begin(updates))),
-            boost::make_zip_iterator(boost::make_tuple(std::end(agents), std::end(updates))),
-            [this](auto tup) {
-                auto& [agent, update] = tup;
-                if(update) {
-                    _model->ApplyUpdate(*update, agent);
-                }
-            });
+        for(size_t index = 0; index < agents.size(); ++index) {
+            if(updates[index]) {
+                _model->ApplyUpdate(*updates[index], agents[index]);
+            }
+        }
     }
 
     void ValidateAgent(
-        const GenericAgent& agent,
-        const NeighborhoodSearch<GenericAgent>& neighborhoodSearch,
+        ConstAgentRef agent,
+        const AgentNeighborhoodSearch& neighborhoodSearch,
         const CollisionGeometry& geometry) const
     {
         _model->CheckModelConstraint(agent, neighborhoodSearch, geometry);
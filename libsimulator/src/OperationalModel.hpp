@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentStore.hpp"
 #include "Clonable.hpp"
 #include "CollisionGeometry.hpp"
 #include "OperationalModelType.hpp"
@@ -13,10 +14,7 @@
 #include <optional>
 #include <string>
 
-template <typename T>
-class NeighborhoodSearch;
-
-struct GenericAgent;
+class AgentNeighborhoodSearch;
 
 struct PedestrianUpdate {
     std::optional<Point> position{};
@@ -83,15 +81,21 @@ public:
     virtual ~OperationalModel() = default;
 
     virtual OperationalModelType Type() const = 0;
+    /// Radius in which 'ComputeNewPosition' takes neighboring agents into account. The cell size
+    /// of the neighborhood search is derived from it.
+    virtual double InteractionRange() const = 0;
+    /// Called once per iteration before 'ComputeNewPosition' is called for any agent.
+    /// @param t_in_sec simulated time at the beginning of the iteration
+    virtual void BeginIteration(double /*t_in_sec*/) {}
     virtual OperationalModelUpdate ComputeNewPosition(
         double dT,
-        const GenericAgent& ped,
+        ConstAgentRef ped,
         const CollisionGeometry& geometry,
-        const NeighborhoodSearch<GenericAgent>& neighborhoodSearch) const = 0;
+        const AgentNeighborhoodSearch& neighborhoodSearch) const = 0;
 
-    virtual void ApplyUpdate(const OperationalModelUpdate& update, GenericAgent& agent) const = 0;
+    virtual void ApplyUpdate(const OperationalModelUpdate& update, AgentRef agent) const = 0;
     virtual void CheckModelConstraint(
-        const GenericAgent& agent,
-        const NeighborhoodSearch<GenericAgent>& neighborhoodSearch,
+        ConstAgentRef agent,
+        const AgentNeighborhoodSearch& neighborhoodSearch,
         const CollisionGeometry& geometry) const = 0;
 };
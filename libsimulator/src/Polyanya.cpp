@@ -0,0 +1,505 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "Polyanya.hpp"
+
+#include "Mesh.hpp"
+#include "Point.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace
+{
+/// Tolerance in meter below which points are considered to be on a line.
+constexpr double epsilon = 1e-8;
+
+/// An interval on a polygon edge seen from 'root'.
+///
+/// Looking from 'root' through the interval into 'polygon', 'left' is the left and 'right' is the
+/// right end of the interval.
+struct SearchNode {
+    Point root{};
+    /// Mesh vertex at 'root', Mesh::InvalidIndex for the start of the search.
+    size_t rootVertex{Mesh::InvalidIndex};
+    Point left{};
+    Point right{};
+    /// Mesh vertex at 'left' if the interval ends at a vertex, Mesh::InvalidIndex otherwise.
+    size_t leftVertex{Mesh::InvalidIndex};
+    /// Mesh vertex at 'right' if the interval ends at a vertex, Mesh::InvalidIndex otherwise.
+    size_t rightVertex{Mesh::InvalidIndex};
+    /// Polygon entered through the interval, Mesh::InvalidIndex for nodes ending in the target.
+    size_t polygon{Mesh::InvalidIndex};
+    /// Edge of 'polygon' the interval lies on.
+    size_t edge{Mesh::InvalidIndex};
+    /// Length of the path from the start to 'root'.
+    double g_value{};
+    double f_value{};
+    /// Node this node has been generated from.
+    size_t parent{Mesh::InvalidIndex};
+};
+
+/// Memory used during a single path search.
+///
+/// Each thread owns one instance which is reused for all searches of this thread. Search nodes
+/// are allocated from a growing vector that is cleared between searches. The shortest known
+/// distance to each vertex used as a root is stored densely by vertex index and invalidated in
+/// constant time by incrementing the generation.
+class SearchArena
+{
+    std::vector<std::pair<double, size_t>> heap{};
+    std::vector<double> rootDistances{};
+    std::vector<uint32_t> rootGenerations{};
+    uint32_t generation{};
+
+public:
+    std::vector<SearchNode> nodes{};
+
+    void Reset(size_t vertexCount)
+    {
+        nodes.clear();
+        heap.clear();
+        if(rootDistances.size() < vertexCount) {
+            rootDistances.resize(vertexCount);
+            rootGenerations.resize(vertexCount);
+        }
+        if(++generation == 0) {
+            // Wrapped around, stale data could be mistaken for current data
+            std::fill(std::begin(rootGenerations), std::end(rootGenerations), 0);
+            generation = 1;
+        }
+    }
+
+    /// Root level pruning: A path turning at 'vertex' is only worth following if no shorter path
+    /// to 'vertex' is known.
+    bool Improves(size_t vertex, double g_value)
+    {
+        if(vertex == Mesh::InvalidIndex) {
+            return true;
+        }
+        if(rootGenerations[vertex] != generation || g_value < rootDistances[vertex]) {
+            rootGenerations[vertex] = generation;
+            rootDistances[vertex] = g_value;
+            return true;
+        }
+        return g_value <= rootDistances[vertex] + epsilon;
+    }
+
+    bool IsStale(const SearchNode& node) const
+    {
+        return node.rootVertex != Mesh::InvalidIndex &&
+               node.g_value > rootDistances[node.rootVertex] + epsilon;
+    }
+
+    void Push(const SearchNode& node)
+    {
+        nodes.push_back(node);
+        heap.emplace_back(node.f_value, nodes.size() - 1);
+        std::push_heap(std::begin(heap), std::end(heap), std::greater<>{});
+    }
+
+    bool Empty() const { return heap.empty(); }
+
+    size_t PopMin()
+    {
+        std::pop_heap(std::begin(heap), std::end(heap), std::greater<>{});
+        const auto index = heap.back().second;
+        heap.pop_back();
+        return index;
+    }
+
+    static SearchArena& ForThisThread()
+    {
+        thread_local SearchArena arena{};
+        return arena;
+    }
+};
+
+/// Parameter range [lo, hi] of an edge.
+struct Range {
+    double lo{};
+    double hi{};
+
+    bool IsEmpty() const { return hi <= lo; }
+    Range Intersect(const Range& other) const
+    {
+        return {std::max(lo, other.lo), std::min(hi, other.hi)};
+    }
+};
+
+/// Range of the edge from 'a' to 'b' on which the linear interpolation of the signed distances
+/// 'sa' and 'sb' is not negative.
+Range nonNegativeRange(double sa, double sb)
+{
+    sa = std::abs(sa) <= epsilon ? 0.0 : sa;
+    sb = std::abs(sb) <= epsilon ? 0.0 : sb;
+    if(sa >= 0 && sb >= 0) {
+        return {0.0, 1.0};
+    }
+    if(sa < 0 && sb < 0) {
+        return {1.0, 0.0};
+    }
+    const auto t = sa / (sa - sb);
+    return sa >= 0 ? Range{0.0, t} : Range{t, 1.0};
+}
+
+/// Signed distance of 'p' to the line through 'origin' in 'direction', positive on the left.
+double signedDistance(Point origin, Point direction, Point p)
+{
+    return direction.CrossProduct(p - origin) / direction.Norm();
+}
+
+/// Lower bound for the length of a path from 'root' through the interval ['left', 'right'] to
+/// 'target'.
+double heuristic(Point root, Point left, Point right, Point target)
+{
+    const auto direction = right - left;
+    if(direction.isZeroLength()) {
+        return Distance(root, left) + Distance(left, target);
+    }
+    const auto rootSide = signedDistance(left, direction, root);
+    if(std::abs(rootSide) <= epsilon) {
+        return Distance(root, target);
+    }
+    const auto targetSide = signedDistance(left, direction, target);
+    if(rootSide * targetSide > 0) {
+        // Target is on the same side as the root, the path has to come back through the interval
+        target = target - direction.Rotate90Deg() * (2 * targetSide / direction.Norm());
+    }
+    const auto toTarget = target - root;
+    if(toTarget.CrossProduct(left - root) * toTarget.CrossProduct(right - root) <= 0) {
+        return Distance(root, target);
+    }
+    return std::min(
+        Distance(root, left) + Distance(left, target),
+        Distance(root, right) + Distance(right, target));
+}
+
+/// A single path query.
+class Search
+{
+    const Mesh& mesh;
+    const std::vector<std::vector<size_t>>& twinEdges;
+    const std::vector<bool>& corners;
+    SearchArena& arena;
+    Point target;
+    size_t targetPolygon;
+
+public:
+    Search(
+        const Mesh& mesh,
+        const std::vector<std::vector<size_t>>& twinEdges,
+        const std::vector<bool>& corners,
+        SearchArena& arena,
+        Point target,
+        size_t targetPolygon)
+        : mesh(mesh)
+        , twinEdges(twinEdges)
+        , corners(corners)
+        , arena(arena)
+        , target(target)
+        , targetPolygon(targetPolygon)
+    {
+    }
+
+    /// Pushes the node for the range [lo, hi] of edge 'edge' of 'polygon' seen from 'root' into
+    /// the polygon on the other side of the edge.
+    void PushInterval(
+        size_t parent,
+        Point root,
+        size_t rootVertex,
+        double g_value,
+        size_t polygon,
+        size_t edge,
+        Range range)
+    {
+        const auto twin = twinEdges[polygon][edge];
+        if(twin == Mesh::InvalidIndex) {
+            // Boundary of the walkable area
+            return;
+        }
+        const auto& vertices = mesh.Polygons(polygon).vertices;
+        const auto vertexA = vertices[edge];
+        const auto vertexB = vertices[(edge + 1) % vertices.size()];
+        const Point a{mesh.Vertex(vertexA).x, mesh.Vertex(vertexA).y};
+        const Point b{mesh.Vertex(vertexB).x, mesh.Vertex(vertexB).y};
+
+        auto lo = range.lo < epsilon ? 0.0 : range.lo;
+        auto hi = range.hi > 1.0 - epsilon ? 1.0 : range.hi;
+        if(hi <= lo) {
+            return;
+        }
+
+        if(std::abs(signedDistance(a, b - a, root)) <= epsilon) {
+            // The root is on the line of this edge and sees nothing but the edge itself.
+            const auto alongEdge = (root - a).ScalarProduct(b - a);
+            if(alongEdge >= 0 && alongEdge <= (b - a).NormSquare()) {
+                // A root at a corner of this edge sees the whole polygon on the other side,
+                // other roots on this edge are contained in that polygon as well.
+                const bool atA = rootVertex == vertexA && lo == 0.0;
+                const bool atB = rootVertex == vertexB && hi == 1.0;
+                if(!atA && !atB) {
+                    return;
+                }
+            } else {
+                // A path grazing along the edge can only continue by turning around the end of
+                // the edge closest to the root.
+                const bool nearA = alongEdge < 0;
+                const auto vertex = nearA ? vertexA : vertexB;
+                if(!corners[vertex] || (nearA ? lo != 0.0 : hi != 1.0)) {
+                    return;
+                }
+                lo = nearA ? 0.0 : 1.0;
+                hi = lo;
+            }
+        }
+
+        if(!arena.Improves(rootVertex, g_value)) {
+            return;
+        }
+
+        SearchNode node{};
+        node.root = root;
+        node.rootVertex = rootVertex;
+        node.right = lo == 0.0 ? a : (lo == 1.0 ? b : a + (b - a) * lo);
+        node.rightVertex = lo == 0.0 ? vertexA : (lo == 1.0 ? vertexB : Mesh::InvalidIndex);
+        node.left = hi == 1.0 ? b : (hi == 0.0 ? a : a + (b - a) * hi);
+        node.leftVertex = hi == 1.0 ? vertexB : (hi == 0.0 ? vertexA : Mesh::InvalidIndex);
+        node.polygon = mesh.Polygons(polygon).neighbors[edge];
+        node.edge = twin;
+        node.g_value = g_value;
+        node.f_value = g_value + heuristic(root, node.left, node.right, target);
+        node.parent = parent;
+        arena.Push(node);
+    }
+
+    void Expand(size_t index)
+    {
+        const auto node = arena.nodes[index];
+        const auto& vertices = mesh.Polygons(node.polygon).vertices;
+        const auto count = vertices.size();
+        const auto vertexAt = [this, &vertices, count](size_t position) {
+            const auto v = mesh.Vertex(vertices[position % count]);
+            return Point{v.x, v.y};
+        };
+
+        const bool rootOnEntryEdge =
+            node.rootVertex != Mesh::InvalidIndex &&
+            (node.rootVertex == vertices[node.edge] ||
+             node.rootVertex == vertices[(node.edge + 1) % count]);
+
+        if(node.polygon == targetPolygon) {
+            pushTarget(index, node, rootOnEntryEdge);
+        }
+
+        if(rootOnEntryEdge) {
+            // The root is a corner of this polygon, all of the polygon is visible.
+            for(size_t offset = 1; offset < count; ++offset) {
+                PushInterval(
+                    index,
+                    node.root,
+                    node.rootVertex,
+                    node.g_value,
+                    node.polygon,
+                    (node.edge + offset) % count,
+                    {0.0, 1.0});
+            }
+            return;
+        }
+
+        // The remaining edges are ordered from the right to the left end of the interval. Parts
+        // of them between the rays from the root through both ends of the interval are observable
+        // from the root. Parts outside of these rays can only be reached by turning around an end
+        // of the interval, which is only possible if this end is a corner.
+        const auto rightRay = node.right - node.root;
+        const auto leftRay = node.left - node.root;
+        const bool turnRight =
+            node.rightVertex != Mesh::InvalidIndex && corners[node.rightVertex];
+        const bool turnLeft = node.leftVertex != Mesh::InvalidIndex && corners[node.leftVertex];
+        const auto rightG = node.g_value + Distance(node.root, node.right);
+        const auto leftG = node.g_value + Distance(node.root, node.left);
+
+        for(size_t offset = 1; offset < count; ++offset) {
+            const auto edge = (node.edge + offset) % count;
+            const auto a = vertexAt(edge);
+            const auto b = vertexAt(edge + 1);
+            const auto aRight = signedDistance(node.root, rightRay, a);
+            const auto bRight = signedDistance(node.root, rightRay, b);
+            const auto aLeft = signedDistance(node.root, leftRay, a);
+            const auto bLeft = signedDistance(node.root, leftRay, b);
+
+            const auto observable =
+                nonNegativeRange(aRight, bRight).Intersect(nonNegativeRange(-aLeft, -bLeft));
+            if(!observable.IsEmpty()) {
+                PushInterval(
+                    index,
+                    node.root,
+                    node.rootVertex,
+                    node.g_value,
+                    node.polygon,
+                    edge,
+                    observable);
+            }
+            if(turnRight) {
+                PushInterval(
+                    index,
+                    node.right,
+                    node.rightVertex,
+                    rightG,
+                    node.polygon,
+                    edge,
+                    nonNegativeRange(-aRight, -bRight));
+            }
+            if(turnLeft) {
+                PushInterval(
+                    index,
+                    node.left,
+                    node.leftVertex,
+                    leftG,
+                    node.polygon,
+                    edge,
+                    nonNegativeRange(aLeft, bLeft));
+            }
+        }
+    }
+
+private:
+    /// Pushes the node completing the path to the target, the target is inside 'node.polygon'.
+    void pushTarget(size_t index, const SearchNode& node, bool rootOnEntryEdge)
+    {
+        SearchNode last = node;
+        last.polygon = Mesh::InvalidIndex;
+        last.parent = index;
+        last.left = target;
+        last.right = target;
+
+        const auto rightSide =
+            rootOnEntryEdge ? 0.0 : signedDistance(node.root, node.right - node.root, target);
+        const auto leftSide =
+            rootOnEntryEdge ? 0.0 : signedDistance(node.root, node.left - node.root, target);
+        if(rightSide >= -epsilon && leftSide <= epsilon) {
+            last.g_value = node.g_value + Distance(node.root, target);
+        } else if(rightSide < 0 && node.rightVertex != Mesh::InvalidIndex) {
+            last.root = node.right;
+            last.rootVertex = node.rightVertex;
+            last.g_value =
+                node.g_value + Distance(node.root, node.right) + Distance(node.right, target);
+        } else if(leftSide > 0 && node.leftVertex != Mesh::InvalidIndex) {
+            last.root = node.left;
+            last.rootVertex = node.leftVertex;
+            last.g_value =
+                node.g_value + Distance(node.root, node.left) + Distance(node.left, target);
+        } else {
+            // The target can only be reached by turning in free space, another node will
+            // provide the shorter path.
+            return;
+        }
+        last.f_value = last.g_value;
+        arena.Push(last);
+    }
+};
+} // namespace
+
+Polyanya::Polyanya(Mesh mesh_) : mesh(std::move(mesh_))
+{
+    const auto polygonCount = mesh.CountPolygons();
+    twinEdges.resize(polygonCount);
+    corners.assign(mesh.CountVertices(), false);
+    for(size_t index = 0; index < polygonCount; ++index) {
+        const auto& polygon = mesh.Polygons(index);
+        const auto count = polygon.vertices.size();
+        twinEdges[index].assign(count, Mesh::InvalidIndex);
+        for(size_t edge = 0; edge < count; ++edge) {
+            const auto from = polygon.vertices[edge];
+            const auto to = polygon.vertices[(edge + 1) % count];
+            const auto neighbor = polygon.neighbors[edge];
+            if(neighbor != Mesh::Polygon::InvalidIndex && neighbor != index) {
+                const auto& other = mesh.Polygons(neighbor).vertices;
+                for(size_t otherEdge = 0; otherEdge < other.size(); ++otherEdge) {
+                    if(other[otherEdge] == to && other[(otherEdge + 1) % other.size()] == from) {
+                        twinEdges[index][edge] = otherEdge;
+                        break;
+                    }
+                }
+            }
+            if(twinEdges[index][edge] == Mesh::InvalidIndex) {
+                corners[from] = true;
+                corners[to] = true;
+            }
+        }
+    }
+}
+
+std::vector<Point> Polyanya::ComputeWaypoints(Point from, Point to) const
+{
+    const auto startPolygon = mesh.FindContainingPolygon({from.x, from.y});
+    const auto targetPolygon = mesh.FindContainingPolygon({to.x, to.y});
+    if(startPolygon == Mesh::InvalidIndex || targetPolygon == Mesh::InvalidIndex) {
+        return {};
+    }
+
+    // A start on an edge or vertex is contained in all polygons adjacent to it. Intervals seen
+    // from a start closer to an edge than 'epsilon' are dropped, the search starts from the
+    // polygon on the other side of such an edge as well.
+    std::vector<size_t> startPolygons{startPolygon};
+    for(size_t index = 0; index < startPolygons.size(); ++index) {
+        if(startPolygons[index] == targetPolygon) {
+            return {from, to};
+        }
+        const auto& polygon = mesh.Polygons(startPolygons[index]);
+        const auto count = polygon.vertices.size();
+        for(size_t edge = 0; edge < count; ++edge) {
+            const auto neighbor = polygon.neighbors[edge];
+            if(neighbor == Mesh::Polygon::InvalidIndex ||
+               std::find(std::begin(startPolygons), std::end(startPolygons), neighbor) !=
+                   std::end(startPolygons)) {
+                continue;
+            }
+            const auto a = mesh.Vertex(polygon.vertices[edge]);
+            const auto b = mesh.Vertex(polygon.vertices[(edge + 1) % count]);
+            const auto onEdge =
+                std::abs(signedDistance({a.x, a.y}, {b.x - a.x, b.y - a.y}, from)) <= epsilon;
+            if(onEdge || mesh.PolygonContains(neighbor, {from.x, from.y})) {
+                startPolygons.push_back(neighbor);
+            }
+        }
+    }
+
+    auto& arena = SearchArena::ForThisThread();
+    arena.Reset(mesh.CountVertices());
+    Search search{mesh, twinEdges, corners, arena, to, targetPolygon};
+    for(const auto polygon : startPolygons) {
+        for(size_t edge = 0; edge < mesh.Polygons(polygon).vertices.size(); ++edge) {
+            search.PushInterval(
+                Mesh::InvalidIndex, from, Mesh::InvalidIndex, 0.0, polygon, edge, {0.0, 1.0});
+        }
+    }
+
+    while(!arena.Empty()) {
+        const auto index = arena.PopMin();
+        const auto& node = arena.nodes[index];
+        if(node.polygon == Mesh::InvalidIndex) {
+            // Collect the turning points, consecutive nodes share their root until the path turns
+            std::vector<Point> path{to};
+            size_t lastRootVertex = Mesh::InvalidIndex - 1;
+            for(auto current = index; current != Mesh::InvalidIndex;
+                current = arena.nodes[current].parent) {
+                const auto& step = arena.nodes[current];
+                if(step.rootVertex != lastRootVertex) {
+                    path.push_back(step.root);
+                    lastRootVertex = step.rootVertex;
+                }
+            }
+            std::reverse(std::begin(path), std::end(path));
+            return path;
+        }
+        if(arena.IsStale(node)) {
+            continue;
+        }
+        search.Expand(index);
+    }
+    return {};
+}
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "Mesh.hpp"
+#include "Point.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/// Optimal any-angle path search on a navigation mesh of convex polygons.
+///
+/// Implements Polyanya as described in "Compromise-free Pathfinding on a Navigation Mesh"
+/// (Cui, Harabor, Grastien; IJCAI 2017). Search nodes are intervals on polygon edges together
+/// with the last turning point (root) of the path leading to the interval. Because the search
+/// works on whole polygons instead of triangles and never needs to straighten a corridor
+/// afterwards, the paths found are the true Euclidean shortest paths and considerably fewer nodes
+/// are expanded than with a search on the triangulation.
+///
+/// The mesh is expected to consist of convex polygons in CCW orientation, e.g. a Mesh after
+/// 'MergeGreedy'.
+///
+/// Thread Safety: Path queries may be issued concurrently from multiple threads.
+class Polyanya
+{
+    Mesh mesh;
+    /// For each edge 'k' of each polygon the index of the same edge in 'neighbors[k]',
+    /// Mesh::InvalidIndex for edges on the boundary of the walkable area.
+    std::vector<std::vector<size_t>> twinEdges{};
+    /// Vertices on the boundary of the walkable area, only these can be turning points of a path.
+    std::vector<bool> corners{};
+
+public:
+    explicit Polyanya(Mesh mesh);
+    ~Polyanya() = default;
+    Polyanya(const Polyanya& other) = default;
+    Polyanya& operator=(const Polyanya& other) = default;
+    Polyanya(Polyanya&& other) = default;
+    Polyanya& operator=(Polyanya&& other) = default;
+
+    /// Computes the shortest path from 'from' to 'to'.
+    /// @return 'from', all turning points and 'to'. Empty if either point is outside of the mesh
+    /// or 'to' is not reachable from 'from'.
+    std::vector<Point> ComputeWaypoints(Point from, Point to) const;
+
+    const Mesh& MeshData() const { return mesh; }
+};
@@ -65,3 +65,9 @@ std::tuple<Point, double> Polygon::ContainingCircle() const
     });
     return {center, distance};
 }
+
+std::tuple<Point, Point> Polygon::BoundingBox() const
+{
+    const auto bbox = _polygon.bbox();
+    return {Point(bbox.xmin(), bbox.ymin()), Point(bbox.xmax(), bbox.ymax())};
+}
@@ -23,6 +23,8 @@ public:
     bool IsInside(Point p) const;
     Point Centroid() const;
     std::tuple<Point, double> ContainingCircle() const;
+    /// Lower left and upper right corner of the axis aligned box containing the polygon.
+    std::tuple<Point, Point> BoundingBox() const;
 
     operator PolygonType() const { return _polygon; }
 };
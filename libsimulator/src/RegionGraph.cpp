@@ -0,0 +1,470 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "RegionGraph.hpp"
+
+#include "Graph.hpp"
+#include "Mesh.hpp"
+#include "Point.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+/// Distance between portals on a common border of two regions in multiples of the mean width of
+/// the edges on the border.
+constexpr double portalSpacing{4.0};
+
+Point edgeMidpoint(const Mesh& mesh, size_t polygon, size_t edge)
+{
+    const auto& vertices = mesh.Polygons(polygon).vertices;
+    const auto a = mesh.Vertex(vertices[edge]);
+    const auto b = mesh.Vertex(vertices[(edge + 1) % vertices.size()]);
+    return Point{(a.x + b.x) / 2, (a.y + b.y) / 2};
+}
+
+/// Binary min heap of (key, index) pairs that keeps its memory between uses.
+class MinHeap
+{
+    std::vector<std::pair<double, size_t>> heap{};
+
+public:
+    void Clear() { heap.clear(); }
+    bool Empty() const { return heap.empty(); }
+    void Push(double key, size_t index)
+    {
+        heap.emplace_back(key, index);
+        std::push_heap(std::begin(heap), std::end(heap), std::greater<>{});
+    }
+    std::pair<double, size_t> Pop()
+    {
+        std::pop_heap(std::begin(heap), std::end(heap), std::greater<>{});
+        const auto top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+};
+
+/// Dijkstra over the polygons of a single region.
+///
+/// Each polygon is represented by the midpoint of the edge it has been entered through, the
+/// start polygon by the start position. Each thread owns one instance which is reused for all
+/// searches of this thread, data of previous searches is invalidated by incrementing the
+/// generation.
+class RegionSearch
+{
+    std::vector<double> distances{};
+    std::vector<Point> anchors{};
+    std::vector<size_t> parents{};
+    std::vector<uint32_t> generations{};
+    uint32_t generation{};
+    MinHeap open{};
+
+public:
+    std::vector<size_t> path{};
+
+    /// Searches the polygons of 'region' reachable from 'start' without leaving 'region'.
+    /// Stops as soon as the shortest path to 'target' is known, use Mesh::InvalidIndex as target
+    /// to search the whole region.
+    void Run(
+        const Mesh& mesh,
+        const std::vector<size_t>& regions,
+        size_t region,
+        size_t start,
+        Point startAnchor,
+        size_t target)
+    {
+        reset(mesh.CountPolygons());
+        visit(start, 0.0, startAnchor, Mesh::InvalidIndex);
+        open.Push(0.0, start);
+
+        while(!open.Empty()) {
+            const auto [distance, current] = open.Pop();
+            if(distance > distances[current]) {
+                continue;
+            }
+            if(current == target) {
+                return;
+            }
+            const auto& neighbors = mesh.Polygons(current).neighbors;
+            for(size_t edge = 0; edge < neighbors.size(); ++edge) {
+                const auto neighbor = neighbors[edge];
+                if(neighbor == Mesh::Polygon::InvalidIndex || regions[neighbor] != region) {
+                    continue;
+                }
+                const auto midpoint = edgeMidpoint(mesh, current, edge);
+                const auto neighborDistance = distance + Distance(anchors[current], midpoint);
+                if(!Visited(neighbor) || neighborDistance < distances[neighbor]) {
+                    visit(neighbor, neighborDistance, midpoint, current);
+                    open.Push(neighborDistance, neighbor);
+                }
+            }
+        }
+    }
+
+    bool Visited(size_t polygon) const { return generations[polygon] == generation; }
+
+    /// Distance from the start over the anchor of 'polygon' to 'position'.
+    double DistanceVia(size_t polygon, Point position) const
+    {
+        return distances[polygon] + Distance(anchors[polygon], position);
+    }
+
+    /// Stores the polygons from the start to 'polygon' in 'path'.
+    void CollectPath(size_t polygon)
+    {
+        path.clear();
+        for(auto current = polygon; current != Mesh::InvalidIndex; current = parents[current]) {
+            path.push_back(current);
+        }
+        std::reverse(std::begin(path), std::end(path));
+    }
+
+    static RegionSearch& ForThisThread()
+    {
+        thread_local RegionSearch search{};
+        return search;
+    }
+
+private:
+    void reset(size_t polygonCount)
+    {
+        if(generations.size() < polygonCount) {
+            distances.resize(polygonCount);
+            anchors.resize(polygonCount);
+            parents.resize(polygonCount);
+            generations.resize(polygonCount);
+        }
+        open.Clear();
+        if(++generation == 0) {
+            // Wrapped around, stale data could be mistaken for current data
+            std::fill(std::begin(generations), std::end(generations), 0);
+            generation = 1;
+        }
+    }
+
+    void visit(size_t polygon, double distance, Point anchor, size_t parent)
+    {
+        distances[polygon] = distance;
+        anchors[polygon] = anchor;
+        parents[polygon] = parent;
+        generations[polygon] = generation;
+    }
+};
+
+/// A* over the portal graph, memory is reused like in RegionSearch.
+class PortalSearch
+{
+    std::vector<uint32_t> generations{};
+    std::vector<uint32_t> goalGenerations{};
+    uint32_t generation{};
+
+public:
+    std::vector<double> distances{};
+    /// Distance from each portal of the target region to the target.
+    std::vector<double> goalDistances{};
+    std::vector<size_t> parents{};
+    /// Region traversed to reach each portal from its parent.
+    std::vector<size_t> parentRegions{};
+    MinHeap open{};
+
+    void Reset(size_t portalCount)
+    {
+        if(generations.size() < portalCount) {
+            distances.resize(portalCount);
+            goalDistances.resize(portalCount);
+            parents.resize(portalCount);
+            parentRegions.resize(portalCount);
+            generations.resize(portalCount);
+            goalGenerations.resize(portalCount);
+        }
+        open.Clear();
+        if(++generation == 0) {
+            // Wrapped around, stale data could be mistaken for current data
+            std::fill(std::begin(generations), std::end(generations), 0);
+            std::fill(std::begin(goalGenerations), std::end(goalGenerations), 0);
+            generation = 1;
+        }
+    }
+
+    bool Visited(size_t portal) const { return generations[portal] == generation; }
+    bool LeadsToGoal(size_t portal) const { return goalGenerations[portal] == generation; }
+
+    void Visit(size_t portal, double distance, size_t parent, size_t parentRegion)
+    {
+        distances[portal] = distance;
+        parents[portal] = parent;
+        parentRegions[portal] = parentRegion;
+        generations[portal] = generation;
+    }
+
+    void SetGoalDistance(size_t portal, double distance)
+    {
+        goalDistances[portal] = distance;
+        goalGenerations[portal] = generation;
+    }
+
+    static PortalSearch& ForThisThread()
+    {
+        thread_local PortalSearch search{};
+        return search;
+    }
+};
+
+/// Polygon of 'portal' inside 'region'.
+size_t sideOf(const RegionGraph::Portal& portal, const std::vector<size_t>& regions, size_t region)
+{
+    return regions[portal.polygons[0]] == region ? portal.polygons[0] : portal.polygons[1];
+}
+} // namespace
+
+RegionGraph::RegionGraph(const Mesh& mesh, size_t maxRegionSize)
+{
+    maxRegionSize = std::max<size_t>(maxRegionSize, 1);
+    const auto polygonCount = mesh.CountPolygons();
+
+    // Grow regions breadth first, this keeps them connected and compact
+    regions.assign(polygonCount, Mesh::InvalidIndex);
+    size_t regionCount = 0;
+    std::queue<size_t> queue{};
+    for(size_t seed = 0; seed < polygonCount; ++seed) {
+        if(regions[seed] != Mesh::InvalidIndex) {
+            continue;
+        }
+        const auto region = regionCount++;
+        regions[seed] = region;
+        size_t regionSize = 1;
+        queue.push(seed);
+        while(!queue.empty()) {
+            const auto current = queue.front();
+            queue.pop();
+            for(const auto neighbor : mesh.Polygons(current).neighbors) {
+                if(regionSize < maxRegionSize && neighbor != Mesh::Polygon::InvalidIndex &&
+                   regions[neighbor] == Mesh::InvalidIndex) {
+                    regions[neighbor] = region;
+                    ++regionSize;
+                    queue.push(neighbor);
+                }
+            }
+        }
+    }
+
+    // Collect all edges between polygons of different regions, each from the side with the lower
+    // region
+    struct Crossing {
+        size_t lower;
+        size_t upper;
+        Portal portal;
+        double width;
+    };
+    std::vector<Crossing> crossings{};
+    for(size_t polygon = 0; polygon < polygonCount; ++polygon) {
+        const auto& polygonData = mesh.Polygons(polygon);
+        for(size_t edge = 0; edge < polygonData.neighbors.size(); ++edge) {
+            const auto neighbor = polygonData.neighbors[edge];
+            if(neighbor == Mesh::Polygon::InvalidIndex || regions[polygon] >= regions[neighbor]) {
+                continue;
+            }
+            const auto a = mesh.Vertex(polygonData.vertices[edge]);
+            const auto b =
+                mesh.Vertex(polygonData.vertices[(edge + 1) % polygonData.vertices.size()]);
+            crossings.push_back(
+                {regions[polygon],
+                 regions[neighbor],
+                 {{polygon, neighbor}, edgeMidpoint(mesh, polygon, edge)},
+                 Distance(Point{a.x, a.y}, Point{b.x, b.y})});
+        }
+    }
+    std::stable_sort(std::begin(crossings), std::end(crossings), [](const auto& a, const auto& b) {
+        return std::tie(a.lower, a.upper) < std::tie(b.lower, b.upper);
+    });
+
+    // Not every crossing becomes a portal, the border between two regions is covered by portals
+    // spaced a few edge widths apart. Open spaces where regions share long borders would
+    // otherwise result in a portal graph almost as large as the mesh. Portals are picked farthest
+    // first, starting with the crossing closest to the center of the border.
+    std::vector<Portal> portals{};
+    std::vector<double> coverage{};
+    regionPortals.resize(regionCount);
+    for(auto first = std::begin(crossings); first != std::end(crossings);) {
+        const auto last = std::find_if(first, std::end(crossings), [first](const auto& crossing) {
+            return crossing.lower != first->lower || crossing.upper != first->upper;
+        });
+        const auto count = static_cast<double>(std::distance(first, last));
+        Point center{};
+        double width{};
+        for(auto it = first; it != last; ++it) {
+            center += it->portal.midpoint;
+            width += it->width;
+        }
+        center = center / count;
+        const auto spacing = portalSpacing * width / count;
+
+        // Distance of each crossing to the closest portal picked so far
+        coverage.assign(std::distance(first, last), std::numeric_limits<double>::infinity());
+        const auto addPortal = [&](const Portal& portal) {
+            regionPortals[first->lower].push_back(portals.size());
+            regionPortals[first->upper].push_back(portals.size());
+            portals.push_back(portal);
+            for(size_t index = 0; index < coverage.size(); ++index) {
+                const auto distance = Distance(first[index].portal.midpoint, portal.midpoint);
+                coverage[index] = std::min(coverage[index], distance);
+            }
+        };
+        addPortal(std::min_element(first, last, [&center](const auto& a, const auto& b) {
+                      return Distance(a.portal.midpoint, center) <
+                             Distance(b.portal.midpoint, center);
+                  })->portal);
+        for(auto farthest = std::max_element(std::begin(coverage), std::end(coverage));
+            *farthest > spacing;
+            farthest = std::max_element(std::begin(coverage), std::end(coverage))) {
+            addPortal(first[std::distance(std::begin(coverage), farthest)].portal);
+        }
+        first = last;
+    }
+
+    DirectedGraph<Portal, Transition>::Builder builder{};
+    for(const auto& portal : portals) {
+        builder.AddVertex(portal);
+    }
+    auto& search = RegionSearch::ForThisThread();
+    for(size_t region = 0; region < regionCount; ++region) {
+        for(const auto from : regionPortals[region]) {
+            const auto& portal = portals[from];
+            search.Run(
+                mesh,
+                regions,
+                region,
+                sideOf(portal, regions, region),
+                portal.midpoint,
+                Mesh::InvalidIndex);
+            for(const auto to : regionPortals[region]) {
+                const auto side = sideOf(portals[to], regions, region);
+                if(to != from && search.Visited(side)) {
+                    builder.AddEdge(
+                        from, to, {search.DistanceVia(side, portals[to].midpoint), region});
+                }
+            }
+        }
+    }
+    portalGraph = builder.Build();
+}
+
+std::vector<size_t> RegionGraph::FindCorridor(
+    const Mesh& mesh,
+    size_t fromPolygon,
+    Point fromPosition,
+    size_t toPolygon,
+    Point toPosition) const
+{
+    const auto fromRegion = regions.at(fromPolygon);
+    const auto toRegion = regions.at(toPolygon);
+    auto& local = RegionSearch::ForThisThread();
+    auto& search = PortalSearch::ForThisThread();
+    search.Reset(CountPortals());
+
+    const auto portalAt = [this](size_t portal) -> const Portal& {
+        return portalGraph.VertexData(portal);
+    };
+
+    // Connect start and target to the portals of their regions
+    local.Run(mesh, regions, toRegion, toPolygon, toPosition, Mesh::InvalidIndex);
+    for(const auto portal : regionPortals[toRegion]) {
+        const auto side = sideOf(portalAt(portal), regions, toRegion);
+        if(local.Visited(side)) {
+            search.SetGoalDistance(portal, local.DistanceVia(side, portalAt(portal).midpoint));
+        }
+    }
+    local.Run(mesh, regions, fromRegion, fromPolygon, fromPosition, Mesh::InvalidIndex);
+    for(const auto portal : regionPortals[fromRegion]) {
+        const auto side = sideOf(portalAt(portal), regions, fromRegion);
+        if(local.Visited(side)) {
+            const auto distance = local.DistanceVia(side, portalAt(portal).midpoint);
+            search.Visit(portal, distance, Mesh::InvalidIndex, fromRegion);
+            search.open.Push(
+                distance + Distance(portalAt(portal).midpoint, toPosition), portal);
+        }
+    }
+
+    // Start and target in the same region may be connected without leaving the region
+    auto bestDistance = std::numeric_limits<double>::infinity();
+    if(fromRegion == toRegion && local.Visited(toPolygon)) {
+        bestDistance = local.DistanceVia(toPolygon, toPosition);
+    }
+    auto lastPortal = Mesh::InvalidIndex;
+    while(!search.open.Empty()) {
+        const auto [estimate, current] = search.open.Pop();
+        if(estimate >= bestDistance) {
+            break;
+        }
+        const auto distance = search.distances[current];
+        if(estimate > distance + Distance(portalAt(current).midpoint, toPosition)) {
+            continue;
+        }
+        if(search.LeadsToGoal(current) &&
+           distance + search.goalDistances[current] < bestDistance) {
+            bestDistance = distance + search.goalDistances[current];
+            lastPortal = current;
+        }
+        for(const auto& [next, transition] : portalGraph.Edges(current)) {
+            const auto nextDistance = distance + transition.distance;
+            if(!search.Visited(next) || nextDistance < search.distances[next]) {
+                search.Visit(next, nextDistance, current, transition.region);
+                search.open.Push(
+                    nextDistance + Distance(portalAt(next).midpoint, toPosition), next);
+            }
+        }
+    }
+    if(lastPortal == Mesh::InvalidIndex) {
+        if(bestDistance == std::numeric_limits<double>::infinity()) {
+            return {};
+        }
+        local.Run(mesh, regions, fromRegion, fromPolygon, fromPosition, toPolygon);
+        local.CollectPath(toPolygon);
+        return local.path;
+    }
+
+    std::vector<size_t> portals{};
+    for(auto portal = lastPortal; portal != Mesh::InvalidIndex; portal = search.parents[portal]) {
+        portals.push_back(portal);
+    }
+    std::reverse(std::begin(portals), std::end(portals));
+
+    // Refine the portal sequence into a corridor within each region passed
+    std::vector<size_t> corridor{};
+    const auto append = [&corridor](size_t polygon) {
+        if(corridor.empty() || corridor.back() != polygon) {
+            corridor.push_back(polygon);
+        }
+    };
+    auto current = fromPolygon;
+    auto anchor = fromPosition;
+    for(size_t index = 0; index < portals.size(); ++index) {
+        const auto& portal = portalAt(portals[index]);
+        const auto region = search.parentRegions[portals[index]];
+        const auto nextRegion =
+            index + 1 < portals.size() ? search.parentRegions[portals[index + 1]] : toRegion;
+        const auto side = sideOf(portal, regions, region);
+        local.Run(mesh, regions, region, current, anchor, side);
+        local.CollectPath(side);
+        for(const auto polygon : local.path) {
+            append(polygon);
+        }
+        current = sideOf(portal, regions, nextRegion);
+        anchor = portal.midpoint;
+        append(current);
+    }
+    local.Run(mesh, regions, toRegion, current, anchor, toPolygon);
+    local.CollectPath(toPolygon);
+    for(const auto polygon : local.path) {
+        append(polygon);
+    }
+    return corridor;
+}
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "Graph.hpp"
+#include "Mesh.hpp"
+#include "Point.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/// Two level abstraction of a Mesh for routing over long distances.
+///
+/// The polygons of the mesh are clustered into connected regions of bounded size. Edges between
+/// polygons of different regions are portals, on long borders only every few edges. For each
+/// region the distances between all of its portals are precomputed and stored in the portal
+/// graph. A route query searches the portal graph and only refines the result within the regions
+/// passed, instead of searching all polygons between start and destination.
+///
+/// Distances are measured between the midpoints of the edges a path crosses. Corridors found this
+/// way are close to but not necessarily the shortest ones.
+///
+/// Thread Safety: Corridor queries may be issued concurrently from multiple threads.
+class RegionGraph
+{
+public:
+    /// Default upper bound for the number of polygons in a region.
+    static constexpr size_t DefaultRegionSize{128};
+
+    struct Portal {
+        /// Polygons on both sides of the portal edge.
+        std::array<size_t, 2> polygons{};
+        Point midpoint{};
+    };
+
+    struct Transition {
+        double distance{};
+        /// Region traversed between both portals.
+        size_t region{};
+    };
+
+private:
+    /// Region of each polygon of the mesh.
+    std::vector<size_t> regions{};
+    /// Portals on the boundary of each region.
+    std::vector<std::vector<size_t>> regionPortals{};
+    DirectedGraph<Portal, Transition> portalGraph{};
+
+public:
+    explicit RegionGraph(const Mesh& mesh, size_t maxRegionSize = DefaultRegionSize);
+
+    size_t RegionOf(size_t polygon) const { return regions.at(polygon); }
+    size_t CountRegions() const { return regionPortals.size(); }
+    size_t CountPortals() const { return portalGraph.CountVertices(); }
+
+    /// Computes a corridor of adjacent polygons from 'fromPolygon' to 'toPolygon'.
+    /// @param mesh the mesh this graph has been built from.
+    /// @return indices of the polygons passed, starting with 'fromPolygon' and ending with
+    /// 'toPolygon'. Empty if 'toPolygon' is not reachable.
+    std::vector<size_t> FindCorridor(
+        const Mesh& mesh,
+        size_t fromPolygon,
+        Point fromPosition,
+        size_t toPolygon,
+        Point toPosition) const;
+};
@@ -6,20 +6,24 @@
 #include "LineSegment.hpp"
 #include "Mesh.hpp"
 #include "Point.hpp"
+#include "Polyanya.hpp"
+#include "RegionGraph.hpp"
 #include "SimulationError.hpp"
 
 #include <CGAL/Constrained_Delaunay_triangulation_2.h>
-#include <CGAL/Distance_2/Point_2_Segment_2.h>
 #include <CGAL/mark_domain_in_triangulation.h>
-#include <CGAL/number_utils.h>
 
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <limits>
-#include <map>
 #include <memory>
-#include <unordered_map>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <span>
 #include <utility>
 #include <vector>
 
@@ -38,60 +42,173 @@ RoutingEngine::RoutingEngine(const PolyWithHoles& poly)
         cdt.insert_constraint(p.vertices_begin(), p.vertices_end(), true);
     }
     CGAL::mark_domain_in_triangulation(cdt);
-    mesh = std::make_unique<Mesh>(cdt);
+    buildMesh();
 }
 
 std::unique_ptr<RoutingEngine> RoutingEngine::Clone() const
 {
     auto clone = std::make_unique<RoutingEngine>();
     clone->cdt = cdt;
-    clone->mesh = mesh->Clone();
+    clone->buildMesh();
+    clone->mode = mode;
+    clone->polyanya = polyanya;
+    clone->regionGraph = regionGraph;
     return clone;
 }
 
-Point RoutingEngine::ComputeWaypoint(Point currentPosition, Point destination)
+void RoutingEngine::buildMesh()
+{
+    mesh = std::make_unique<Mesh>(cdt);
+}
+
+Point RoutingEngine::ComputeWaypoint(Point currentPosition, Point destination) const
 {
     return ComputeAllWaypoints(currentPosition, destination)[1];
 }
 
-struct SearchState {
+namespace
+{
+/// Search data of a single polygon of the mesh.
+struct SearchNode {
     double g_value{};
     double h_value{};
-    CDT::Face_handle id{};
-    SearchState* parent{};
+    size_t parent{Mesh::InvalidIndex};
+    /// Position of this node in the open list, Mesh::InvalidIndex if not in the open list.
+    size_t heap_index{Mesh::InvalidIndex};
+    /// Search this node data belongs to, data from other searches is stale.
+    uint32_t generation{};
+    bool closed{};
 
     double f_value() const { return g_value + h_value; }
-    bool parents_contain(CDT::Face_handle ancestor_id) const
+};
+
+/// Memory used during a single path search.
+///
+/// Each thread owns one instance which is reused for all searches of this thread. Search nodes
+/// are stored densely by polygon index and are invalidated in constant time by incrementing the
+/// generation, so that a search does not allocate once the arena has grown to the size of the
+/// largest mesh searched.
+///
+/// The open list is a binary min heap of polygon indices ordered by f-value. Each node knows its
+/// position in the heap which allows to update its key in place.
+class SearchArena
+{
+    std::vector<SearchNode> nodes{};
+    std::vector<size_t> heap{};
+    uint32_t generation{};
+
+public:
+    std::vector<size_t> path{};
+
+    void Reset(size_t polygonCount)
     {
-        const SearchState* pivot = this;
-        while(pivot != nullptr) {
-            if(pivot->id == ancestor_id) {
-                return true;
+        if(nodes.size() < polygonCount) {
+            nodes.resize(polygonCount);
+        }
+        heap.clear();
+        path.clear();
+        if(++generation == 0) {
+            // Wrapped around, stale data could be mistaken for current data
+            for(auto& node : nodes) {
+                node.generation = 0;
             }
-            pivot = pivot->parent;
+            generation = 1;
         }
-        return false;
     }
-    std::vector<CDT::Face_handle> path() const
+
+    bool Visited(size_t index) const { return nodes[index].generation == generation; }
+
+    SearchNode& Node(size_t index) { return nodes[index]; }
+
+    void Open(size_t index, double g_value, double h_value, size_t parent)
     {
-        std::vector<CDT::Face_handle> p{};
-        p.reserve(16);
-        const SearchState* pivot = this;
-        while(pivot != nullptr) {
-            p.emplace_back(pivot->id);
-            pivot = pivot->parent;
+        nodes[index] = SearchNode{g_value, h_value, parent, heap.size(), generation, false};
+        heap.push_back(index);
+        siftUp(heap.size() - 1);
+    }
+
+    /// Needs to be called after the f-value of an open node decreased.
+    void DecreaseKey(size_t index) { siftUp(nodes[index].heap_index); }
+
+    bool Empty() const { return heap.empty(); }
+
+    /// Removes the node with the lowest f-value from the open list and closes it.
+    size_t PopMin()
+    {
+        const auto top = heap.front();
+        heap.front() = heap.back();
+        nodes[heap.front()].heap_index = 0;
+        heap.pop_back();
+        if(!heap.empty()) {
+            siftDown(0);
         }
-        std::reverse(std::begin(p), std::end(p));
-        return p;
+        nodes[top].heap_index = Mesh::InvalidIndex;
+        nodes[top].closed = true;
+        return top;
     }
-};
 
-bool CompareSearchStatesGt(
-    const std::shared_ptr<SearchState>& a,
-    const std::shared_ptr<SearchState>& b)
-{
-    return a->f_value() > b->f_value();
-}
+    /// Collects the path from the search start to 'index' into 'path'.
+    void CollectPath(size_t index)
+    {
+        path.clear();
+        for(auto pivot = index; pivot != Mesh::InvalidIndex; pivot = nodes[pivot].parent) {
+            path.push_back(pivot);
+        }
+        std::reverse(std::begin(path), std::end(path));
+    }
+
+    static SearchArena& ForThisThread()
+    {
+        thread_local SearchArena arena{};
+        return arena;
+    }
+
+private:
+    bool less(size_t a, size_t b) const
+    {
+        return nodes[heap[a]].f_value() < nodes[heap[b]].f_value();
+    }
+
+    void swap(size_t a, size_t b)
+    {
+        std::swap(heap[a], heap[b]);
+        nodes[heap[a]].heap_index = a;
+        nodes[heap[b]].heap_index = b;
+    }
+
+    void siftUp(size_t position)
+    {
+        while(position > 0) {
+            const auto parent = (position - 1) / 2;
+            if(!less(position, parent)) {
+                return;
+            }
+            swap(position, parent);
+            position = parent;
+        }
+    }
+
+    void siftDown(size_t position)
+    {
+        while(true) {
+            const auto left = 2 * position + 1;
+            const auto right = left + 1;
+            auto smallest = position;
+            if(left < heap.size() && less(left, smallest)) {
+                smallest = left;
+            }
+            if(right < heap.size() && less(right, smallest)) {
+                smallest = right;
+            }
+            if(smallest == position) {
+                return;
+            }
+            swap(position, smallest);
+            position = smallest;
+        }
+    }
+};
+} // namespace
 
 double length_of_path(const std::vector<Point>& path)
 {
@@ -102,83 +219,106 @@ double length_of_path(const std::vector<Point>& path)
     return segment_sum;
 }
 
-std::vector<Point> RoutingEngine::ComputeAllWaypoints(Point currentPosition, Point destination)
+std::vector<Point>
+RoutingEngine::ComputeAllWaypoints(Point currentPosition, Point destination) const
 {
-    const auto from_pos = CDT::Point{currentPosition.x, currentPosition.y};
-    const auto to_pos = CDT::Point{destination.x, destination.y};
-    const auto from = find_face(from_pos);
-    const auto to = find_face(to_pos);
+    return ComputeRoute(currentPosition, destination).waypoints;
+}
 
-    if(from == to) {
-        return std::vector<Point>{currentPosition, destination};
+Route RoutingEngine::ComputeRoute(Point currentPosition, Point destination, size_t hint) const
+{
+    auto route = [&]() {
+        switch(mode) {
+            case RoutingMode::SEARCH:
+                return searchRoute(currentPosition, destination, hint);
+            case RoutingMode::FLOW_FIELD:
+                return followFlowField(currentPosition, destination, hint);
+            case RoutingMode::POLYANYA:
+                return searchAnyAngle(currentPosition, destination, hint);
+            case RoutingMode::HIERARCHICAL:
+                return searchHierarchical(currentPosition, destination, hint);
+        }
+        throw SimulationError("Internal Error");
+    }();
+    // All modes leave the waypoints empty if no path exists
+    if(route.waypoints.empty()) {
+        throw SimulationError(
+            "Point ({}, {}) is not reachable from ({}, {})",
+            destination.x,
+            destination.y,
+            currentPosition.x,
+            currentPosition.y);
     }
+    return route;
+}
 
-    using SearchStatePtr = std::shared_ptr<SearchState>;
+Route RoutingEngine::searchRoute(Point currentPosition, Point destination, size_t hint) const
+{
+    const auto from = find_face(currentPosition, hint);
+    const auto to = find_face(destination);
 
-    std::vector<SearchStatePtr> open_states{};
-    open_states.emplace_back(
-        new SearchState{0.0, Distance(currentPosition, destination), from, nullptr});
+    if(from == to) {
+        return Route{{from}, 0, {currentPosition, destination}, destination};
+    }
 
-    std::map<CDT::Face_handle, SearchStatePtr> closed_states{};
+    auto& arena = SearchArena::ForThisThread();
+    arena.Reset(mesh->CountPolygons());
+    arena.Open(from, 0.0, Distance(currentPosition, destination), Mesh::InvalidIndex);
 
-    std::vector<Point> path{};
+    Route route{{}, 0, {}, destination};
     double path_length = std::numeric_limits<double>::infinity();
 
-    while(!open_states.empty()) {
-        std::make_heap(std::rbegin(open_states), std::rend(open_states), CompareSearchStatesGt);
-        auto current_state = open_states.back();
-        open_states.pop_back();
-        closed_states.insert(std::make_pair(current_state->id, current_state));
+    while(!arena.Empty()) {
+        const auto current = arena.PopMin();
+        const auto current_state = arena.Node(current);
 
-        if(current_state->id == to) {
+        if(current == to) {
             // Unlike in A* this is only a first candidate solution
             // Now compute the actual path length via funnel algorithm
             // store path and length if this variant is the shortest found so far
-            const auto vertex_ids = current_state->path();
-            const auto found_path = straightenPath(currentPosition, destination, vertex_ids);
+            arena.CollectPath(current);
+            auto found_path = straightenPath(currentPosition, destination, arena.path);
             const double found_path_length = length_of_path(found_path);
             if(found_path_length < path_length) {
-                path = found_path;
+                route.corridor.assign(std::begin(arena.path), std::end(arena.path));
+                route.waypoints = std::move(found_path);
                 path_length = found_path_length;
             }
         }
 
-        if(current_state->f_value() >= path_length) {
+        if(current_state.f_value() >= path_length) {
             // This search nodes f-value already excedes our paths length, and since the f-value is
             // underestimation of the path length the excat path cannot be shorter than what we have
-            return path;
+            return route;
         }
 
         // Generate successors
-        for(int idx = 0; idx < 3; ++idx) {
-            const auto target = current_state->id->neighbor(idx);
-            if(!target->get_in_domain()) {
+        const auto& polygon = mesh->Polygons(current);
+        for(size_t idx = 0; idx < polygon.neighbors.size(); ++idx) {
+            const auto target = polygon.neighbors[idx];
+            if(target == Mesh::Polygon::InvalidIndex) {
                 // Not a neighboring triangle.
                 continue;
             }
-            // Do not add search nodes for nodes already in the ancestor list of this path
-            if(current_state->parents_contain(target)) {
-                continue;
-            }
 
-            // Skip successors for nodes already in the closed list
-            if(closed_states.contains(target)) {
+            // Skip successors for nodes already in the closed list, this includes all ancestors
+            // of this node.
+            if(arena.Visited(target) && arena.Node(target).closed) {
                 continue;
             }
 
-            const auto edge = cdt.segment(target, idx);
+            const auto edge = edgeOf(current, idx);
 
             // For all remaining nodes compute g/h values
             // The h-value is the distance between the goal and the closts point on the edge
             // between the current triangle and this successor
-            const double h_value = sqrt(CGAL::to_double((CGAL::squared_distance(to_pos, edge))));
+            const double h_value = edge.DistTo(destination);
 
             // The g-value is the maximum of:
 
             // "The first and simplest is the distance between the start point and the closest
             // point to it on the entry edge of the corresponding triangle."
-            const double g_value_1 =
-                sqrt(CGAL::to_double((CGAL::squared_distance(from_pos, edge))));
+            const double g_value_1 = edge.DistTo(currentPosition);
 
             // The second is g(s) plus the distance between the triangles associated with s and
             // s′. We assume that the g-value of s is a lower bound, and so we wish to add the
@@ -190,55 +330,257 @@ std::vector<Point> RoutingEngine::ComputeAllWaypoints(Point currentPosition, Poi
             // by these edges. Thus, if the entry edges of the triangles corresponding to s′ and
             // s form an angle θ, this estimate is calculated as g(s) + rθ. NOTE: Right now this
             // is always g(s) + zero as we asume point size agents (for now)
-            const double g_value_2 = current_state->g_value + 0;
+            const double g_value_2 = current_state.g_value + 0;
 
             //  Another lower bound value for g(s′) is g(s)+(h(s)−h(s′)), or the parent state’s
             //  g-value plus the difference between its h-value and that of the child state.
             //  This is an underes- timate because the Euclidean distance metric used for the
             //  heuristic is consistent.
-            const double g_value_3 = current_state->g_value + current_state->h_value - h_value;
+            const double g_value_3 = current_state.g_value + current_state.h_value - h_value;
 
             const double g_value = std::max(g_value_1, std::max(g_value_2, g_value_3));
 
-            // NOTE(kkratz): Clang16 seems to be confused with capturing a structured binding
-            // and emits a warnign when capturing 'target' directly As of C++20 this SHOULD(TM)
-            // be valid code but see:
-            // https://stackoverflow.com/questions/46114214/lambda-implicit-capture-fails-with-variable-declared-from-structured-binding
-            auto t2 = target;
-
-            // TODO(kkratz): replace this find on unsorted vector with something with a better
-            // runtime
-            if(auto iter = std::find_if(
-                   std::begin(open_states),
-                   std::end(open_states),
-                   [t2](const auto& s) { return s->id == t2; });
-               iter != std::end(open_states)) {
-                if(auto& s = *iter; s->g_value > g_value) {
-                    s->g_value = g_value;
-                    s->parent = current_state.get();
+            if(arena.Visited(target)) {
+                if(auto& s = arena.Node(target); s.g_value > g_value) {
+                    s.g_value = g_value;
+                    s.parent = current;
+                    arena.DecreaseKey(target);
                 }
+            } else {
+                arena.Open(target, g_value, h_value, current);
+            }
+        }
+    }
 
-            } else if(auto iter = closed_states.find(target); iter != std::end(closed_states)) {
-                if(auto& [_, s] = *iter; s->g_value > g_value) {
-                    s->g_value = g_value;
-                    s->parent = current_state.get();
-                    open_states.push_back(s);
-                    closed_states.erase(s->id);
+    return route;
+}
+
+Route RoutingEngine::followFlowField(Point currentPosition, Point destination, size_t hint) const
+{
+    const auto& field = flowFieldFor(destination);
+    auto face = find_face(currentPosition, hint);
+
+    Route route{{}, 0, {}, destination};
+    route.corridor.push_back(face);
+    while(face != field.target) {
+        face = field.next[face];
+        if(face == Mesh::InvalidIndex) {
+            // Target is not reachable from here
+            return Route{{}, 0, {}, destination};
+        }
+        route.corridor.push_back(face);
+    }
+    route.waypoints = straightenPath(currentPosition, destination, route.corridor);
+    return route;
+}
+
+Route RoutingEngine::searchAnyAngle(Point currentPosition, Point destination, size_t hint) const
+{
+    const auto from = find_face(currentPosition, hint);
+    find_face(destination);
+    Route route{{}, 0, polyanya->ComputeWaypoints(currentPosition, destination), destination};
+    if(route.waypoints.empty()) {
+        return route;
+    }
+
+    // The path touches the corners it turns around. Moved off the corners by a tiny distance it
+    // crosses the triangles of a corridor, along which the funnel keeps the same 0.2m distance to
+    // corners as in all other modes. Moving the corners by the full 0.2m instead cuts through
+    // walls the path passes closely without turning around them.
+    auto offCorners = route.waypoints;
+    for(size_t index = 1; index + 1 < offCorners.size(); ++index) {
+        const auto corner = route.waypoints[index];
+        const auto away = (corner - route.waypoints[index - 1]).Normalized() +
+                          (corner - route.waypoints[index + 1]).Normalized();
+        if(!away.isZeroLength()) {
+            offCorners[index] = corner + away.Normalized() * 1e-6;
+        }
+    }
+    // The triangles along the path let 'UpdateRoute' straighten the path from later positions.
+    // Without them the path keeps touching the corners and is not cached.
+    route.corridor = corridorAlong(offCorners, from);
+    if(!route.corridor.empty()) {
+        route.waypoints = straightenPath(currentPosition, destination, route.corridor);
+    }
+    return route;
+}
+
+std::vector<size_t>
+RoutingEngine::corridorAlong(const std::vector<Point>& waypoints, size_t start) const
+{
+    std::vector<size_t> corridor{start};
+    const auto vertex = [this](size_t index) {
+        const auto v = mesh->Vertex(index);
+        return Point{v.x, v.y};
+    };
+    for(size_t index = 1; index < waypoints.size(); ++index) {
+        const auto p = waypoints[index - 1];
+        const auto q = waypoints[index];
+        // Each step crosses into a new triangle, a walk can not take more steps than there are
+        // triangles
+        size_t steps = 0;
+        while(!mesh->TriangleContains(corridor.back(), {q.x, q.y})) {
+            if(++steps > mesh->CountPolygons()) {
+                return {};
+            }
+            const auto& polygon = mesh->Polygons(corridor.back());
+            size_t next = Mesh::InvalidIndex;
+            for(size_t edge = 0; edge < 3; ++edge) {
+                const auto a = vertex(polygon.vertices[edge]);
+                const auto b = vertex(polygon.vertices[(edge + 1) % 3]);
+                const auto c = vertex(polygon.vertices[(edge + 2) % 3]);
+                // The line through 'p' and 'q' leaves through the edge that separates 'q' from
+                // the opposite vertex, the edge it enters through has 'q' on the same side.
+                if(orientationSign(p, q, a) * orientationSign(p, q, b) < 0 &&
+                   orientationSign(a, b, q) != orientationSign(a, b, c)) {
+                    next = polygon.neighbors[edge];
+                    break;
                 }
-            } else {
-                open_states.emplace_back(
-                    new SearchState{g_value, h_value, target, current_state.get()});
+            }
+            // Paths through a vertex are not followed, as are paths leaving the mesh. The route
+            // is not cached in this case.
+            if(next == Mesh::InvalidIndex) {
+                return {};
+            }
+            corridor.push_back(next);
+        }
+    }
+    return corridor;
+}
+
+Route RoutingEngine::searchHierarchical(Point currentPosition, Point destination, size_t hint)
+    const
+{
+    const auto from = find_face(currentPosition, hint);
+    const auto to = find_face(destination);
+
+    // Within a single region a search of the triangulation is cheap and finds the exact route
+    if(regionGraph->RegionOf(from) == regionGraph->RegionOf(to)) {
+        return searchRoute(currentPosition, destination, from);
+    }
+
+    Route route{
+        regionGraph->FindCorridor(*mesh, from, currentPosition, to, destination),
+        0,
+        {},
+        destination};
+    if(!route.corridor.empty()) {
+        route.waypoints = straightenPath(currentPosition, destination, route.corridor);
+    }
+    return route;
+}
+
+const FlowField& RoutingEngine::flowFieldFor(Point destination) const
+{
+    {
+        // Fields only get built for the first agents heading to a target, all later lookups
+        // share the lock.
+        std::shared_lock lock(flowFieldsMutex);
+        if(const auto iter = flowFields.find(destination); iter != std::end(flowFields)) {
+            return *iter->second;
+        }
+    }
+
+    // Dijkstra outwards from the target. Each face is represented by the midpoint of the edge
+    // through which it is entered on its way to the target, the target face by the target itself.
+    const auto polygonCount = mesh->CountPolygons();
+    auto field = std::make_unique<FlowField>();
+    field->target = find_face(destination);
+    field->next.assign(polygonCount, Mesh::InvalidIndex);
+
+    struct Entry {
+        double distance;
+        size_t face;
+        Point anchor;
+        bool operator>(const Entry& other) const { return distance > other.distance; }
+    };
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue{};
+    std::vector<double> distances(polygonCount, std::numeric_limits<double>::infinity());
+    distances[field->target] = 0.0;
+    queue.push({0.0, field->target, destination});
+
+    while(!queue.empty()) {
+        const auto [distance, face, anchor] = queue.top();
+        queue.pop();
+        if(distance > distances[face]) {
+            continue;
+        }
+        const auto& polygon = mesh->Polygons(face);
+        for(size_t idx = 0; idx < polygon.neighbors.size(); ++idx) {
+            const auto neighbor = polygon.neighbors[idx];
+            if(neighbor == Mesh::Polygon::InvalidIndex) {
+                continue;
+            }
+            const auto edge = edgeOf(face, idx);
+            const auto midpoint = (edge.p1 + edge.p2) / 2;
+            const auto neighborDistance = distance + Distance(anchor, midpoint);
+            if(neighborDistance < distances[neighbor]) {
+                distances[neighbor] = neighborDistance;
+                field->next[neighbor] = face;
+                queue.push({neighborDistance, neighbor, midpoint});
             }
         }
     }
 
-    return path;
+    // Another agent may have built the same field in the meantime, keep the first one.
+    std::unique_lock lock(flowFieldsMutex);
+    const auto& [iter, _] = flowFields.emplace(destination, std::move(field));
+    return *iter->second;
+}
+
+void RoutingEngine::ClearFlowFields()
+{
+    std::unique_lock lock(flowFieldsMutex);
+    flowFields.clear();
+}
+
+void RoutingEngine::SetMode(RoutingMode newMode)
+{
+    if(newMode == RoutingMode::POLYANYA && !polyanya && mesh) {
+        auto merged = *mesh;
+        merged.MergeGreedy();
+        polyanya = std::make_shared<const Polyanya>(std::move(merged));
+    }
+    if(newMode == RoutingMode::HIERARCHICAL && !regionGraph && mesh) {
+        regionGraph = std::make_shared<const RegionGraph>(*mesh);
+    }
+    mode = newMode;
+}
+
+bool RoutingEngine::UpdateRoute(Route& route, Point currentPosition) const
+{
+    const glm::dvec2 position{currentPosition.x, currentPosition.y};
+    const auto& corridor = route.corridor;
+    const auto contains = [this, &position](size_t face) {
+        return mesh->TriangleContains(face, position);
+    };
+
+    // Agents usually stay in their face or advance along the corridor, search in this direction
+    // first before checking the faces already passed.
+    auto index = route.corridorIndex;
+    while(index < corridor.size() && !contains(corridor[index])) {
+        ++index;
+    }
+    if(index == corridor.size()) {
+        index = std::min(route.corridorIndex, corridor.size());
+        do {
+            if(index == 0) {
+                return false;
+            }
+            --index;
+        } while(!contains(corridor[index]));
+    }
+
+    route.corridorIndex = index;
+    route.waypoints = straightenPath(
+        currentPosition, route.destination, std::span<const size_t>(corridor).subspan(index));
+    return true;
 }
 
 bool RoutingEngine::IsRoutable(Point p) const
 {
     try {
-        find_face({p.x, p.y});
+        find_face(p);
     } catch(const SimulationError&) {
         return false;
     }
@@ -249,20 +591,25 @@ void RoutingEngine::Update()
 {
 }
 
-CDT::Face_handle RoutingEngine::find_face(K::Point_2 p) const
+size_t RoutingEngine::find_face(Point p, size_t hint) const
 {
-    const auto face = cdt.locate(p);
-    if(face == nullptr || cdt.is_infinite(face) || !face->get_in_domain()) {
-        throw SimulationError(
-            "Point ({}, {}) is outside of accessible area",
-            CGAL::to_double(p.x()),
-            CGAL::to_double(p.y()));
+    const auto face = mesh->FindContainingPolygon({p.x, p.y}, hint);
+    if(face == Mesh::InvalidIndex) {
+        throw SimulationError("Point ({}, {}) is outside of accessible area", p.x, p.y);
     }
     return face;
 }
 
+LineSegment RoutingEngine::edgeOf(size_t polygonIndex, size_t edgeIndex) const
+{
+    const auto& vertices = mesh->Polygons(polygonIndex).vertices;
+    const auto a = mesh->Vertex(vertices[edgeIndex]);
+    const auto b = mesh->Vertex(vertices[(edgeIndex + 1) % vertices.size()]);
+    return LineSegment{{a.x, a.y}, {b.x, b.y}};
+}
+
 std::vector<Point>
-RoutingEngine::straightenPath(Point from, Point to, const std::vector<CDT::Face_handle>& path)
+RoutingEngine::straightenPath(Point from, Point to, std::span<const size_t> path) const
 {
     // TODO(kkratz): Remove the 0.2m edge width adjustment and replace this with p[roper
     // arc-paths from the "Efficient Triangulation-Based Pathfinding" publication
@@ -277,15 +624,11 @@ RoutingEngine::straightenPath(Point from, Point to, const std::vector<CDT::Face_
     size_t index_left{0};
     size_t index_right{0};
 
-    const auto get_edge = [this](const auto& a, const auto& b) {
-        for(int idx = 0; idx < 3; ++idx) {
-            if(a->neighbor(idx) == b) {
-                const auto s = cdt.segment(a, idx);
-                const auto src = s.source();
-                const auto tgt = s.target();
-                return LineSegment{
-                    {CGAL::to_double(src.x()), CGAL::to_double(src.y())},
-                    {CGAL::to_double(tgt.x()), CGAL::to_double(tgt.y())}};
+    const auto get_edge = [this](size_t a, size_t b) {
+        const auto& neighbors = mesh->Polygons(a).neighbors;
+        for(size_t idx = 0; idx < neighbors.size(); ++idx) {
+            if(neighbors[idx] == b) {
+                return edgeOf(a, idx);
             }
         }
         throw SimulationError("Internal Error");
@@ -295,20 +638,19 @@ RoutingEngine::straightenPath(Point from, Point to, const std::vector<CDT::Face_
     // This is an over estimation but IMO preferable to repeadted allocations.
     // Ideally we replace this with something w.o. allocations
     waypoints.reserve(path.size() + 1);
-    for(size_t index_portal = 1; index_portal < portalCount; ++index_portal) {
-        const auto face_from = path[index_portal - 1];
-        const auto face_to = path[index_portal];
-        if(face_from->neighbor(0) == face_to) {
-        }
-
-        const auto portal =
-            index_portal < portalCount ? get_edge(face_from, face_to) : LineSegment(to, to);
+    for(size_t index_portal = 1; index_portal <= portalCount; ++index_portal) {
+        const auto portal = index_portal < portalCount ?
+                                get_edge(path[index_portal - 1], path[index_portal]) :
+                                LineSegment(to, to);
 
         const auto line_segment_left = portal.p2;
         const auto line_segment_right = portal.p1;
         const auto line_segment_direction = (line_segment_right - line_segment_left).Normalized();
-        const auto candidate_left = line_segment_left + (line_segment_direction * 0.2);
-        const auto candidate_right = line_segment_right - (line_segment_direction * 0.2);
+        // Portals narrower than twice the distance are passed in their middle, otherwise left
+        // and right swap and the funnel never closes again.
+        const auto inset = std::min(0.2, (line_segment_right - line_segment_left).Norm() / 2);
+        const auto candidate_left = line_segment_left + (line_segment_direction * inset);
+        const auto candidate_right = line_segment_right - (line_segment_direction * inset);
 
         if(triarea2d(apex, portal_right, candidate_right) <= 0.0) {
             if(apex == portal_right || triarea2d(apex, portal_left, candidate_right) > 0.0) {
@@ -343,6 +685,9 @@ RoutingEngine::straightenPath(Point from, Point to, const std::vector<CDT::Face_
             }
         }
     }
-    waypoints.emplace_back(to);
+    // The funnel closing on the last portal may already have added 'to' as corner
+    if(waypoints.size() < 2 || waypoints.back() != to) {
+        waypoints.emplace_back(to);
+    }
     return waypoints;
 }
@@ -3,21 +3,69 @@
 
 #include "CfgCgal.hpp"
 #include "Clonable.hpp"
+#include "LineSegment.hpp"
 #include "Mesh.hpp"
 #include "Point.hpp"
+#include "Polyanya.hpp"
+#include "RegionGraph.hpp"
+#include "RoutingMode.hpp"
 
 #include <cstddef>
+#include <map>
 #include <memory>
+#include <shared_mutex>
+#include <span>
 #include <variant>
 #include <vector>
 
 using LocationID = size_t;
 using Location = std::variant<Point, LocationID>;
 
+/// Route of a single agent through the navigation mesh.
+///
+/// A route is created with 'RoutingEngine::ComputeRoute' and can be kept up to date with
+/// 'RoutingEngine::UpdateRoute' for as long as the agent stays inside the corridor of the route.
+/// A route is only meaningful for the RoutingEngine it was created by.
+struct Route {
+    /// Indices of the Mesh polygons traversed from the start of the route to the polygon
+    /// containing 'destination'.
+    std::vector<size_t> corridor{};
+    /// Index into 'corridor' of the face containing the position of the last update.
+    size_t corridorIndex{};
+    /// Waypoints from the position of the last update to 'destination'.
+    std::vector<Point> waypoints{};
+    Point destination{};
+
+    /// Polygon containing the position of the last update, Mesh::InvalidIndex if unknown.
+    size_t CurrentPolygon() const
+    {
+        return corridorIndex < corridor.size() ? corridor[corridorIndex] : Mesh::InvalidIndex;
+    }
+};
+
+/// Shortest path distances of all faces to a single target.
+struct FlowField {
+    /// Index of the Mesh polygon containing the target.
+    size_t target{Mesh::InvalidIndex};
+    /// Next polygon on the shortest path to 'target' for each polygon of the Mesh,
+    /// Mesh::InvalidIndex for 'target' and all polygons 'target' is not reachable from.
+    std::vector<size_t> next{};
+};
+
 class RoutingEngine : public Clonable<RoutingEngine>
 {
     CDT cdt{};
     std::unique_ptr<Mesh> mesh{};
+    RoutingMode mode{RoutingMode::SEARCH};
+    /// Flow fields are built lazily on first use of a target.
+    mutable std::map<Point, std::unique_ptr<const FlowField>> flowFields{};
+    mutable std::shared_mutex flowFieldsMutex{};
+    /// Search on the merged mesh, built when switching to RoutingMode::POLYANYA for the first
+    /// time and shared with clones.
+    std::shared_ptr<const Polyanya> polyanya{};
+    /// Region abstraction of 'mesh', built when switching to RoutingMode::HIERARCHICAL for the
+    /// first time and shared with clones.
+    std::shared_ptr<const RegionGraph> regionGraph{};
 
 public:
     RoutingEngine();
@@ -27,19 +75,53 @@ public:
     RoutingEngine(const RoutingEngine& other) = delete;
     RoutingEngine& operator=(const RoutingEngine& other) = delete;
 
-    RoutingEngine(RoutingEngine&& other) = default;
-    RoutingEngine& operator=(RoutingEngine&& other) = default;
+    RoutingEngine(RoutingEngine&& other) = delete;
+    RoutingEngine& operator=(RoutingEngine&& other) = delete;
 
     std::unique_ptr<RoutingEngine> Clone() const override;
-    Point ComputeWaypoint(Point currentPosition, Point destination);
-    std::vector<Point> ComputeAllWaypoints(Point currentPosition, Point destination);
+    /// Computes the next waypoint on the shortest path from 'currentPosition' to 'destination'.
+    ///
+    /// Thread Safety: Route queries may be issued concurrently from multiple threads.
+    Point ComputeWaypoint(Point currentPosition, Point destination) const;
+    std::vector<Point> ComputeAllWaypoints(Point currentPosition, Point destination) const;
+    /// Computes the shortest route from 'currentPosition' to 'destination'.
+    /// @param hint polygon of the mesh close to 'currentPosition', e.g. from a previous route of
+    /// the same agent. Speeds up locating 'currentPosition' in the mesh.
+    /// Throws SimulationError if either point is outside of the mesh or 'destination' cannot be
+    /// reached from 'currentPosition'. The waypoints of the route returned contain at least both
+    /// points.
+    Route ComputeRoute(
+        Point currentPosition,
+        Point destination,
+        size_t hint = Mesh::InvalidIndex) const;
+    /// Recomputes the waypoints of 'route' for an agent now located at 'currentPosition' without
+    /// searching the navigation mesh again.
+    /// @return false if 'currentPosition' is not inside the corridor of 'route', 'route' is left
+    /// untouched in this case.
+    bool UpdateRoute(Route& route, Point currentPosition) const;
     bool IsRoutable(Point p) const;
     void Update();
+    RoutingMode Mode() const { return mode; }
+    void SetMode(RoutingMode newMode);
+    /// Releases all flow fields built so far.
+    void ClearFlowFields();
 
     const Mesh* MeshData() const { return mesh.get(); };
 
 private:
-    CDT::Face_handle find_face(K::Point_2) const;
+    void buildMesh();
+    size_t find_face(Point p, size_t hint = Mesh::InvalidIndex) const;
+    /// Edge 'edgeIndex' of the polygon, i.e. the edge shared with 'neighbors[edgeIndex]'.
+    LineSegment edgeOf(size_t polygonIndex, size_t edgeIndex) const;
+    Route searchRoute(Point currentPosition, Point destination, size_t hint) const;
+    Route followFlowField(Point currentPosition, Point destination, size_t hint) const;
+    Route searchAnyAngle(Point currentPosition, Point destination, size_t hint) const;
+    /// Triangles of the mesh crossed by the path along 'waypoints', starting in the triangle
+    /// 'start' that contains the first waypoint. Empty if the path passes through a vertex or
+    /// leaves the mesh.
+    std::vector<size_t> corridorAlong(const std::vector<Point>& waypoints, size_t start) const;
+    Route searchHierarchical(Point currentPosition, Point destination, size_t hint) const;
+    const FlowField& flowFieldFor(Point destination) const;
     std::vector<Point>
-    straightenPath(Point from, Point to, const std::vector<CDT::Face_handle>& path);
+    straightenPath(Point from, Point to, std::span<const size_t> path) const;
 };
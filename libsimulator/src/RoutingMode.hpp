@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+/// Selects how the RoutingEngine computes routes.
+enum class RoutingMode {
+    /// Search the triangulation for each route individually.
+    SEARCH,
+    /// Follow a distance field that is computed once per target and shared by all agents heading
+    /// to this target.
+    FLOW_FIELD,
+    /// Search the merged convex polygons of the navigation mesh for the shortest any-angle path
+    /// with Polyanya.
+    POLYANYA,
+    /// Search a graph of precomputed distances between the borders of regions of the navigation
+    /// mesh and only refine the route inside the regions passed. Routes are close to but not
+    /// always the shortest, meant for large geometries where searching the whole triangulation
+    /// for each route is too slow.
+    HIERARCHICAL
+};
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "Simulation.hpp"
 
+#include "AABB.hpp"
+#include "AgentStore.hpp"
 #include "CollisionGeometry.hpp"
 #include "GeneralizedCentrifugalForceModelData.hpp"
 #include "GenericAgent.hpp"
@@ -14,6 +16,7 @@
 #include "RoutingEngine.hpp"
 #include "SimulationClock.hpp"
 #include "SimulationError.hpp"
+#include "SpaceFillingCurve.hpp"
 #include "Stage.hpp"
 #include "StageDescription.hpp"
 #include "Tracing.hpp"
@@ -26,11 +29,14 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <exception>
 #include <iterator>
 #include <map>
 #include <memory>
+#include <span>
 #include <string>
 #include <tuple>
+#include <unordered_set>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -38,8 +44,14 @@
 Simulation::Simulation(
     std::unique_ptr<OperationalModel>&& operationalModel,
     std::unique_ptr<CollisionGeometry>&& geometry,
-    double dT)
-    : _clock(dT), _operationalDecisionSystem(std::move(operationalModel))
+    double dT,
+    size_t threadCount)
+    : _clock(dT)
+    , _operationalDecisionSystem(std::move(operationalModel))
+    , _neighborhoodSearch(
+          _agents,
+          AgentNeighborhoodSearch::CellSizeFor(_operationalDecisionSystem.InteractionRange()))
+    , _workerPool(threadCount)
 {
     const auto p = geometry->Polygon();
     const auto& [tup, res] = geometries.emplace(
@@ -51,6 +63,7 @@ Simulation::Simulation(
     }
     _geometry = std::get<0>(tup->second).get();
     _routingEngine = std::get<1>(tup->second).get();
+    _neighborhoodSearch.SetBounds(AABB{std::get<0>(_geometry->AccessibleArea())});
 }
 const SimulationClock& Simulation::Clock() const
 {
@@ -67,20 +80,37 @@ PerfStats Simulation::GetLastStats() const
     return _perfStats;
 };
 
+size_t Simulation::ThreadCount() const
+{
+    return _workerPool.ThreadCount();
+}
+
 void Simulation::Iterate()
 {
     // LOG_DEBUG("Iteration {} / Time {}s", _clock.Iteration(), _clock.ElapsedTime());
     auto t = _perfStats.TraceIterate();
+    _tacticalDecisionSystem.RemoveAgents(_removedAgentsInLastIteration);
     _agentRemovalSystem.Run(_agents, _removedAgentsInLastIteration, _stageManager);
-    _neighborhoodSearch.Update(_agents);
+    if(_agentReorderInterval > 0 && _clock.Iteration() % _agentReorderInterval == 0) {
+        _agents.Reorder(MortonOrder(_agents.Positions()));
+    }
+    _neighborhoodSearch.Update(_workerPool);
+    SpawnAgents();
 
     _stageSystem.Run(_stageManager, _neighborhoodSearch, *_geometry);
     _stategicalDecisionSystem.Run(_journeys, _agents, _stageManager);
-    _tacticalDecisionSystem.Run(*_routingEngine, _agents);
+    const auto routeCacheStatistics =
+        _tacticalDecisionSystem.Run(*_routingEngine, _agents, _workerPool);
+    _perfStats.RecordRouteCacheLookups(routeCacheStatistics.hits, routeCacheStatistics.misses);
     {
         auto t2 = _perfStats.TraceOperationalDecisionSystemRun();
         _operationalDecisionSystem.Run(
-            _clock.dT(), _clock.ElapsedTime(), _neighborhoodSearch, *_geometry, _agents);
+            _clock.dT(),
+            _clock.ElapsedTime(),
+            _neighborhoodSearch,
+            *_geometry,
+            _agents,
+            _workerPool);
     }
     _clock.Advance();
 }
@@ -97,6 +127,11 @@ Journey::ID Simulation::AddJourney(const std::map<BaseStage::ID, TransitionDescr
         throw SimulationError(
             "Journeys containing a DirectSteeringStage, may only contain this stage.");
     }
+    if(std::any_of(std::begin(stages), std::end(stages), [this](auto const& pair) {
+           return std::holds_alternative<SourceProxy>(Stage(pair.first));
+       })) {
+        throw SimulationError("Source stages can not be part of a journey.");
+    }
 
     std::transform(
         std::begin(stages),
@@ -192,6 +227,19 @@ BaseStage::ID Simulation::AddStage(const StageDescription stageDescription)
             },
             [](const DirectSteeringDescription&) -> void {
 
+            },
+            [this](const SourceDescription& d) -> void {
+                if(!this->_geometry->InsideGeometry(d.area.Centroid())) {
+                    throw SimulationError("Source {} not inside walkable area", d.area.Centroid());
+                }
+                // Checks everything of the new agents except their position
+                ValidateAgentPlacement(GenericAgent(
+                    GenericAgent::ID::Invalid,
+                    d.journeyId,
+                    d.stageId,
+                    d.area.Centroid(),
+                    d.orientation,
+                    d.model));
             }},
         stageDescription);
 
@@ -200,66 +248,121 @@ BaseStage::ID Simulation::AddStage(const StageDescription stageDescription)
 
 GenericAgent::ID Simulation::AddAgent(GenericAgent agent)
 {
-
-    if(!_geometry->InsideGeometry(agent.pos)) {
-        throw SimulationError("Agent {} not inside walkable area", agent.pos);
-    }
-    if(_journeys.count(agent.journeyId) == 0) {
-        throw SimulationError("Unknown journey id: {}", agent.journeyId);
-    }
-
-    if(!_journeys.at(agent.journeyId)->ContainsStage(agent.stageId)) {
-        throw SimulationError("Unknown stage id: {}", agent.stageId);
-    }
-
-    if(std::holds_alternative<GeneralizedCentrifugalForceModelData>(agent.model))
-        if(agent.orientation.isZeroLength()) {
-            throw SimulationError(
-                "Orientation is invalid: {}. Length should be 1.", agent.orientation);
-        }
+    ValidateAgentPlacement(agent);
 
     agent.orientation = agent.orientation.Normalized();
     _operationalDecisionSystem.ValidateAgent(agent, _neighborhoodSearch, *_geometry);
 
+    const auto index = _agents.Add(agent);
     _stageManager.HandleNewAgent(agent.stageId);
-    _agents.emplace_back(std::move(agent));
-    _neighborhoodSearch.AddAgent(_agents.back());
+    _neighborhoodSearch.AddAgent(index);
 
     auto v = IteratorPair(std::prev(std::end(_agents)), std::end(_agents));
     _stategicalDecisionSystem.Run(_journeys, v, _stageManager);
-    _tacticalDecisionSystem.Run(*_routingEngine, v);
-    return _agents.back().id.getID();
+    _tacticalDecisionSystem.Run(*_routingEngine, v, _workerPool);
+    return agent.id;
+}
+
+std::vector<GenericAgent::ID> Simulation::AddAgents(std::span<const GenericAgent> agents)
+{
+    if(agents.empty()) {
+        return {};
+    }
+    // Errors are collected per agent, so that always the first invalid agent is reported
+    // independent of the number of threads
+    std::vector<std::exception_ptr> errors(agents.size());
+    const auto rethrowFirstError = [&errors]() {
+        const auto error = std::find_if(
+            std::begin(errors), std::end(errors), [](const auto& e) { return e != nullptr; });
+        if(error != std::end(errors)) {
+            std::rethrow_exception(*error);
+        }
+    };
+
+    _workerPool.ParallelFor(agents.size(), [this, agents, &errors](size_t begin, size_t end) {
+        for(auto index = begin; index < end; ++index) {
+            try {
+                ValidateAgentPlacement(agents[index]);
+            } catch(...) {
+                errors[index] = std::current_exception();
+            }
+        }
+    });
+    rethrowFirstError();
+
+    const auto first = _agents.size();
+    try {
+        for(const auto& agent : agents) {
+            const auto index = _agents.Add(agent);
+            _agents[index].orientation = agent.orientation.Normalized();
+        }
+    } catch(...) {
+        RemoveAgentsFrom(first);
+        throw;
+    }
+
+    // The new agents enter the grid with a single rebuild and are then validated against all
+    // agents, including each other
+    _neighborhoodSearch.Update(_workerPool);
+    _workerPool.ParallelFor(agents.size(), [this, first, &errors](size_t begin, size_t end) {
+        for(auto index = begin; index < end; ++index) {
+            try {
+                _operationalDecisionSystem.ValidateAgent(
+                    std::as_const(_agents)[first + index], _neighborhoodSearch, *_geometry);
+            } catch(...) {
+                errors[index] = std::current_exception();
+            }
+        }
+    });
+    try {
+        rethrowFirstError();
+    } catch(...) {
+        RemoveAgentsFrom(first);
+        throw;
+    }
+
+    DecideForNewAgents(first);
+    const auto& ids = _agents.Ids();
+    return {std::begin(ids) + static_cast<std::ptrdiff_t>(first), std::end(ids)};
 }
 
 void Simulation::MarkAgentForRemoval(GenericAgent::ID id)
 {
-    const auto iter = std::find_if(
-        std::begin(_agents), std::end(_agents), [id](auto& agent) { return agent.id == id; });
-    if(iter == std::end(_agents)) {
+    if(!_agents.Contains(id)) {
         throw SimulationError("Unknown agent id {}", id);
     }
 
     _removedAgentsInLastIteration.push_back(id);
 }
 
-const GenericAgent& Simulation::Agent(GenericAgent::ID id) const
+void Simulation::MarkAgentsForRemoval(const std::vector<GenericAgent::ID>& ids)
+{
+    for(const auto id : ids) {
+        if(!_agents.Contains(id)) {
+            throw SimulationError("Unknown agent id {}", id);
+        }
+    }
+
+    _removedAgentsInLastIteration.insert(
+        std::end(_removedAgentsInLastIteration), std::begin(ids), std::end(ids));
+}
+
+ConstAgentRef Simulation::Agent(GenericAgent::ID id) const
 {
-    const auto iter =
-        std::find_if(_agents.begin(), _agents.end(), [id](auto& ped) { return id == ped.id; });
-    if(iter == _agents.end()) {
+    const auto index = _agents.IndexOf(id);
+    if(index == AgentStore::InvalidIndex) {
         throw SimulationError("Trying to access unknown Agent {}", id);
     }
-    return *iter;
+    return _agents[index];
 }
 
-GenericAgent& Simulation::Agent(GenericAgent::ID id)
+AgentRef Simulation::Agent(GenericAgent::ID id)
 {
-    const auto iter =
-        std::find_if(_agents.begin(), _agents.end(), [id](auto& ped) { return id == ped.id; });
-    if(iter == _agents.end()) {
+    const auto index = _agents.IndexOf(id);
+    if(index == AgentStore::InvalidIndex) {
         throw SimulationError("Trying to access unknown Agent {}", id);
     }
-    return *iter;
+    return _agents[index];
 }
 
 const std::vector<GenericAgent::ID>& Simulation::RemovedAgents() const
@@ -287,7 +390,7 @@ size_t Simulation::AgentCount() const
     return _agents.size();
 }
 
-std::vector<GenericAgent>& Simulation::Agents()
+AgentStore& Simulation::Agents()
 {
     return _agents;
 };
@@ -305,7 +408,7 @@ void Simulation::SwitchAgentJourney(
     if(!journey->ContainsStage(stage_id)) {
         throw SimulationError("Stage {} not part of Journey {}", stage_id, journey_id);
     }
-    auto& agent = Agent(agent_id);
+    auto agent = Agent(agent_id);
     agent.journeyId = journey_id;
     _stageManager.MigrateAgent(agent.stageId, stage_id);
     agent.stageId = stage_id;
@@ -313,15 +416,9 @@ void Simulation::SwitchAgentJourney(
 
 std::vector<GenericAgent::ID> Simulation::AgentsInRange(Point p, double distance)
 {
-    const auto neighbors = _neighborhoodSearch.GetNeighboringAgents(p, distance);
-
     std::vector<GenericAgent::ID> neighborIds{};
-    neighborIds.reserve(neighbors.size());
-    std::transform(
-        std::begin(neighbors),
-        std::end(neighbors),
-        std::back_inserter(neighborIds),
-        [](const auto& agent) { return agent.id; });
+    _neighborhoodSearch.ForEachNeighbor(
+        p, distance, [&neighborIds](ConstAgentRef agent) { neighborIds.push_back(agent.id); });
     return neighborIds;
 }
 
@@ -333,15 +430,12 @@ std::vector<GenericAgent::ID> Simulation::AgentsInPolygon(const std::vector<Poin
     }
     const auto [p, dist] = poly.ContainingCircle();
 
-    const auto candidates = _neighborhoodSearch.GetNeighboringAgents(p, dist);
     std::vector<GenericAgent::ID> result{};
-    result.reserve(candidates.size());
-    std::for_each(
-        std::begin(candidates), std::end(candidates), [&result, &poly](const auto& agent) {
-            if(poly.IsInside(agent.pos)) {
-                result.push_back(agent.id);
-            }
-        });
+    _neighborhoodSearch.ForEachNeighbor(p, dist, [&result, &poly](ConstAgentRef agent) {
+        if(poly.IsInside(agent.pos)) {
+            result.push_back(agent.id);
+        }
+    });
     return result;
 }
 
@@ -362,6 +456,7 @@ CollisionGeometry Simulation::Geo() const
 void Simulation::SwitchGeometry(std::unique_ptr<CollisionGeometry>&& geometry)
 {
     ValidateGeometry(geometry);
+    _routingEngine->ClearFlowFields();
     if(const auto& iter = geometries.find(geometry->Id()); iter != std::end(geometries)) {
         _geometry = std::get<0>(iter->second).get();
         _routingEngine = std::get<1>(iter->second).get();
@@ -377,17 +472,138 @@ void Simulation::SwitchGeometry(std::unique_ptr<CollisionGeometry>&& geometry)
         _geometry = std::get<0>(tup->second).get();
         _routingEngine = std::get<1>(tup->second).get();
     }
+    _routingEngine->SetMode(_routingMode);
+    _tacticalDecisionSystem.InvalidateRoutes();
+    _neighborhoodSearch.SetBounds(AABB{std::get<0>(_geometry->AccessibleArea())});
+    _neighborhoodSearch.Update(_workerPool);
+}
+
+RoutingMode Simulation::GetRoutingMode() const
+{
+    return _routingMode;
+}
+
+void Simulation::SetRoutingMode(RoutingMode mode)
+{
+    _routingMode = mode;
+    _routingEngine->SetMode(mode);
+    _tacticalDecisionSystem.InvalidateRoutes();
+}
+
+double Simulation::NeighborListSkin() const
+{
+    return _neighborhoodSearch.NeighborListSkin();
+}
+
+void Simulation::SetNeighborListSkin(double skin)
+{
+    if(skin < 0) {
+        throw SimulationError("Neighbor list skin must not be negative, got {}", skin);
+    }
+    _neighborhoodSearch.SetNeighborLists(_operationalDecisionSystem.InteractionRange(), skin);
+}
+
+uint64_t Simulation::AgentReorderInterval() const
+{
+    return _agentReorderInterval;
+}
+
+void Simulation::SetAgentReorderInterval(uint64_t iterations)
+{
+    _agentReorderInterval = iterations;
+}
+
+void Simulation::ValidateAgentPlacement(const GenericAgent& agent) const
+{
+    if(!_geometry->InsideGeometry(agent.pos)) {
+        throw SimulationError("Agent {} not inside walkable area", agent.pos);
+    }
+    if(_journeys.count(agent.journeyId) == 0) {
+        throw SimulationError("Unknown journey id: {}", agent.journeyId);
+    }
+
+    if(!_journeys.at(agent.journeyId)->ContainsStage(agent.stageId)) {
+        throw SimulationError("Unknown stage id: {}", agent.stageId);
+    }
+
+    if(std::holds_alternative<GeneralizedCentrifugalForceModelData>(agent.model))
+        if(agent.orientation.isZeroLength()) {
+            throw SimulationError(
+                "Orientation is invalid: {}. Length should be 1.", agent.orientation);
+        }
+}
+
+void Simulation::SpawnAgents()
+{
+    const auto first = _agents.size();
+    // Agents enter in the iteration closest to their spawn time
+    const auto time = _clock.ElapsedTime() + _clock.dT() / 2;
+    for(auto& [_, stage] : _stageManager.Stages()) {
+        auto* source = dynamic_cast<Source*>(stage.get());
+        if(source == nullptr) {
+            continue;
+        }
+        for(auto due = source->CountDue(time); due > 0; --due) {
+            if(!PlaceAgent(*source)) {
+                // The area is crowded, remaining agents are retried in the next iteration
+                break;
+            }
+        }
+    }
+    if(_agents.size() > first) {
+        DecideForNewAgents(first);
+    }
+}
+
+bool Simulation::PlaceAgent(Source& source)
+{
+    auto agent = source.NextAgent();
+    for(size_t attempt = 0; attempt < Source::PlacementAttempts; ++attempt) {
+        const auto pos = source.SamplePosition();
+        if(!pos) {
+            continue;
+        }
+        agent.pos = *pos;
+        agent.target = *pos;
+        try {
+            ValidateAgentPlacement(agent);
+            _operationalDecisionSystem.ValidateAgent(agent, _neighborhoodSearch, *_geometry);
+        } catch(const SimulationError&) {
+            continue;
+        }
+        _neighborhoodSearch.AddAgent(_agents.Add(agent));
+        source.AgentSpawned();
+        return true;
+    }
+    return false;
+}
+
+void Simulation::DecideForNewAgents(size_t first)
+{
+    for(auto index = first; index < _agents.size(); ++index) {
+        _stageManager.HandleNewAgent(std::as_const(_agents)[index].stageId);
+    }
+    auto added = IteratorPair(
+        std::begin(_agents) + static_cast<std::ptrdiff_t>(first), std::end(_agents));
+    _stategicalDecisionSystem.Run(_journeys, added, _stageManager);
+    _tacticalDecisionSystem.Run(*_routingEngine, added, _workerPool);
+}
+
+void Simulation::RemoveAgentsFrom(size_t first)
+{
+    std::vector<bool> marked(_agents.size(), false);
+    std::fill(std::begin(marked) + static_cast<std::ptrdiff_t>(first), std::end(marked), true);
+    _agents.Remove(marked);
+    _neighborhoodSearch.Update(_workerPool);
 }
 
 void Simulation::ValidateGeometry(const std::unique_ptr<CollisionGeometry>& geometry) const
 {
+    const std::unordered_set<GenericAgent::ID> removedAgents(
+        std::begin(_removedAgentsInLastIteration), std::end(_removedAgentsInLastIteration));
     std::vector<GenericAgent::ID> faultyAgents;
-    for(const auto& agent : _agents) {
-        if(const auto find_iter = std::find(
-               std::begin(_removedAgentsInLastIteration),
-               std::end(_removedAgentsInLastIteration),
-               agent.id);
-           find_iter != std::end(_removedAgentsInLastIteration)) {
+    for(const auto agent : _agents) {
+        if(removedAgents.contains(agent.id)) {
             continue;
         }
 
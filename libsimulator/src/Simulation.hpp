@@ -1,16 +1,18 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentNeighborhoodSearch.hpp"
 #include "AgentRemovalSystem.hpp"
+#include "AgentStore.hpp"
 #include "CollisionGeometry.hpp"
 #include "GenericAgent.hpp"
 #include "Journey.hpp"
-#include "NeighborhoodSearch.hpp"
 #include "OperationalDecisionSystem.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
 #include "Point.hpp"
 #include "RoutingEngine.hpp"
+#include "RoutingMode.hpp"
 #include "SimulationClock.hpp"
 #include "Stage.hpp"
 #include "StageDescription.hpp"
@@ -19,11 +21,13 @@
 #include "StrategicalDesicionSystem.hpp"
 #include "TacticalDecisionSystem.hpp"
 #include "Tracing.hpp"
+#include "WorkerPool.hpp"
 
 #include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <span>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -34,26 +38,30 @@ class Simulation
     StrategicalDecisionSystem _stategicalDecisionSystem{};
     TacticalDecisionSystem _tacticalDecisionSystem{};
     OperationalDecisionSystem _operationalDecisionSystem;
-    AgentRemovalSystem<GenericAgent> _agentRemovalSystem{};
+    AgentRemovalSystem _agentRemovalSystem{};
     StageManager _stageManager{};
     StageSystem _stageSystem{};
-    NeighborhoodSearch<GenericAgent> _neighborhoodSearch{2.2};
+    AgentStore _agents{};
+    AgentNeighborhoodSearch _neighborhoodSearch;
     std::unordered_map<
         CollisionGeometry::ID,
         std::tuple<std::unique_ptr<CollisionGeometry>, std::unique_ptr<RoutingEngine>>>
         geometries{};
     RoutingEngine* _routingEngine;
+    RoutingMode _routingMode{RoutingMode::SEARCH};
+    uint64_t _agentReorderInterval{0};
     CollisionGeometry* _geometry;
-    std::vector<GenericAgent> _agents;
     std::vector<GenericAgent::ID> _removedAgentsInLastIteration;
     std::unordered_map<Journey::ID, std::unique_ptr<Journey>> _journeys;
     PerfStats _perfStats{};
+    WorkerPool _workerPool;
 
 public:
     Simulation(
         std::unique_ptr<OperationalModel>&& operationalModel,
         std::unique_ptr<CollisionGeometry>&& geometry,
-        double dT);
+        double dT,
+        size_t threadCount = 1);
     Simulation(const Simulation& other) = delete;
     Simulation& operator=(const Simulation& other) = delete;
     Simulation(Simulation&& other) = delete;
@@ -62,10 +70,14 @@ public:
     const SimulationClock& Clock() const;
     void SetTracing(bool on);
     PerfStats GetLastStats() const;
+    /// Number of threads used to compute the agent updates, including the calling thread.
+    size_t ThreadCount() const;
     void Iterate();
     Journey::ID AddJourney(const std::map<BaseStage::ID, TransitionDescription>& stages);
     BaseStage::ID AddStage(const StageDescription stageDescription);
     void MarkAgentForRemoval(GenericAgent::ID id);
+    /// Marks all agents in 'ids' for removal, nothing is marked if any of the ids is unknown.
+    void MarkAgentsForRemoval(const std::vector<GenericAgent::ID>& ids);
     const std::vector<GenericAgent::ID>& RemovedAgents() const;
     size_t AgentCount() const;
     double ElapsedTime() const;
@@ -78,14 +90,41 @@ public:
     /// @param polygon Required to be a simple convex polygon with CCW ordering.
     std::vector<GenericAgent::ID> AgentsInPolygon(const std::vector<Point>& polygon);
     GenericAgent::ID AddAgent(GenericAgent agent);
-    const GenericAgent& Agent(GenericAgent::ID id) const;
-    GenericAgent& Agent(GenericAgent::ID id);
-    std::vector<GenericAgent>& Agents();
+    /// Adds all 'agents' with the same checks as 'AddAgent', but validates them in parallel and
+    /// computes their initial routes in one batch. Agents are checked against each other as well.
+    /// If any agent is invalid none is added and the error of the first invalid agent is thrown.
+    /// @return ids of the added agents in the order of 'agents'.
+    std::vector<GenericAgent::ID> AddAgents(std::span<const GenericAgent> agents);
+    ConstAgentRef Agent(GenericAgent::ID id) const;
+    AgentRef Agent(GenericAgent::ID id);
+    AgentStore& Agents();
     OperationalModelType ModelType() const;
     StageProxy Stage(BaseStage::ID stageId);
     CollisionGeometry Geo() const;
     void SwitchGeometry(std::unique_ptr<CollisionGeometry>&& geometry);
+    RoutingMode GetRoutingMode() const;
+    void SetRoutingMode(RoutingMode mode);
+    double NeighborListSkin() const;
+    /// Enables neighbor lists for the operational model with a margin of 'skin' around its
+    /// interaction range, 0 disables them. See AgentNeighborhoodSearch.
+    void SetNeighborListSkin(double skin);
+    uint64_t AgentReorderInterval() const;
+    /// Sorts the agents along a space filling curve every 'iterations' iterations, so that agents
+    /// close to each other are stored close to each other. 0 disables reordering.
+    void SetAgentReorderInterval(uint64_t iterations);
 
 private:
     void ValidateGeometry(const std::unique_ptr<CollisionGeometry>& geometry) const;
+    /// Checks of a new agent that do not depend on other agents.
+    void ValidateAgentPlacement(const GenericAgent& agent) const;
+    /// Removes the agents at index 'first' and above, used to undo a failed 'AddAgents'.
+    void RemoveAgentsFrom(size_t first);
+    /// Places the due agents of all sources.
+    void SpawnAgents();
+    /// Places the next agent of 'source' at a free spot.
+    /// @return false if no free spot has been found.
+    bool PlaceAgent(Source& source);
+    /// Registers the agents at index 'first' and above with their stages and computes their
+    /// first targets.
+    void DecideForNewAgents(size_t first);
 };
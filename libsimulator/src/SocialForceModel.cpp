@@ -1,8 +1,8 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "SocialForceModel.hpp"
 
+#include "AgentStore.hpp"
 #include "CollisionGeometry.hpp"
-#include "GenericAgent.hpp"
 #include "LineSegment.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
@@ -31,22 +31,21 @@ std::unique_ptr<OperationalModel> SocialForceModel::Clone() const
 
 OperationalModelUpdate SocialForceModel::ComputeNewPosition(
     double dT,
-    const GenericAgent& ped,
+    ConstAgentRef ped,
     const CollisionGeometry& geometry,
     const NeighborhoodSearchType& neighborhoodSearch) const
 {
-    const auto& model = std::get<SocialForceModelData>(ped.model);
+    const auto& model = ped.model.As<SocialForceModelData>();
     SocialForceModelUpdate update{};
     auto forces = DrivingForce(ped);
 
-    const auto neighborhood = neighborhoodSearch.GetNeighboringAgents(ped.pos, this->_cutOffRadius);
     Point F_rep;
-    for(const auto& neighbor : neighborhood) {
+    neighborhoodSearch.ForEachNeighbor(ped, _cutOffRadius, [&](ConstAgentRef neighbor) {
         if(neighbor.id == ped.id) {
-            continue;
+            return;
         }
         F_rep += AgentForce(ped, neighbor);
-    }
+    });
     forces += F_rep / model.mass;
     const auto& walls = geometry.LineSegmentsInApproxDistanceTo(ped.pos);
 
@@ -65,9 +64,9 @@ OperationalModelUpdate SocialForceModel::ComputeNewPosition(
     return update;
 }
 
-void SocialForceModel::ApplyUpdate(const OperationalModelUpdate& update, GenericAgent& agent) const
+void SocialForceModel::ApplyUpdate(const OperationalModelUpdate& update, AgentRef agent) const
 {
-    auto& model = std::get<SocialForceModelData>(agent.model);
+    auto& model = agent.model.As<SocialForceModelData>();
     const auto& upd = std::get<SocialForceModelUpdate>(update);
     agent.pos = upd.position;
     model.velocity = upd.velocity;
@@ -75,7 +74,7 @@ void SocialForceModel::ApplyUpdate(const OperationalModelUpdate& update, Generic
 }
 
 void SocialForceModel::CheckModelConstraint(
-    const GenericAgent& agent,
+    ConstAgentRef agent,
     const NeighborhoodSearchType& neighborhoodSearch,
     const CollisionGeometry& geometry) const
 {
@@ -92,7 +91,7 @@ void SocialForceModel::CheckModelConstraint(
         }
     };
 
-    const auto& model = std::get<SocialForceModelData>(agent.model);
+    const auto& model = agent.model.As<SocialForceModelData>();
 
     const auto mass = model.mass;
     throwIfNegative(mass, "mass");
@@ -131,9 +130,9 @@ void SocialForceModel::CheckModelConstraint(
     }
 }
 
-Point SocialForceModel::DrivingForce(const GenericAgent& agent)
+Point SocialForceModel::DrivingForce(ConstAgentRef agent)
 {
-    const auto& model = std::get<SocialForceModelData>(agent.model);
+    const auto& model = agent.model.As<SocialForceModelData>();
     const Point e0 = (agent.destination - agent.pos).Normalized();
     return (e0 * model.desiredSpeed - model.velocity) / model.reactionTime;
 };
@@ -142,10 +141,10 @@ double SocialForceModel::PushingForceLength(double A, double B, double r, double
     return A * exp((r - distance) / B);
 }
 
-Point SocialForceModel::AgentForce(const GenericAgent& ped1, const GenericAgent& ped2) const
+Point SocialForceModel::AgentForce(ConstAgentRef ped1, ConstAgentRef ped2) const
 {
-    const auto& model1 = std::get<SocialForceModelData>(ped1.model);
-    const auto& model2 = std::get<SocialForceModelData>(ped2.model);
+    const auto& model1 = ped1.model.As<SocialForceModelData>();
+    const auto& model2 = ped2.model.As<SocialForceModelData>();
 
     const double total_radius = model1.radius + model2.radius;
 
@@ -158,9 +157,9 @@ Point SocialForceModel::AgentForce(const GenericAgent& ped1, const GenericAgent&
         model2.velocity - model1.velocity);
 };
 
-Point SocialForceModel::ObstacleForce(const GenericAgent& agent, const LineSegment& segment) const
+Point SocialForceModel::ObstacleForce(ConstAgentRef agent, const LineSegment& segment) const
 {
-    const auto& model = std::get<SocialForceModelData>(agent.model);
+    const auto& model = agent.model.As<SocialForceModelData>();
     const Point pt = segment.ShortestPoint(agent.pos);
     return ForceBetweenPoints(
         agent.pos, pt, model.obstacleScale, model.forceDistance, model.radius, model.velocity);
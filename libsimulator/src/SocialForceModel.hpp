@@ -1,21 +1,20 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentNeighborhoodSearch.hpp"
+#include "AgentStore.hpp"
 #include "CollisionGeometry.hpp"
 #include "LineSegment.hpp"
-#include "NeighborhoodSearch.hpp"
 #include "OperationalModel.hpp"
 #include "OperationalModelType.hpp"
 #include "Point.hpp"
 
 #include <memory>
 
-struct GenericAgent;
-
 class SocialForceModel : public OperationalModel
 {
 public:
-    using NeighborhoodSearchType = NeighborhoodSearch<GenericAgent>;
+    using NeighborhoodSearchType = AgentNeighborhoodSearch;
 
 private:
     double _cutOffRadius{2.5};
@@ -26,14 +25,15 @@ public:
     SocialForceModel(double bodyForce_, double friction_);
     ~SocialForceModel() override = default;
     OperationalModelType Type() const override;
+    double InteractionRange() const override { return _cutOffRadius; }
     OperationalModelUpdate ComputeNewPosition(
         double dT,
-        const GenericAgent& ped,
+        ConstAgentRef ped,
         const CollisionGeometry& geometry,
         const NeighborhoodSearchType& neighborhoodSearch) const override;
-    void ApplyUpdate(const OperationalModelUpdate& update, GenericAgent& agent) const override;
+    void ApplyUpdate(const OperationalModelUpdate& update, AgentRef agent) const override;
     void CheckModelConstraint(
-        const GenericAgent& agent,
+        ConstAgentRef agent,
         const NeighborhoodSearchType& neighborhoodSearch,
         const CollisionGeometry& geometry) const override;
     std::unique_ptr<OperationalModel> Clone() const override;
@@ -45,21 +45,21 @@ private:
      *
      * @return vector with driving force of pedestrian
      */
-    static Point DrivingForce(const GenericAgent& agent);
+    static Point DrivingForce(ConstAgentRef agent);
     /**
      *  Repulsive force acting on pedestrian <ped1> from pedestrian <ped2>
      * @param ped1 reference to Pedestrian 1 on whom the force acts on
      * @param ped2 reference to Pedestrian 2, from whom the force originates
      * @return vector with the repulsive force
      */
-    Point AgentForce(const GenericAgent& ped1, const GenericAgent& ped2) const;
+    Point AgentForce(ConstAgentRef ped1, ConstAgentRef ped2) const;
     /**
      *  Repulsive force acting on pedestrian <agent> from line segment <segment>
      * @param agent reference to the Pedestrian on whom the force acts on
      * @param segment reference to line segment, from which the force originates
      * @return vector with the repulsive force
      */
-    Point ObstacleForce(const GenericAgent& agent, const LineSegment& segment) const;
+    Point ObstacleForce(ConstAgentRef agent, const LineSegment& segment) const;
     /**
      * calculates the pushing and friction forces acting between <pt1> and <pt2>
      * @param pt1 Point on which the forces act
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "SpaceFillingCurve.hpp"
+
+#include "AABB.hpp"
+#include "Point.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace
+{
+/// Spreads the lower 16 bit of 'value' to the even bits of the result.
+uint32_t spreadBits(uint32_t value)
+{
+    value &= 0x0000ffffu;
+    value = (value | (value << 8)) & 0x00ff00ffu;
+    value = (value | (value << 4)) & 0x0f0f0f0fu;
+    value = (value | (value << 2)) & 0x33333333u;
+    value = (value | (value << 1)) & 0x55555555u;
+    return value;
+}
+
+uint32_t quantize(double value, double min, double max)
+{
+    constexpr double steps = 0xffff;
+    if(max <= min) {
+        return 0;
+    }
+    const auto relative = std::clamp((value - min) / (max - min), 0.0, 1.0);
+    return static_cast<uint32_t>(relative * steps);
+}
+} // namespace
+
+uint32_t MortonCode(Point pos, const AABB& bounds)
+{
+    const auto x = quantize(pos.x, bounds.xmin, bounds.xmax);
+    const auto y = quantize(pos.y, bounds.ymin, bounds.ymax);
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+std::vector<size_t> MortonOrder(const std::vector<Point>& positions)
+{
+    if(positions.empty()) {
+        return {};
+    }
+    const AABB bounds{positions};
+    std::vector<std::pair<uint32_t, size_t>> codes{};
+    codes.reserve(positions.size());
+    for(size_t index = 0; index < positions.size(); ++index) {
+        codes.emplace_back(MortonCode(positions[index], bounds), index);
+    }
+    std::sort(std::begin(codes), std::end(codes));
+
+    std::vector<size_t> order{};
+    order.reserve(codes.size());
+    for(const auto& [code, index] : codes) {
+        order.push_back(index);
+    }
+    return order;
+}
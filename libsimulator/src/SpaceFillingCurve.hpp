@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "AABB.hpp"
+#include "Point.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Position of 'pos' on a Morton (Z-order) curve covering 'bounds'.
+///
+/// Each axis is quantized to 16 bit, the bits of both axes are interleaved. Positions close to
+/// each other mostly get close codes. Positions outside of 'bounds' are clamped to it.
+uint32_t MortonCode(Point pos, const AABB& bounds);
+
+/// Indices of 'positions' sorted by their Morton code within the bounding box of all positions.
+/// Equal codes are ordered by index, so the result is deterministic.
+std::vector<size_t> MortonOrder(const std::vector<Point>& positions);
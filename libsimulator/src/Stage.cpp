@@ -1,17 +1,24 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "Stage.hpp"
 
+#include "AgentStore.hpp"
 #include "GenericAgent.hpp"
 #include "Point.hpp"
 #include "Polygon.hpp"
 #include "Simulation.hpp"
 #include "SimulationError.hpp"
+#include "StageDescription.hpp"
 #include "Util.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <iterator>
 #include <list>
+#include <optional>
+#include <random>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -48,6 +55,16 @@ void NotifiableQueueProxy::Pop(size_t count)
     return concreteStage->Pop(count);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// SourceProxy
+////////////////////////////////////////////////////////////////////////////////
+size_t SourceProxy::CountSpawned() const
+{
+    const auto concreteStage = dynamic_cast<const Source*>(stage);
+    assert(stage);
+    return concreteStage->CountSpawned();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// NotifiableWaitingSetProxy
 ////////////////////////////////////////////////////////////////////////////////
@@ -86,13 +103,13 @@ Waypoint::Waypoint(Point position_, double distance_) : position(position_), dis
 {
 }
 
-bool Waypoint::IsCompleted(const GenericAgent& agent)
+bool Waypoint::IsCompleted(ConstAgentRef agent)
 {
     const auto actual_distance = (agent.pos - position).Norm();
     return actual_distance <= distance;
 }
 
-Point Waypoint::Target(const GenericAgent&)
+Point Waypoint::Target(ConstAgentRef)
 {
     return position;
 }
@@ -113,7 +130,7 @@ Exit::Exit(Polygon area_, std::vector<GenericAgent::ID>& toRemove_)
     }
 }
 
-bool Exit::IsCompleted(const GenericAgent& agent)
+bool Exit::IsCompleted(ConstAgentRef agent)
 {
     const bool hasReachedExit = area.IsInside(agent.pos);
     if(hasReachedExit) {
@@ -122,7 +139,7 @@ bool Exit::IsCompleted(const GenericAgent& agent)
     return hasReachedExit;
 }
 
-Point Exit::Target(const GenericAgent&)
+Point Exit::Target(ConstAgentRef)
 {
     return area.Centroid();
 }
@@ -140,7 +157,7 @@ NotifiableWaitingSet::NotifiableWaitingSet(std::vector<Point> slots_) : slots(st
     occupants.reserve(slots.size());
 }
 
-bool NotifiableWaitingSet::IsCompleted(const GenericAgent& agent)
+bool NotifiableWaitingSet::IsCompleted(ConstAgentRef agent)
 {
     if(state == WaitingSetState::Active) {
         return false;
@@ -153,7 +170,7 @@ bool NotifiableWaitingSet::IsCompleted(const GenericAgent& agent)
     return distance <= 1;
 }
 
-Point NotifiableWaitingSet::Target(const GenericAgent& agent)
+Point NotifiableWaitingSet::Target(ConstAgentRef agent)
 {
     if(state == WaitingSetState::Inactive) {
         return slots[0];
@@ -203,7 +220,7 @@ NotifiableQueue::NotifiableQueue(std::vector<Point> slots_) : slots(std::move(sl
 {
 }
 
-bool NotifiableQueue::IsCompleted(const GenericAgent& agent)
+bool NotifiableQueue::IsCompleted(ConstAgentRef agent)
 {
     const bool completed = exitingThisUpdate.contains(agent.id);
     if(completed) {
@@ -212,7 +229,7 @@ bool NotifiableQueue::IsCompleted(const GenericAgent& agent)
     return completed;
 }
 
-Point NotifiableQueue::Target(const GenericAgent& agent)
+Point NotifiableQueue::Target(ConstAgentRef agent)
 {
 
     if(const auto index_opt = IndexInContainer(occupants, agent.id); index_opt) {
@@ -243,3 +260,71 @@ const std::vector<GenericAgent::ID>& NotifiableQueue::Occupants() const
 {
     return occupants;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+/// Source
+////////////////////////////////////////////////////////////////////////////////
+Source::Source(const SourceDescription& description)
+    : area(description.area)
+    , rate(description.rate)
+    , spawnTimes(description.spawnTimes)
+    , maxCount(description.maxCount)
+    , journeyId(description.journeyId)
+    , stageId(description.stageId)
+    , orientation(
+          description.orientation.isZeroLength() ? description.orientation
+                                                 : description.orientation.Normalized())
+    , model(description.model)
+    , gen(description.seed)
+{
+    if(spawnTimes.empty() && !(rate > 0)) {
+        throw SimulationError("Source requires a positive rate or spawn times, got rate {}", rate);
+    }
+    if(std::any_of(
+           std::begin(spawnTimes), std::end(spawnTimes), [](double t) { return t < 0; })) {
+        throw SimulationError("Source spawn times may not be negative");
+    }
+    std::sort(std::begin(spawnTimes), std::end(spawnTimes));
+    std::tie(areaMin, areaMax) = area.BoundingBox();
+}
+
+StageProxy Source::Proxy(Simulation* simulation)
+{
+    return SourceProxy(simulation, this);
+}
+
+size_t Source::CountDue(double time) const
+{
+    if(!spawnTimes.empty()) {
+        const auto due = std::distance(
+            std::begin(spawnTimes),
+            std::lower_bound(std::begin(spawnTimes), std::end(spawnTimes), time));
+        return static_cast<size_t>(due) - spawned;
+    }
+    // Agent i enters at i / rate
+    auto due = static_cast<size_t>(std::ceil(time * rate));
+    if(maxCount > 0) {
+        due = std::min(due, maxCount);
+    }
+    return due - std::min(due, spawned);
+}
+
+GenericAgent Source::NextAgent() const
+{
+    return GenericAgent(
+        GenericAgent::ID{}, journeyId, stageId, area.Centroid(), orientation, model);
+}
+
+std::optional<Point> Source::SamplePosition()
+{
+    std::uniform_real_distribution<double> x{areaMin.x, areaMax.x};
+    std::uniform_real_distribution<double> y{areaMin.y, areaMax.y};
+    // Rejection sampling, only very thin areas cover a small part of their bounding box
+    for(size_t attempt = 0; attempt < SamplingAttempts; ++attempt) {
+        const Point candidate{x(gen), y(gen)};
+        if(area.IsInside(candidate)) {
+            return candidate;
+        }
+    }
+    return std::nullopt;
+}
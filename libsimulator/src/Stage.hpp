@@ -1,13 +1,12 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentStore.hpp"
 #include "CollisionGeometry.hpp"
 #include "GenericAgent.hpp"
-#include "GeometricFunctions.hpp"
-#include "LineSegment.hpp"
-#include "NeighborhoodSearch.hpp"
 #include "Point.hpp"
 #include "Polygon.hpp"
+#include "StageDescription.hpp"
 #include "UniqueID.hpp"
 #include "Util.hpp"
 
@@ -18,6 +17,8 @@
 #include <cstddef>
 #include <iterator>
 #include <limits>
+#include <optional>
+#include <random>
 #include <set>
 #include <unordered_set>
 #include <variant>
@@ -93,12 +94,21 @@ public:
     }
 };
 
+class SourceProxy : public BaseProxy
+{
+public:
+    SourceProxy(Simulation* simulation_, BaseStage* stage_) : BaseProxy(simulation_, stage_) {}
+
+    size_t CountSpawned() const;
+};
+
 using StageProxy = std::variant<
     WaypointProxy,
     NotifiableWaitingSetProxy,
     NotifiableQueueProxy,
     ExitProxy,
-    DirectSteeringProxy>;
+    DirectSteeringProxy,
+    SourceProxy>;
 
 class BaseStage
 {
@@ -111,16 +121,16 @@ protected:
 
 public:
     virtual ~BaseStage() = default;
-    virtual bool IsCompleted(const GenericAgent& agent) = 0;
-    virtual Point Target(const GenericAgent& agent) = 0;
+    virtual bool IsCompleted(ConstAgentRef agent) = 0;
+    virtual Point Target(ConstAgentRef agent) = 0;
     virtual StageProxy Proxy(Simulation* simulation_) = 0;
     ID Id() const { return id; }
     size_t CountTargeting() const { return targeting; }
     void IncreaseTargeting() { targeting = targeting + 1; }
-    void DecreaseTargeting()
+    void DecreaseTargeting(size_t count = 1)
     {
-        assert(targeting >= 1);
-        targeting = targeting - 1;
+        assert(targeting >= count);
+        targeting = targeting - count;
     }
 };
 
@@ -144,8 +154,8 @@ class Waypoint : public BaseStage
 public:
     Waypoint(Point position_, double distance_);
     ~Waypoint() override = default;
-    bool IsCompleted(const GenericAgent& agent) override;
-    Point Target(const GenericAgent& agent) override;
+    bool IsCompleted(ConstAgentRef agent) override;
+    Point Target(ConstAgentRef agent) override;
     StageProxy Proxy(Simulation* simulation_) override;
     Point Position() const { return position; };
 };
@@ -159,8 +169,8 @@ class Exit : public BaseStage
 public:
     Exit(Polygon area, std::vector<GenericAgent::ID>& toRemove_);
     ~Exit() override = default;
-    bool IsCompleted(const GenericAgent& agent) override;
-    Point Target(const GenericAgent& agent) override;
+    bool IsCompleted(ConstAgentRef agent) override;
+    Point Target(ConstAgentRef agent) override;
     StageProxy Proxy(Simulation* simulation_) override;
     Polygon Position() const { return area; };
 };
@@ -174,20 +184,21 @@ class NotifiableWaitingSet : public BaseStage
 public:
     NotifiableWaitingSet(std::vector<Point> slots_);
     ~NotifiableWaitingSet() override = default;
-    bool IsCompleted(const GenericAgent& agent) override;
-    Point Target(const GenericAgent& agent) override;
+    bool IsCompleted(ConstAgentRef agent) override;
+    Point Target(ConstAgentRef agent) override;
     StageProxy Proxy(Simulation* simulation_) override;
     void State(WaitingSetState s);
     WaitingSetState State() const;
-    template <typename T>
-    void Update(const NeighborhoodSearch<T>& neighborhoodSearch, const CollisionGeometry& geometry);
+    template <typename NeighborhoodSearchType>
+    void
+    Update(const NeighborhoodSearchType& neighborhoodSearch, const CollisionGeometry& geometry);
     const std::vector<GenericAgent::ID>& Occupants() const;
     const std::vector<Point>& Slots() const { return slots; };
 };
 
-template <typename T>
+template <typename NeighborhoodSearchType>
 void NotifiableWaitingSet::Update(
-    const NeighborhoodSearch<T>& neighborhoodSearch,
+    const NeighborhoodSearchType& neighborhoodSearch,
     const CollisionGeometry& geometry)
 {
     if(state == WaitingSetState::Inactive) {
@@ -200,26 +211,8 @@ void NotifiableWaitingSet::Update(
 
     for(size_t index = count_occupants; index < slots.size(); ++index) {
         const auto slot_pos = slots[index];
-        const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(slot_pos);
-        auto candidates = neighborhoodSearch.GetNeighboringAgents(slot_pos, 2);
-        candidates.erase(
-            std::remove_if(
-                std::begin(candidates),
-                std::end(candidates),
-                [&slot_pos, &boundary](const auto& neighbor) {
-                    const auto agent_to_neighbor = LineSegment(slot_pos, neighbor.pos);
-                    if(std::find_if(
-                           boundary.cbegin(),
-                           boundary.cend(),
-                           [&agent_to_neighbor](const auto& boundary_segment) {
-                               return intersects(agent_to_neighbor, boundary_segment);
-                           }) != boundary.end()) {
-                        return true;
-                    }
-
-                    return false;
-                }),
-            std::end(candidates));
+        // Agents obstructed by the geometry do not occupy the slot
+        const auto candidates = neighborhoodSearch.VisibleNeighbors(slot_pos, 2, geometry);
 
         GenericAgent::ID occupant = GenericAgent::ID::Invalid;
         double min_distance = std::numeric_limits<double>::max();
@@ -254,19 +247,20 @@ private:
 public:
     NotifiableQueue(std::vector<Point> slots_);
     ~NotifiableQueue() override = default;
-    bool IsCompleted(const GenericAgent& agent) override;
-    Point Target(const GenericAgent& agent) override;
+    bool IsCompleted(ConstAgentRef agent) override;
+    Point Target(ConstAgentRef agent) override;
     StageProxy Proxy(Simulation* simulation_) override;
-    template <typename T>
-    void Update(const NeighborhoodSearch<T>& neighborhoodSearch, const CollisionGeometry& geometry);
+    template <typename NeighborhoodSearchType>
+    void
+    Update(const NeighborhoodSearchType& neighborhoodSearch, const CollisionGeometry& geometry);
     void Pop(size_t count);
     const std::vector<GenericAgent::ID>& Occupants() const;
     const std::vector<Point>& Slots() const { return slots; };
 };
 
-template <typename T>
+template <typename NeighborhoodSearchType>
 void NotifiableQueue::Update(
-    const NeighborhoodSearch<T>& neighborhoodSearch,
+    const NeighborhoodSearchType& neighborhoodSearch,
     const CollisionGeometry& geometry)
 {
     const auto count_occupants = occupants.size();
@@ -276,26 +270,8 @@ void NotifiableQueue::Update(
 
     for(size_t index = count_occupants; index < slots.size(); ++index) {
         const auto slot_pos = slots[index];
-        const auto& boundary = geometry.LineSegmentsInApproxDistanceTo(slot_pos);
-        auto candidates = neighborhoodSearch.GetNeighboringAgents(slot_pos, 2);
-        candidates.erase(
-            std::remove_if(
-                std::begin(candidates),
-                std::end(candidates),
-                [&slot_pos, &boundary](const auto& neighbor) {
-                    const auto agent_to_neighbor = LineSegment(slot_pos, neighbor.pos);
-                    if(std::find_if(
-                           boundary.cbegin(),
-                           boundary.cend(),
-                           [&agent_to_neighbor](const auto& boundary_segment) {
-                               return intersects(agent_to_neighbor, boundary_segment);
-                           }) != boundary.end()) {
-                        return true;
-                    }
-
-                    return false;
-                }),
-            std::end(candidates));
+        // Agents obstructed by the geometry do not occupy the slot
+        const auto candidates = neighborhoodSearch.VisibleNeighbors(slot_pos, 2, geometry);
 
         GenericAgent::ID occupant = GenericAgent::ID::Invalid;
         double min_distance = std::numeric_limits<double>::max();
@@ -323,10 +299,58 @@ class DirectSteering : public BaseStage
 public:
     DirectSteering() = default;
     ~DirectSteering() override = default;
-    bool IsCompleted(const GenericAgent&) override { return false; };
-    Point Target(const GenericAgent& agent) override { return agent.target; };
+    bool IsCompleted(ConstAgentRef) override { return false; };
+    Point Target(ConstAgentRef agent) override { return agent.target; };
     StageProxy Proxy(Simulation* simulation) override
     {
         return DirectSteeringProxy(simulation, this);
     };
 };
+
+/// Creates agents inside an area, at a constant rate or at given times.
+///
+/// A source is not part of any journey, new agents start with the journey and stage given in
+/// the description. The simulation places due agents at the beginning of each iteration at random
+/// positions inside the area. Agents that find no free spot stay due and are placed as soon as
+/// there is room, so a blocked source delays agents instead of dropping them.
+class Source : public BaseStage
+{
+public:
+    /// Random positions tried per agent and iteration before giving up for this iteration.
+    static constexpr size_t PlacementAttempts{20};
+    /// Random points of the bounding box tried per sampled position before giving up, only
+    /// points inside the area are used as positions.
+    static constexpr size_t SamplingAttempts{100};
+
+private:
+    Polygon area;
+    Point areaMin;
+    Point areaMax;
+    double rate;
+    std::vector<double> spawnTimes;
+    size_t maxCount;
+    jps::UniqueID<Journey> journeyId;
+    jps::UniqueID<BaseStage> stageId;
+    Point orientation;
+    GenericAgent::Model model;
+    std::mt19937_64 gen;
+    size_t spawned{0};
+
+public:
+    explicit Source(const SourceDescription& description);
+    ~Source() override = default;
+    // Sources are never targeted, agents leave them right after being created
+    bool IsCompleted(ConstAgentRef) override { return true; };
+    Point Target(ConstAgentRef) override { return area.Centroid(); };
+    StageProxy Proxy(Simulation* simulation) override;
+
+    /// Number of agents that should have entered before 'time' but have not been placed yet.
+    size_t CountDue(double time) const;
+    size_t CountSpawned() const { return spawned; }
+    /// New agent without a position, only its id needs to be unique.
+    GenericAgent NextAgent() const;
+    /// Uniformly distributed random position inside the area, none if sampling failed.
+    std::optional<Point> SamplePosition();
+    /// Records that the agent returned by 'NextAgent' has been placed.
+    void AgentSpawned() { ++spawned; }
+};
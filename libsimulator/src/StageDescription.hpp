@@ -1,12 +1,19 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "GenericAgent.hpp"
 #include "Point.hpp"
 #include "Polygon.hpp"
+#include "UniqueID.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <variant>
 #include <vector>
 
+class BaseStage;
+class Journey;
+
 struct DirectSteeringDescription {
 };
 
@@ -27,9 +34,30 @@ struct NotifiableQueueDescription {
     std::vector<Point> slots;
 };
 
+/// Agents entering the simulation inside 'area', either at a constant 'rate' or at the times
+/// listed in 'spawnTimes'.
+struct SourceDescription {
+    Polygon area;
+    /// Agents per second, only used if 'spawnTimes' is empty.
+    double rate;
+    /// Times in seconds at which one agent each enters the simulation.
+    std::vector<double> spawnTimes;
+    /// Number of agents entering at 'rate', 0 for no limit.
+    size_t maxCount;
+    /// Journey and stage the new agents start with.
+    jps::UniqueID<Journey> journeyId;
+    jps::UniqueID<BaseStage> stageId;
+    Point orientation;
+    /// Model parameters of the new agents.
+    GenericAgent::Model model;
+    /// Seed of the random placement inside 'area'.
+    uint64_t seed;
+};
+
 using StageDescription = std::variant<
     DirectSteeringDescription,
     WaypointDescription,
     ExitDescription,
     NotifiableWaitingSetDescription,
-    NotifiableQueueDescription>;
+    NotifiableQueueDescription,
+    SourceDescription>;
@@ -47,6 +47,9 @@ public:
                 },
                 [](const DirectSteeringDescription&) -> std::unique_ptr<BaseStage> {
                     return std::make_unique<DirectSteering>();
+                },
+                [](const SourceDescription& d) -> std::unique_ptr<BaseStage> {
+                    return std::make_unique<Source>(d);
                 }},
             stageDescription);
         if(stages.find(stage->Id()) != stages.end()) {
@@ -66,6 +69,13 @@ public:
 
     void HandleNewAgent(BaseStage::ID stageId) { stages.at(stageId)->IncreaseTargeting(); }
     void HandleRemoveAgent(BaseStage::ID stageId) { stages.at(stageId)->DecreaseTargeting(); }
+    /// Removes 'count' agents from each stage in 'removedAgents'.
+    void HandleRemoveAgents(const std::unordered_map<BaseStage::ID, size_t>& removedAgents)
+    {
+        for(const auto& [stageId, count] : removedAgents) {
+            stages.at(stageId)->DecreaseTargeting(count);
+        }
+    }
 
     BaseStage* Stage(BaseStage::ID stageId) const
     {
@@ -1,9 +1,8 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "AgentNeighborhoodSearch.hpp"
 #include "CollisionGeometry.hpp"
-#include "GenericAgent.hpp"
-#include "NeighborhoodSearch.hpp"
 #include "Stage.hpp"
 #include "StageManager.hpp"
 
@@ -20,7 +19,7 @@ public:
 
     void
     Run(StageManager& stageManager,
-        const NeighborhoodSearch<GenericAgent>& neighborhoodSearch,
+        const AgentNeighborhoodSearch& neighborhoodSearch,
         const CollisionGeometry& geometry)
     {
         for(auto& [_, stage] : stageManager.Stages()) {
@@ -22,7 +22,8 @@ public:
         auto&& agents,
         StageManager& stageManager) const
     {
-        for(auto& agent : agents) {
+        // Agents are references into the store, hence taken by value
+        for(auto agent : agents) {
             const auto [target, id] = journeys.at(agent.journeyId)->Target(agent);
             agent.target = target;
             stageManager.MigrateAgent(agent.stageId, id);
@@ -1,10 +1,30 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #pragma once
 
+#include "GenericAgent.hpp"
 #include "RoutingEngine.hpp"
+#include "SimulationError.hpp"
+#include "WorkerPool.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+/// Number of lookups in the route cache of the TacticalDecisionSystem during one 'Run'.
+struct RouteCacheStatistics {
+    uint64_t hits{};
+    uint64_t misses{};
+};
 
 class TacticalDecisionSystem
 {
+    /// Last route computed per agent. Routes are reused as long as the agent stays in the
+    /// corridor of its route and the target does not change.
+    std::unordered_map<GenericAgent::ID, Route> _routes{};
+
 public:
     TacticalDecisionSystem() = default;
     ~TacticalDecisionSystem() = default;
@@ -13,11 +33,59 @@ public:
     TacticalDecisionSystem(TacticalDecisionSystem&& other) = delete;
     TacticalDecisionSystem& operator=(TacticalDecisionSystem&& other) = delete;
 
-    void Run(RoutingEngine& routingEngine, auto&& agents) const
+    /// Computes the next waypoint for all agents. Each agent only depends on its own state, so
+    /// the route queries are distributed on 'pool'.
+    RouteCacheStatistics Run(const RoutingEngine& routingEngine, auto&& agents, WorkerPool& pool)
+    {
+        // Insert missing entries up front so that the map is not modified while running in
+        // parallel.
+        for(const auto agent : agents) {
+            _routes.try_emplace(agent.id);
+        }
+
+        std::atomic<uint64_t> hits{};
+        std::atomic<uint64_t> misses{};
+        const auto first = std::begin(agents);
+        pool.ParallelFor(std::size(agents), [&](size_t begin, size_t end) {
+            uint64_t localHits{};
+            uint64_t localMisses{};
+            for(auto index = begin; index < end; ++index) {
+                auto agent = first[index];
+                auto& route = _routes.find(agent.id)->second;
+                if(!route.corridor.empty() && route.destination == agent.target &&
+                   routingEngine.UpdateRoute(route, agent.pos)) {
+                    ++localHits;
+                } else {
+                    // The polygon of the previous route is usually close to the agent
+                    try {
+                        route = routingEngine.ComputeRoute(
+                            agent.pos, agent.target, route.CurrentPolygon());
+                    } catch(const SimulationError& error) {
+                        throw SimulationError(
+                            "Agent {} cannot be routed to its target ({}, {}): {}",
+                            agent.id,
+                            agent.target.x,
+                            agent.target.y,
+                            error.what());
+                    }
+                    ++localMisses;
+                }
+                agent.destination = route.waypoints[1];
+            }
+            hits += localHits;
+            misses += localMisses;
+        });
+        return {hits, misses};
+    }
+
+    /// Drops the cached routes of the given agents.
+    void RemoveAgents(const std::vector<GenericAgent::ID>& ids)
     {
-        for(auto& agent : agents) {
-            const auto dest = agent.target;
-            agent.destination = routingEngine.ComputeWaypoint(agent.pos, dest);
+        for(const auto id : ids) {
+            _routes.erase(id);
         }
     }
+
+    /// Drops all cached routes, needs to be called when the routing engine changes.
+    void InvalidateRoutes() { _routes.clear(); }
 };
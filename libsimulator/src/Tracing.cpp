@@ -29,3 +29,11 @@ std::optional<Trace> PerfStats::TraceOperationalDecisionSystemRun()
 {
     return trace(op_dec_system_run_duration);
 }
+
+void PerfStats::RecordRouteCacheLookups(uint64_t hits, uint64_t misses)
+{
+    if(enabled) {
+        route_cache_hits = hits;
+        route_cache_misses = misses;
+    }
+}
@@ -27,6 +27,8 @@ class PerfStats
 {
     uint64_t iterate_duration{};
     uint64_t op_dec_system_run_duration{};
+    uint64_t route_cache_hits{};
+    uint64_t route_cache_misses{};
     bool enabled{false};
 
 public:
@@ -35,6 +37,9 @@ public:
     void SetEnabled(bool status) { enabled = status; };
     uint64_t IterationDuration() const { return iterate_duration; };
     uint64_t OpDecSystemRunDuration() const { return op_dec_system_run_duration; };
+    void RecordRouteCacheLookups(uint64_t hits, uint64_t misses);
+    uint64_t RouteCacheHits() const { return route_cache_hits; };
+    uint64_t RouteCacheMisses() const { return route_cache_misses; };
 
 private:
     std::optional<Trace> trace(uint64_t& v);
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+/// Number of chunks handed out per thread. More chunks than threads balance out agents with
+/// differing amounts of work, e.g. agents in crowded areas.
+static constexpr size_t chunksPerThread = 4;
+
+WorkerPool::WorkerPool(size_t threadCount)
+{
+    const auto additionalThreads = std::max<size_t>(threadCount, 1) - 1;
+    _threads.reserve(additionalThreads);
+    for(size_t index = 0; index < additionalThreads; ++index) {
+        _threads.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _shutdown = true;
+    }
+    _workAvailable.notify_all();
+    for(auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::ParallelFor(size_t count, const Task& task)
+{
+    if(count == 0) {
+        return;
+    }
+    if(_threads.empty() || count == 1) {
+        task(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard lock(_mutex);
+        _task = &task;
+        _count = count;
+        _chunkCount = std::min(count, ThreadCount() * chunksPerThread);
+        _nextChunk = 0;
+        _busyWorkers = _threads.size();
+        _error = nullptr;
+        ++_generation;
+    }
+    _workAvailable.notify_all();
+
+    ProcessChunks();
+
+    std::unique_lock lock(_mutex);
+    _workDone.wait(lock, [this]() { return _busyWorkers == 0; });
+    _task = nullptr;
+    if(_error) {
+        std::rethrow_exception(std::exchange(_error, nullptr));
+    }
+}
+
+void WorkerPool::WorkerLoop()
+{
+    uint64_t processedGeneration = 0;
+    while(true) {
+        {
+            std::unique_lock lock(_mutex);
+            _workAvailable.wait(
+                lock, [&]() { return _shutdown || _generation != processedGeneration; });
+            if(_shutdown) {
+                return;
+            }
+            processedGeneration = _generation;
+        }
+
+        ProcessChunks();
+
+        {
+            std::lock_guard lock(_mutex);
+            --_busyWorkers;
+        }
+        _workDone.notify_one();
+    }
+}
+
+void WorkerPool::ProcessChunks()
+{
+    while(true) {
+        const auto chunk = _nextChunk.fetch_add(1);
+        if(chunk >= _chunkCount) {
+            return;
+        }
+        const auto begin = _count * chunk / _chunkCount;
+        const auto end = _count * (chunk + 1) / _chunkCount;
+        try {
+            (*_task)(begin, end);
+        } catch(...) {
+            std::lock_guard lock(_mutex);
+            if(!_error) {
+                _error = std::current_exception();
+            }
+        }
+    }
+}
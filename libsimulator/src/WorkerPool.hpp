@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Fixed size pool of worker threads used to distribute per agent work of the simulation systems.
+///
+/// The calling thread always takes part in the work, so a pool created with a thread count of 1
+/// does not start any additional thread and runs everything inline.
+///
+/// Work is handed out as contiguous index ranges. The caller is responsible for making each index
+/// independent of all others, e.g. by only writing to storage owned by that index. Under this
+/// contract the result of a 'ParallelFor' does not depend on the number of threads used.
+///
+/// Thread Safety: 'ParallelFor' must not be called concurrently or from within a running task.
+class WorkerPool
+{
+public:
+    using Task = std::function<void(size_t begin, size_t end)>;
+
+private:
+    std::vector<std::thread> _threads{};
+    std::mutex _mutex{};
+    std::condition_variable _workAvailable{};
+    std::condition_variable _workDone{};
+    const Task* _task{nullptr};
+    size_t _count{};
+    size_t _chunkCount{};
+    std::atomic<size_t> _nextChunk{};
+    size_t _busyWorkers{};
+    uint64_t _generation{};
+    bool _shutdown{false};
+    std::exception_ptr _error{};
+
+public:
+    /// Creates a pool that will use 'threadCount' threads including the calling thread.
+    /// @param threadCount number of threads, values < 1 are treated as 1.
+    explicit WorkerPool(size_t threadCount = 1);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool& other) = delete;
+    WorkerPool& operator=(const WorkerPool& other) = delete;
+    WorkerPool(WorkerPool&& other) = delete;
+    WorkerPool& operator=(WorkerPool&& other) = delete;
+
+    /// Number of threads work is distributed on, including the calling thread.
+    size_t ThreadCount() const { return _threads.size() + 1; }
+
+    /// Calls 'task' with disjoint ranges [begin, end) covering [0, count). Returns once all ranges
+    /// have been processed. If any invocation throws, the first exception caught is rethrown
+    /// after all ranges have been processed.
+    void ParallelFor(size_t count, const Task& task);
+
+private:
+    void WorkerLoop();
+    void ProcessChunks();
+};
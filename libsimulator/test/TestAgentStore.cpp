@@ -0,0 +1,339 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AABB.hpp"
+#include "AgentNeighborhoodSearch.hpp"
+#include "AgentStore.hpp"
+#include "GenericAgent.hpp"
+#include "SimulationError.hpp"
+#include "WorkerPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+static GenericAgent make_agent(Point pos, double radius = 0.2)
+{
+    CollisionFreeSpeedModelData model{};
+    model.radius = radius;
+    return GenericAgent(
+        GenericAgent::ID{},
+        jps::UniqueID<Journey>::Invalid,
+        jps::UniqueID<BaseStage>::Invalid,
+        pos,
+        Point{1.0, 0.0},
+        model);
+}
+
+TEST(AgentStore, AddedAgentsAreAccessibleByIndexAndId)
+{
+    AgentStore store{};
+    const auto first = make_agent({1, 2}, 0.1);
+    const auto second = make_agent({3, 4}, 0.3);
+    ASSERT_EQ(store.Add(first), 0);
+    ASSERT_EQ(store.Add(second), 1);
+
+    ASSERT_EQ(store.size(), 2);
+    ASSERT_EQ(store.IndexOf(second.id), 1);
+    ASSERT_TRUE(store.Contains(first.id));
+
+    const auto agent = store[store.IndexOf(second.id)];
+    ASSERT_EQ(agent.id, second.id);
+    ASSERT_EQ(agent.pos, Point(3, 4));
+    ASSERT_DOUBLE_EQ(agent.model.As<CollisionFreeSpeedModelData>().radius, 0.3);
+}
+
+TEST(AgentStore, ChangesThroughReferencesAreStored)
+{
+    AgentStore store{};
+    const auto index = store.Add(make_agent({1, 2}));
+    auto agent = store[index];
+    agent.pos = Point{5, 6};
+    agent.model.As<CollisionFreeSpeedModelData>().v0 = 2.5;
+
+    ASSERT_EQ(store.Positions()[index], Point(5, 6));
+    ASSERT_DOUBLE_EQ(std::as_const(store)[index].model.As<CollisionFreeSpeedModelData>().v0, 2.5);
+}
+
+TEST(AgentStore, RejectsAgentsOfDifferentModels)
+{
+    AgentStore store{};
+    store.Add(make_agent({1, 2}));
+    const GenericAgent other(
+        GenericAgent::ID{},
+        jps::UniqueID<Journey>::Invalid,
+        jps::UniqueID<BaseStage>::Invalid,
+        Point{0, 0},
+        Point{1, 0},
+        SocialForceModelData{});
+    ASSERT_THROW(store.Add(other), SimulationError);
+    ASSERT_EQ(store.size(), 1);
+}
+
+TEST(AgentStore, RemoveKeepsOrderAndUpdatesIndices)
+{
+    AgentStore store{};
+    std::vector<GenericAgent::ID> ids{};
+    for(int index = 0; index < 5; ++index) {
+        const auto agent = make_agent({static_cast<double>(index), 0});
+        ids.push_back(agent.id);
+        store.Add(agent);
+    }
+
+    store.RemoveIf(
+        [&ids](ConstAgentRef agent) { return agent.id == ids[1] || agent.id == ids[3]; });
+
+    ASSERT_EQ(store.size(), 3);
+    ASSERT_FALSE(store.Contains(ids[1]));
+    ASSERT_EQ(store.IndexOf(ids[3]), AgentStore::InvalidIndex);
+    const std::vector<GenericAgent::ID> expected{ids[0], ids[2], ids[4]};
+    ASSERT_EQ(store.Ids(), expected);
+    for(size_t index = 0; index < expected.size(); ++index) {
+        ASSERT_EQ(store.IndexOf(expected[index]), index);
+        ASSERT_EQ(store[index].pos, Point(static_cast<double>(index * 2), 0));
+    }
+}
+
+TEST(AgentStore, RemoveDropsMarkedAgents)
+{
+    AgentStore store{};
+    std::vector<GenericAgent::ID> ids{};
+    for(int index = 0; index < 6; ++index) {
+        const auto agent = make_agent({static_cast<double>(index), 0});
+        ids.push_back(agent.id);
+        store.Add(agent);
+    }
+
+    store.Remove({true, false, false, true, false, true});
+
+    const std::vector<GenericAgent::ID> expected{ids[1], ids[2], ids[4]};
+    ASSERT_EQ(store.Ids(), expected);
+    for(size_t index = 0; index < expected.size(); ++index) {
+        ASSERT_EQ(store.IndexOf(expected[index]), index);
+    }
+    ASSERT_FALSE(store.Contains(ids[0]));
+    ASSERT_FALSE(store.Contains(ids[5]));
+    ASSERT_THROW(store.Remove({true}), SimulationError);
+    ASSERT_EQ(store.size(), 3);
+}
+
+TEST(AgentStore, IteratesInInsertionOrder)
+{
+    AgentStore store{};
+    std::vector<GenericAgent::ID> ids{};
+    for(int index = 0; index < 3; ++index) {
+        const auto agent = make_agent({static_cast<double>(index), 0});
+        ids.push_back(agent.id);
+        store.Add(agent);
+    }
+    std::vector<GenericAgent::ID> actual{};
+    std::transform(
+        std::begin(store), std::end(store), std::back_inserter(actual), [](ConstAgentRef agent) {
+            return agent.id;
+        });
+    ASSERT_EQ(actual, ids);
+}
+
+TEST(AgentNeighborhoodSearch, FindsAgentsOfStore)
+{
+    AgentStore store{};
+    AgentNeighborhoodSearch neighborhoodSearch{store, 2.2};
+    const auto close = make_agent({1, 1});
+    const auto far = make_agent({10, 10});
+    store.Add(close);
+    store.Add(far);
+    WorkerPool pool{};
+    neighborhoodSearch.Update(pool);
+
+    const auto neighbors = neighborhoodSearch.GetNeighboringAgents({0, 0}, 2);
+    ASSERT_EQ(neighbors.size(), 1);
+    ASSERT_EQ(neighbors.front().id, close.id);
+
+    const auto added = make_agent({0.5, 0});
+    neighborhoodSearch.AddAgent(store.Add(added));
+    ASSERT_EQ(neighborhoodSearch.GetNeighboringAgents({0, 0}, 2).size(), 2);
+}
+
+TEST(AgentNeighborhoodSearch, VisitsAgentsInPlace)
+{
+    AgentStore store{};
+    AgentNeighborhoodSearch neighborhoodSearch{store, 2.2};
+    store.Add(make_agent({1, 1}));
+    store.Add(make_agent({10, 10}));
+    WorkerPool pool{};
+    neighborhoodSearch.Update(pool);
+
+    size_t count{};
+    neighborhoodSearch.ForEachNeighbor({0, 0}, 2, [&count, &store](ConstAgentRef agent) {
+        ++count;
+        ASSERT_EQ(&agent.pos, &store.Positions()[0]);
+    });
+    ASSERT_EQ(count, 1);
+}
+
+TEST(AgentNeighborhoodSearch, FollowsRemovedAndMovedAgents)
+{
+    AgentStore store{};
+    AgentNeighborhoodSearch neighborhoodSearch{store, 2.2};
+    neighborhoodSearch.SetBounds(AABB{Point{0, 0}, Point{20, 20}});
+    std::vector<GenericAgent::ID> ids{};
+    for(int index = 0; index < 10; ++index) {
+        const auto agent = make_agent({static_cast<double>(index) * 2, 1});
+        ids.push_back(agent.id);
+        store.Add(agent);
+    }
+    WorkerPool pool{};
+    neighborhoodSearch.Update(pool);
+
+    store.RemoveIf(
+        [&ids](ConstAgentRef agent) { return agent.id == ids[0] || agent.id == ids[4]; });
+    store[store.IndexOf(ids[9])].pos = Point{1, 10};
+    neighborhoodSearch.Update(pool);
+
+    for(size_t index = 0; index < store.size(); ++index) {
+        const auto agent = std::as_const(store)[index];
+        const auto neighbors = neighborhoodSearch.GetNeighboringAgents(agent.pos, 0.1);
+        ASSERT_EQ(neighbors.size(), 1);
+        ASSERT_EQ(neighbors.front().id, agent.id);
+    }
+    ASSERT_TRUE(neighborhoodSearch.GetNeighboringAgents({0, 1}, 0.1).empty());
+    ASSERT_TRUE(neighborhoodSearch.GetNeighboringAgents({8, 1}, 0.1).empty());
+    ASSERT_TRUE(neighborhoodSearch.GetNeighboringAgents({18, 1}, 0.1).empty());
+}
+
+TEST(AgentNeighborhoodSearch, NeighborListsMatchGridQueries)
+{
+    AgentStore store{};
+    AgentNeighborhoodSearch neighborhoodSearch{store, 2};
+    neighborhoodSearch.SetBounds(AABB{Point{0, 0}, Point{20, 20}});
+    neighborhoodSearch.SetNeighborLists(3, 0.4);
+    std::mt19937 gen{3};
+    std::uniform_real_distribution<double> coordinate{0, 20};
+    for(int index = 0; index < 300; ++index) {
+        store.Add(make_agent({coordinate(gen), coordinate(gen)}));
+    }
+    WorkerPool pool{};
+
+    const auto neighborIds = [&neighborhoodSearch](auto query, double radius) {
+        std::set<GenericAgent::ID> ids{};
+        neighborhoodSearch.ForEachNeighbor(
+            query, radius, [&ids](ConstAgentRef neighbor) { ids.insert(neighbor.id); });
+        return ids;
+    };
+
+    std::uniform_real_distribution<double> step{-0.05, 0.05};
+    for(int iteration = 0; iteration < 20; ++iteration) {
+        if(iteration == 10) {
+            const auto removed = store.Ids()[7];
+            store.RemoveIf([removed](ConstAgentRef agent) { return agent.id == removed; });
+        }
+        neighborhoodSearch.Update(pool);
+        for(size_t index = 0; index < store.size(); ++index) {
+            const auto agent = std::as_const(store)[index];
+            ASSERT_EQ(neighborIds(agent, 3), neighborIds(agent.pos, 3));
+            ASSERT_EQ(neighborIds(agent, 1), neighborIds(agent.pos, 1));
+        }
+        for(size_t index = 0; index < store.size(); ++index) {
+            store[index].pos = store[index].pos + Point{step(gen), step(gen)};
+        }
+    }
+}
+
+TEST(AgentStore, ReorderKeepsAgentDataTogether)
+{
+    AgentStore store{};
+    std::vector<GenericAgent::ID> ids{};
+    for(int index = 0; index < 4; ++index) {
+        const auto agent = make_agent({static_cast<double>(index), 0}, 0.1 * (index + 1));
+        ids.push_back(agent.id);
+        store.Add(agent);
+    }
+    const auto version = store.LayoutVersion();
+    store.Reorder({2, 0, 3, 1});
+
+    ASSERT_NE(store.LayoutVersion(), version);
+    const std::vector<GenericAgent::ID> expected{ids[2], ids[0], ids[3], ids[1]};
+    ASSERT_EQ(store.Ids(), expected);
+    for(size_t index = 0; index < ids.size(); ++index) {
+        const auto agent = std::as_const(store)[store.IndexOf(ids[index])];
+        ASSERT_EQ(agent.id, ids[index]);
+        ASSERT_EQ(agent.pos, Point(static_cast<double>(index), 0));
+        ASSERT_DOUBLE_EQ(
+            agent.model.As<CollisionFreeSpeedModelData>().radius, 0.1 * (index + 1));
+    }
+}
+
+TEST(AgentStore, RejectsOrdersThatAreNoPermutation)
+{
+    AgentStore store{};
+    store.Add(make_agent({0, 0}));
+    store.Add(make_agent({1, 0}));
+    ASSERT_THROW(store.Reorder({0}), SimulationError);
+    ASSERT_THROW(store.Reorder({1, 1}), SimulationError);
+    ASSERT_THROW(store.Reorder({0, 2}), SimulationError);
+}
+
+TEST(AgentNeighborhoodSearch, FollowsReorderedAgents)
+{
+    AgentStore store{};
+    AgentNeighborhoodSearch neighborhoodSearch{store, 2.2};
+    neighborhoodSearch.SetBounds(AABB{Point{0, 0}, Point{20, 20}});
+    for(int index = 0; index < 10; ++index) {
+        store.Add(make_agent({static_cast<double>(index) * 2, 1}));
+    }
+    WorkerPool pool{};
+    neighborhoodSearch.Update(pool);
+
+    store.Reorder({9, 8, 7, 6, 5, 4, 3, 2, 1, 0});
+    neighborhoodSearch.Update(pool);
+    for(size_t index = 0; index < store.size(); ++index) {
+        const auto agent = std::as_const(store)[index];
+        const auto neighbors = neighborhoodSearch.GetNeighboringAgents(agent.pos, 0.1);
+        ASSERT_EQ(neighbors.size(), 1);
+        ASSERT_EQ(neighbors.front().id, agent.id);
+    }
+}
+
+TEST(AgentStore, RejectsAgentsAddedTwice)
+{
+    AgentStore store{};
+    const auto agent = make_agent({1, 2});
+    store.Add(agent);
+    ASSERT_THROW(store.Add(agent), SimulationError);
+    ASSERT_EQ(store.size(), 1);
+}
+
+TEST(AgentStore, IndicesStayConsistentThroughRemovalAndReordering)
+{
+    AgentStore store{};
+    std::vector<GenericAgent::ID> removed{};
+    std::mt19937 gen{11};
+    std::uniform_real_distribution<double> coordinate{0, 50};
+    for(int round = 0; round < 10; ++round) {
+        for(int index = 0; index < 50; ++index) {
+            store.Add(make_agent({coordinate(gen), coordinate(gen)}));
+        }
+        store.RemoveIf([&removed, &gen](ConstAgentRef agent) {
+            if(gen() % 4 != 0) {
+                return false;
+            }
+            removed.push_back(agent.id);
+            return true;
+        });
+        std::vector<size_t> order(store.size());
+        std::iota(std::begin(order), std::end(order), 0);
+        std::shuffle(std::begin(order), std::end(order), gen);
+        store.Reorder(order);
+
+        for(size_t index = 0; index < store.size(); ++index) {
+            ASSERT_EQ(store.IndexOf(store.Ids()[index]), index);
+        }
+        for(const auto& id : removed) {
+            ASSERT_FALSE(store.Contains(id));
+        }
+    }
+}
@@ -1,11 +1,18 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AABB.hpp"
 #include "CollisionGeometry.hpp"
+#include "GeometricFunctions.hpp"
 #include "LineSegment.hpp"
 #include "gtest/gtest.h"
 
+#include <algorithm>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 #include <gtest/gtest.h>
+#include <iterator>
+#include <random>
+#include <set>
+#include <utility>
 
 struct CellAdjacencyTestData {
     Cell c;
@@ -115,6 +122,10 @@ INSTANTIATE_TEST_SUITE_P(
             LineSegment{{1, 1}, {3, 4}},
             std::set<Cell>{{0, 0}, {0, 4}}
         ),
+        std::make_tuple(
+            LineSegment{{3, 0.5}, {4.5, 7.5}},
+            std::set<Cell>{{0, 0}, {0, 4}, {4, 4}}
+        ),
         std::make_tuple(
             LineSegment{{4, 12}, {8, 0}},
             std::set<Cell>{{4, 12}, {4, 8}, {4,4}, {4,0}, {8,0}}
@@ -325,3 +336,208 @@ TEST_F(LongDiagonalRectangle, CellsWithTwoLSMiddle)
         ASSERT_EQ(actual, expected);
     }
 }
+
+TEST_F(LongDiagonalRectangle, LineSegmentsInDistanceToMatchesExhaustiveSearch)
+{
+    const std::vector<LineSegment> segments = {
+        {{-11., -13.}, {5., 11.}},
+        {{5., 11.}, {6., 10.}},
+        {{6., 10.}, {-10., -14.}},
+        {{-10., -14.}, {-11., -13.}},
+    };
+
+    for(const double distance : {0.5, 2., 7., 50.}) {
+        for(double x = -20.; x <= 20.; x += 0.75) {
+            for(double y = -20.; y <= 20.; y += 0.75) {
+                const Point p{x, y};
+                std::set<LineSegment> expected{};
+                std::copy_if(
+                    std::begin(segments),
+                    std::end(segments),
+                    std::inserter(expected, std::end(expected)),
+                    [distance, p](const auto& ls) { return dist(ls, p) <= distance; });
+
+                const auto result = collisionGeometry.LineSegmentsInDistanceTo(distance, p);
+                const std::set<LineSegment> actual(std::begin(result), std::end(result));
+
+                ASSERT_EQ(actual.size(), result.size());
+                ASSERT_EQ(actual, expected) << fmt::format("p={}, distance={}", p, distance);
+            }
+        }
+    }
+}
+
+TEST(CollisionGeometry, LineSegmentsInDistanceToFindsWallCuttingCellCorner)
+{
+    // The wall connects diagonally neighboring cells and cuts the corner of the cell (0, 4)
+    const LineSegment wall{{3., 0.5}, {4.5, 7.5}};
+    const CollisionGeometry collisionGeometry(
+        constructPolyFromPoints({wall.p1, wall.p2, {-2., 7.5}, {-2., 0.5}}));
+
+    const auto segments = collisionGeometry.LineSegmentsInDistanceTo(0.05, {3.85, 4.6});
+    ASSERT_EQ(segments.size(), 1);
+    ASSERT_EQ(segments.front(), wall);
+    ASSERT_TRUE(collisionGeometry.IntersectsAny({{3.7, 4.5}, {3.95, 4.1}}));
+}
+
+TEST(CollisionGeometry, InsideGeometryMatchesPolygonTest)
+{
+    auto polygon = constructPolyFromPoints(
+        {{-3., -1.}, {12., -1.}, {12., 4.}, {6.5, 4.}, {6.5, 13.}, {4., 17.}, {-3., 8.}});
+    const std::vector<Point> hole{{0., 0.}, {4., 0.}, {4., 4.}, {1., 6.5}};
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    std::vector<CGALPoint> cgalHole{};
+    std::transform(
+        std::begin(hole), std::end(hole), std::back_inserter(cgalHole), [](const auto& p) {
+            return CGALPoint{p.x, p.y};
+        });
+    polygon.add_hole(Poly{cgalHole.begin(), cgalHole.end()});
+    const CollisionGeometry collisionGeometry(polygon);
+
+    // The step hits vertices, edges and cell borders
+    for(double x = -6.; x <= 15.; x += 0.25) {
+        for(double y = -4.; y <= 20.; y += 0.25) {
+            const bool expected =
+                CGAL::oriented_side(CGALPoint{x, y}, polygon) != CGAL::ON_NEGATIVE_SIDE;
+            ASSERT_EQ(collisionGeometry.InsideGeometry({x, y}), expected)
+                << fmt::format("p=({}, {})", x, y);
+        }
+    }
+}
+
+TEST(CollisionGeometry, InsideGeometryAtWallGrazingCellCorner)
+{
+    // Each wall cuts off the corner (4, 4) of a cell within rounding error, a floating point box
+    // test does not assign it to that cell
+    const std::vector<std::pair<Point, Point>> walls{
+        {{8.3611816848096971, -3.6919338261886425}, {2.9033686199785542, 5.934158358095317}},
+        {{5.6826720407454117, 0.48505267265527108}, {2.4079099037150526, 7.3257299659830029}},
+        {{6.872222634941906, 0.75059349340471382}, {2.086787046595513, 6.1644584732620027}},
+        {{12.539173563383194, -2.8944244694745347}, {1.9115471667272561, 5.6861913170147949}},
+        {{8.7687204905506775, -0.5408998634301625}, {2.9283710362497222, 5.0204330123318917}}};
+    for(const auto& [from, to] : walls) {
+        const CollisionGeometry collisionGeometry(constructPolyFromPoints({to, {-4., 0.}, from}));
+        ASSERT_TRUE(collisionGeometry.InsideGeometry({4., 4.}))
+            << fmt::format("wall=({}, {})-({}, {})", from.x, from.y, to.x, to.y);
+    }
+}
+
+TEST(LineOfSight, WallsBlockTheView)
+{
+    auto polygon = constructPolyFromPoints({{0., 0.}, {20., 0.}, {20., 20.}, {0., 20.}});
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> hole{{8., 8.}, {8., 12.}, {12., 12.}, {12., 8.}};
+    polygon.add_hole(Poly{hole.begin(), hole.end()});
+    const CollisionGeometry collisionGeometry(polygon);
+
+    const LineOfSight nearby(collisionGeometry, {6., 10.}, 2.);
+    ASSERT_TRUE(nearby.IsVisible({7.5, 10.}));
+    ASSERT_TRUE(nearby.IsVisible({6., 11.5}));
+
+    const LineOfSight wide(collisionGeometry, {6., 10.}, 10.);
+    ASSERT_FALSE(wide.IsVisible({14., 10.}));
+    ASSERT_FALSE(wide.IsVisible({13., 13.}));
+    ASSERT_TRUE(wide.IsVisible({6., 16.}));
+    ASSERT_TRUE(wide.IsVisible({9., 16.}));
+}
+
+TEST(LineOfSight, WallsBeyondApproximateRangeBlockTheView)
+{
+    auto polygon = constructPolyFromPoints({{0., 0.}, {40., 0.}, {40., 20.}, {0., 20.}});
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> hole{{14., 8.}, {14., 12.}, {16., 12.}, {16., 8.}};
+    polygon.add_hole(Poly{hole.begin(), hole.end()});
+    const CollisionGeometry collisionGeometry(polygon);
+    const Point origin{2., 10.};
+    const Point target{20., 10.};
+
+    // The walls near the origin, which were the only ones tested for any radius, miss the hole
+    const auto& nearby = collisionGeometry.LineSegmentsInApproxDistanceTo(origin);
+    ASSERT_TRUE(std::none_of(std::begin(nearby), std::end(nearby), [&](const auto& ls) {
+        return intersects(LineSegment(origin, target), ls);
+    }));
+
+    ASSERT_FALSE(LineOfSight(collisionGeometry, origin, 20.).IsVisible(target));
+    ASSERT_TRUE(LineOfSight(collisionGeometry, origin, 20.).IsVisible({20., 16.}));
+}
+
+TEST(CollisionGeometry, VisibilityBetweenNeighboringCells)
+{
+    auto polygon = constructPolyFromPoints({{0., 0.}, {24., 0.}, {24., 24.}, {0., 24.}});
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    const std::vector<CGALPoint> hole{{12., 12.}, {12., 16.}, {16., 16.}, {16., 12.}};
+    polygon.add_hole(Poly{hole.begin(), hole.end()});
+    const CollisionGeometry collisionGeometry(polygon);
+
+    ASSERT_EQ(collisionGeometry.VisibilityBetween({5., 5.}, {6., 7.}), CellVisibility::Visible);
+    ASSERT_EQ(collisionGeometry.VisibilityBetween({5., 5.}, {11., 7.}), CellVisibility::Visible);
+    ASSERT_EQ(collisionGeometry.VisibilityBetween({9., 13.}, {13., 15.}), CellVisibility::Blocked);
+    ASSERT_EQ(collisionGeometry.VisibilityBetween({9., 9.}, {13., 13.}), CellVisibility::Partial);
+    ASSERT_EQ(collisionGeometry.VisibilityBetween({1., 5.}, {5., 5.}), CellVisibility::Partial);
+    ASSERT_EQ(collisionGeometry.VisibilityBetween({5., 5.}, {13., 5.}), CellVisibility::Partial);
+    ASSERT_EQ(collisionGeometry.VisibilityBetween({5., 5.}, {30., 5.}), CellVisibility::Partial);
+
+    ASSERT_FALSE(collisionGeometry.IntersectsAny({{5., 5.}, {11., 7.}}));
+    ASSERT_TRUE(collisionGeometry.IntersectsAny({{9., 13.}, {13., 15.}}));
+}
+
+TEST(CollisionGeometry, CachedVisibilityMatchesExhaustiveSearch)
+{
+    const std::vector<Point> exterior{
+        {-3., -1.}, {12., -1.}, {12., 4.}, {6.5, 4.}, {6.5, 13.}, {4., 17.}, {-3., 8.}};
+    const std::vector<Point> hole{{0., 0.}, {4., 0.}, {4., 4.}, {1., 6.5}};
+    auto polygon = constructPolyFromPoints(exterior);
+    using CGALPoint = PolyWithHoles::Polygon_2::Point_2;
+    std::vector<CGALPoint> cgalHole{};
+    std::transform(
+        std::begin(hole), std::end(hole), std::back_inserter(cgalHole), [](const auto& p) {
+            return CGALPoint{p.x, p.y};
+        });
+    polygon.add_hole(Poly{cgalHole.begin(), cgalHole.end()});
+    const CollisionGeometry collisionGeometry(polygon);
+
+    std::vector<LineSegment> walls{};
+    for(const auto& ring : {exterior, hole}) {
+        for(size_t index = 0; index < ring.size(); ++index) {
+            walls.emplace_back(ring[index], ring[(index + 1) % ring.size()]);
+        }
+    }
+
+    // Coordinates on a coarse raster hit vertices, walls and cell borders, all lines of sight are
+    // between the same or neighboring cells
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int> x{-6, 24};
+    std::uniform_int_distribution<int> y{-2, 34};
+    std::uniform_int_distribution<int> offset{-8, 8};
+    size_t visible = 0;
+    size_t blocked = 0;
+    for(size_t iteration = 0; iteration < 20000; ++iteration) {
+        const Point from{x(gen) * 0.5, y(gen) * 0.5};
+        const Point to = from + Point{offset(gen) * 0.5, offset(gen) * 0.5};
+        if(!AABB(exterior).Inside(to)) {
+            continue;
+        }
+        const LineSegment sight{from, to};
+        const bool expected = std::any_of(std::begin(walls), std::end(walls), [&](const auto& w) {
+            return intersects(sight, w);
+        });
+        switch(collisionGeometry.VisibilityBetween(from, to)) {
+            case CellVisibility::Visible:
+                ++visible;
+                ASSERT_FALSE(expected) << fmt::format("from={}, to={}", from, to);
+                break;
+            case CellVisibility::Blocked:
+                ++blocked;
+                ASSERT_TRUE(expected) << fmt::format("from={}, to={}", from, to);
+                break;
+            case CellVisibility::Partial:
+                break;
+        }
+        ASSERT_EQ(collisionGeometry.IntersectsAny(sight), expected)
+            << fmt::format("from={}, to={}", from, to);
+        const LineOfSight lineOfSight(collisionGeometry, from, 12.);
+        ASSERT_EQ(lineOfSight.IsVisible(to), !expected) << fmt::format("from={}, to={}", from, to);
+    }
+    ASSERT_GT(visible, 0);
+    ASSERT_GT(blocked, 0);
+}
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AABB.hpp"
+#include "DenseNeighborhoodSearch.hpp"
+#include "Point.hpp"
+#include "WorkerPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+std::set<size_t> keysInRange(const std::vector<Point>& positions, Point pos, double radius)
+{
+    std::set<size_t> result{};
+    for(size_t key = 0; key < positions.size(); ++key) {
+        if(Distance(positions[key], pos) <= radius) {
+            result.insert(key);
+        }
+    }
+    return result;
+}
+
+std::vector<size_t> visitedKeys(const DenseNeighborhoodSearch& search, Point pos, double radius)
+{
+    std::vector<size_t> result{};
+    search.ForEachNeighbor(pos, radius, [&result](size_t key) { result.push_back(key); });
+    return result;
+}
+
+std::vector<Point> randomPositions(size_t count, double extent, unsigned seed = 42)
+{
+    std::mt19937 gen{seed};
+    std::uniform_real_distribution<double> coordinate{-extent, extent};
+    std::vector<Point> positions{};
+    for(size_t key = 0; key < count; ++key) {
+        positions.push_back({coordinate(gen), coordinate(gen)});
+    }
+    return positions;
+}
+
+void expectMatchesBruteForce(
+    const DenseNeighborhoodSearch& search,
+    const std::vector<Point>& positions)
+{
+    for(const auto& query : randomPositions(100, 35, 7)) {
+        for(const double radius : {0.5, 2.2, 7.0}) {
+            const auto visited = visitedKeys(search, query, radius);
+            const std::set<size_t> unique(std::begin(visited), std::end(visited));
+            ASSERT_EQ(unique.size(), visited.size());
+            ASSERT_EQ(unique, keysInRange(positions, query, radius));
+        }
+    }
+}
+} // namespace
+
+TEST(DenseNeighborhoodSearch, ReturnsEmptyOnEmpty)
+{
+    DenseNeighborhoodSearch search{2};
+    search.SetBounds(AABB{Point{0, 0}, Point{10, 10}});
+    ASSERT_TRUE(search.GetNeighbors({5, 5}, 10).empty());
+}
+
+TEST(DenseNeighborhoodSearch, MatchesBruteForce)
+{
+    // Bounds cover only part of the positions, the remaining ones end up in the border cells
+    const auto positions = randomPositions(2000, 30);
+    DenseNeighborhoodSearch search{2.2};
+    search.SetBounds(AABB{Point{-20, -20}, Point{20, 20}});
+    WorkerPool pool{};
+    search.Update(positions, pool);
+
+    expectMatchesBruteForce(search, positions);
+}
+
+TEST(DenseNeighborhoodSearch, MatchesBruteForceAfterMoving)
+{
+    auto positions = randomPositions(2000, 30);
+    DenseNeighborhoodSearch search{2.2};
+    search.SetBounds(AABB{Point{-20, -20}, Point{20, 20}});
+    WorkerPool pool{};
+    search.Update(positions, pool);
+
+    std::mt19937 gen{1};
+    std::uniform_real_distribution<double> step{-1.5, 1.5};
+    for(int iteration = 0; iteration < 10; ++iteration) {
+        for(auto& pos : positions) {
+            pos = pos + Point{step(gen), step(gen)};
+        }
+        search.MoveAll(positions, pool);
+        expectMatchesBruteForce(search, positions);
+    }
+}
+
+TEST(DenseNeighborhoodSearch, MovesOnlyKeysChangingTheirCell)
+{
+    DenseNeighborhoodSearch search{2};
+    search.SetBounds(AABB{Point{0, 0}, Point{10, 10}});
+    WorkerPool pool{};
+    std::vector<Point> positions{{1, 1}, {5, 5}};
+    search.Update(positions, pool);
+
+    positions = {{1.5, 1.5}, {7, 5}};
+    ASSERT_EQ(search.MoveAll(positions, pool), 1);
+    ASSERT_EQ(visitedKeys(search, {7, 5}, 0.1), std::vector<size_t>{1});
+    ASSERT_EQ(visitedKeys(search, {1.5, 1.5}, 0.1), std::vector<size_t>{0});
+}
+
+TEST(DenseNeighborhoodSearch, KeepsKeysThatDoNotFitIntoTheirCell)
+{
+    DenseNeighborhoodSearch search{2};
+    search.SetBounds(AABB{Point{0, 0}, Point{100, 100}});
+    WorkerPool pool{};
+    search.Update({{1, 1}}, pool);
+
+    // The cell far away has no spare slots
+    for(size_t key = 1; key < 10; ++key) {
+        search.Insert(key, {50, 50});
+    }
+    ASSERT_GT(search.CountPending(), 0);
+    ASSERT_EQ(search.GetNeighbors({50, 50}, 1).size(), 9);
+
+    search.Erase(5);
+    ASSERT_FALSE(search.Contains(5));
+    ASSERT_EQ(search.GetNeighbors({50, 50}, 1).size(), 8);
+}
+
+TEST(DenseNeighborhoodSearch, EraseAndRekey)
+{
+    const auto positions = randomPositions(100, 10);
+    DenseNeighborhoodSearch search{2};
+    search.SetBounds(AABB{Point{-10, -10}, Point{10, 10}});
+    WorkerPool pool{};
+    search.Update(positions, pool);
+
+    // Remove every second key and close the gaps like a stable compaction does
+    std::vector<Point> remaining{};
+    for(size_t key = 0; key < positions.size(); ++key) {
+        if(key % 2 == 0) {
+            search.Erase(key);
+            continue;
+        }
+        search.Rekey(key, remaining.size());
+        remaining.push_back(positions[key]);
+    }
+    for(size_t key = remaining.size(); key < positions.size(); ++key) {
+        ASSERT_FALSE(search.Contains(key));
+    }
+    expectMatchesBruteForce(search, remaining);
+}
+
+TEST(DenseNeighborhoodSearch, FindsKeysInsertedAfterUpdate)
+{
+    DenseNeighborhoodSearch search{2};
+    search.SetBounds(AABB{Point{0, 0}, Point{10, 10}});
+    WorkerPool pool{};
+    search.Update({{1, 1}}, pool);
+    search.Insert(1, {1.5, 1});
+    ASSERT_EQ(search.GetNeighbors({1, 1}, 1).size(), 2);
+
+    search.Update({{1, 1}}, pool);
+    ASSERT_EQ(search.GetNeighbors({1, 1}, 1).size(), 1);
+}
+
+TEST(DenseNeighborhoodSearch, OrderDoesNotDependOnThreadCount)
+{
+    auto positions = randomPositions(5000, 20);
+    DenseNeighborhoodSearch sequential{2.2};
+    DenseNeighborhoodSearch parallel{2.2};
+    sequential.SetBounds(AABB{Point{-20, -20}, Point{20, 20}});
+    parallel.SetBounds(AABB{Point{-20, -20}, Point{20, 20}});
+    WorkerPool singleThread{1};
+    WorkerPool multipleThreads{4};
+    sequential.Update(positions, singleThread);
+    parallel.Update(positions, multipleThreads);
+
+    for(auto& pos : positions) {
+        pos = pos + Point{0.7, -0.4};
+    }
+    sequential.MoveAll(positions, singleThread);
+    parallel.MoveAll(positions, multipleThreads);
+
+    for(const auto& query : randomPositions(50, 20)) {
+        ASSERT_EQ(visitedKeys(sequential, query, 3), visitedKeys(parallel, query, 3));
+    }
+}
+
+TEST(DenseNeighborhoodSearch, LimitsNumberOfCells)
+{
+    DenseNeighborhoodSearch search{1};
+    search.SetBounds(AABB{Point{0, 0}, Point{1e5, 1e5}});
+    ASSERT_GT(search.CellSize(), 1);
+    WorkerPool pool{};
+    search.Update({{5e4, 5e4}}, pool);
+    ASSERT_EQ(search.GetNeighbors({5e4, 5e4}, 1).size(), 1);
+}
@@ -58,3 +58,21 @@ TEST(DirectedGraph, CanConstructSimpleGraphWithData)
     }
     ASSERT_EQ(expected_v1_out_edges, actual);
 }
+
+TEST(DirectedGraph, VerticesWithoutOutgoingEdges)
+{
+    DirectedGraph<>::Builder g{};
+    const auto v1 = g.AddVertex();
+    const auto v2 = g.AddVertex();
+    const auto v3 = g.AddVertex();
+    const auto v4 = g.AddVertex();
+    g.AddEdge(v3, v1);
+    g.AddEdge(v1, v2);
+    g.AddEdge(v3, v4);
+    const auto graph = g.Build();
+    ASSERT_EQ(graph.Edges(v1).size(), 1);
+    ASSERT_EQ(graph.Edges(v2).size(), 0);
+    ASSERT_EQ(graph.Edges(v3).size(), 2);
+    ASSERT_EQ(graph.Edges(v4).size(), 0);
+    ASSERT_EQ(std::get<0>(*graph.Edges(v1).begin()), v2);
+}
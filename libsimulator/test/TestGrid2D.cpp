@@ -1,7 +0,0 @@
-// SPDX-License-Identifier: LGPL-3.0-or-later
-#include "NeighborhoodSearch.hpp"
-
-#include <gtest/gtest.h>
-
-#include <iterator>
-#include <vector>
@@ -81,8 +81,8 @@ TEST(LeastTargetedTransition, NextIsCorrect)
             ON_CALL(*this, IsCompleted).WillByDefault([]() { return true; });
         }
         MOCK_METHOD(size_t, CountTargeting, (), (const));
-        MOCK_METHOD(bool, IsCompleted, (const GenericAgent& agent), (override));
-        MOCK_METHOD(Point, Target, (const GenericAgent& agent), (override));
+        MOCK_METHOD(bool, IsCompleted, (ConstAgentRef agent), (override));
+        MOCK_METHOD(Point, Target, (ConstAgentRef agent), (override));
         MOCK_METHOD(StageProxy, Proxy, (Simulation * simulation_), (override));
         void SetTargeting(size_t targeting_) { targeting = targeting_; }
     };
@@ -5,7 +5,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
 #include <random>
+#include <vector>
 
 const double PI = acos(-1);
 
@@ -84,6 +87,54 @@ TEST(LineSegment, ItersectsWithOneEndpointTouchingInTheMiddle)
     ASSERT_TRUE(intersects(l1, l2));
 }
 
+TEST(LineSegment, OrientationSignIsExactForNearlyCollinearPoints)
+{
+    using K = CGAL::Exact_predicates_inexact_constructions_kernel;
+    const Point q{12., 12.};
+    const Point r{24., 24.};
+    // Points within a few ulps of the line through q and r, the double precision determinant
+    // has the wrong sign for many of them
+    for(int i = 0; i < 64; ++i) {
+        for(int j = 0; j < 64; ++j) {
+            const Point p{0.5 + i * std::ldexp(1., -53), 0.5 + j * std::ldexp(1., -53)};
+            const auto expected = CGAL::orientation(
+                K::Point_2(p.x, p.y), K::Point_2(q.x, q.y), K::Point_2(r.x, r.y));
+            ASSERT_EQ(orientationSign(p, q, r), static_cast<int>(expected));
+        }
+    }
+}
+
+TEST(LineSegment, IntersectsMatchesCGAL)
+{
+    // Points on a small lattice create many collinear and touching configurations
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> coordinate(-3, 3);
+    const auto randomPoint = [&]() { return Point(coordinate(gen), coordinate(gen)); };
+    for(int i = 0; i < 10000; ++i) {
+        const LineSegment l1{randomPoint(), randomPoint()};
+        const LineSegment l2{randomPoint(), randomPoint()};
+        ASSERT_EQ(intersects(l1, l2), intersectsWithCGAL(l1, l2));
+    }
+}
+
+TEST(LineSegment, IntersectsAnyMatchesIntersects)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> coordinate(-6, 6);
+    std::uniform_int_distribution<size_t> count(0, 11);
+    const auto randomPoint = [&]() { return Point(coordinate(gen) / 2., coordinate(gen) / 2.); };
+    for(int i = 0; i < 10000; ++i) {
+        const LineSegment ls{randomPoint(), randomPoint()};
+        std::vector<LineSegment> walls(count(gen));
+        std::generate(std::begin(walls), std::end(walls), [&]() {
+            return LineSegment{randomPoint(), randomPoint()};
+        });
+        const bool expected = std::any_of(
+            std::begin(walls), std::end(walls), [&ls](const auto& w) { return intersects(ls, w); });
+        ASSERT_EQ(intersectsAny(ls, PackedLineSegments(walls)), expected);
+    }
+}
+
 TEST(LineSegment, OperatorLTCaseA)
 {
     const LineSegment a{{0, 0}, {1, 1}};
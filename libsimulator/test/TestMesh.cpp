@@ -6,6 +6,9 @@
 #include <glm/vec2.hpp>
 #include <gtest/gtest.h>
 
+#include <cstddef>
+#include <vector>
+
 class SingleTriangeMesh : public ::testing::Test
 {
 public:
@@ -82,3 +85,25 @@ TEST_F(DoubleBottleNeckMesh, RegressionInContains)
         m->FindContainingPolygon({26.690912185191067, 4.94908998002494}),
         Mesh::Polygon::InvalidIndex);
 }
+
+TEST_F(DoubleBottleNeckMesh, PointsOutsideAreNotFound)
+{
+    EXPECT_EQ(m->FindContainingPolygon({12, 2}), Mesh::Polygon::InvalidIndex);
+    EXPECT_EQ(m->FindContainingPolygon({-1, 5}), Mesh::Polygon::InvalidIndex);
+    EXPECT_EQ(m->FindContainingPolygon({30, 5}), Mesh::Polygon::InvalidIndex);
+    EXPECT_EQ(m->FindContainingPolygon({12, 2}, 0), Mesh::Polygon::InvalidIndex);
+}
+
+TEST_F(DoubleBottleNeckMesh, HintDoesNotChangeResult)
+{
+    const std::vector<glm::dvec2> points{{1, 1}, {9, 9}, {12.5, 5}, {20, 2}, {24, 8}, {27.5, 5}};
+    for(const auto& p : points) {
+        const auto expected = m->FindContainingPolygon(p);
+        ASSERT_NE(expected, Mesh::Polygon::InvalidIndex);
+        for(size_t hint = 0; hint < m->CountPolygons(); ++hint) {
+            const auto found = m->FindContainingPolygon(p, hint);
+            ASSERT_NE(found, Mesh::Polygon::InvalidIndex);
+            ASSERT_TRUE(m->PolygonContains(found, p));
+        }
+    }
+}
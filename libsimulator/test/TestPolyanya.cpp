@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "CfgCgal.hpp"
+#include "Mesh.hpp"
+#include "Point.hpp"
+#include "Polyanya.hpp"
+
+#include <CGAL/mark_domain_in_triangulation.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class PolyanyaOnLShape : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        CDT cdt{};
+        // POLYGON ((0 0, 10 0, 10 10, 8 10, 8 2, 0 2, 0 0))
+        std::vector<K::Point_2> boundary = {{0, 0}, {10, 0}, {10, 10}, {8, 10}, {8, 2}, {0, 2}};
+        for(size_t index = 0; index < boundary.size(); ++index) {
+            cdt.insert_constraint(boundary[index], boundary[(index + 1) % boundary.size()]);
+        }
+        CGAL::mark_domain_in_triangulation(cdt);
+        Mesh mesh{cdt};
+        mesh.MergeGreedy();
+        polyanya = std::make_unique<Polyanya>(mesh);
+    }
+
+protected:
+    std::unique_ptr<Polyanya> polyanya{};
+};
+
+TEST_F(PolyanyaOnLShape, DirectPathInsideVisibleArea)
+{
+    const auto path = polyanya->ComputeWaypoints({1, 1}, {9, 1.5});
+    const std::vector<Point> expected{{1, 1}, {9, 1.5}};
+    ASSERT_EQ(path, expected);
+}
+
+TEST_F(PolyanyaOnLShape, TurnsAroundInnerCorner)
+{
+    const auto path = polyanya->ComputeWaypoints({1, 1}, {9, 9});
+    const std::vector<Point> expected{{1, 1}, {8, 2}, {9, 9}};
+    ASSERT_EQ(path, expected);
+}
+
+TEST_F(PolyanyaOnLShape, PathIsSymmetric)
+{
+    const auto path = polyanya->ComputeWaypoints({9, 9}, {1, 1});
+    const std::vector<Point> expected{{9, 9}, {8, 2}, {1, 1}};
+    ASSERT_EQ(path, expected);
+}
+
+TEST_F(PolyanyaOnLShape, StartOnMeshVertex)
+{
+    const auto path = polyanya->ComputeWaypoints({10, 0}, {9, 9});
+    const std::vector<Point> expected{{10, 0}, {9, 9}};
+    ASSERT_EQ(path, expected);
+}
+
+TEST_F(PolyanyaOnLShape, StartCloseToSharedEdge)
+{
+    // Intervals seen from a start this close to an edge are dropped, the search has to start from
+    // the polygon on the other side of the edge as well.
+    const auto& mesh = polyanya->MeshData();
+    for(size_t index = 0; index < mesh.CountPolygons(); ++index) {
+        const auto& polygon = mesh.Polygons(index);
+        const auto count = polygon.vertices.size();
+        for(size_t edge = 0; edge < count; ++edge) {
+            if(polygon.neighbors[edge] == Mesh::InvalidIndex) {
+                continue;
+            }
+            const auto a = mesh.Vertex(polygon.vertices[edge]);
+            const auto b = mesh.Vertex(polygon.vertices[(edge + 1) % count]);
+            const Point middle{(a.x + b.x) / 2, (a.y + b.y) / 2};
+            const auto normal = Point{b.x - a.x, b.y - a.y}.Normalized().Rotate90Deg();
+            for(const auto offset : {-1e-9, 1e-9}) {
+                const auto from = middle + normal * offset;
+                ASSERT_FALSE(polyanya->ComputeWaypoints(from, {1, 1}).empty());
+                ASSERT_FALSE(polyanya->ComputeWaypoints(from, {9, 9}).empty());
+            }
+        }
+    }
+}
+
+TEST_F(PolyanyaOnLShape, NoPathFromOutside)
+{
+    ASSERT_TRUE(polyanya->ComputeWaypoints({5, 5}, {9, 9}).empty());
+    ASSERT_TRUE(polyanya->ComputeWaypoints({1, 1}, {-1, 1}).empty());
+}
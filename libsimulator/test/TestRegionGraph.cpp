@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "CfgCgal.hpp"
+#include "Mesh.hpp"
+#include "Point.hpp"
+#include "RegionGraph.hpp"
+
+#include <CGAL/mark_domain_in_triangulation.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace
+{
+void insertPolygon(CDT& cdt, const std::vector<K::Point_2>& boundary)
+{
+    for(size_t index = 0; index < boundary.size(); ++index) {
+        cdt.insert_constraint(boundary[index], boundary[(index + 1) % boundary.size()]);
+    }
+}
+
+size_t polygonContaining(const Mesh& mesh, Point p)
+{
+    return mesh.FindContainingPolygon({p.x, p.y});
+}
+
+bool isConnected(const Mesh& mesh, const std::vector<size_t>& corridor)
+{
+    for(size_t index = 1; index < corridor.size(); ++index) {
+        const auto& neighbors = mesh.Polygons(corridor[index - 1]).neighbors;
+        if(std::find(std::begin(neighbors), std::end(neighbors), corridor[index]) ==
+           std::end(neighbors)) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+class RegionGraphOnCorridor : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        CDT cdt{};
+        // Long corridor with a separate room that cannot be reached from the corridor
+        std::vector<K::Point_2> corridor{};
+        for(int x = 0; x <= 50; ++x) {
+            corridor.emplace_back(x, 0);
+        }
+        for(int x = 50; x >= 0; --x) {
+            corridor.emplace_back(x, 2);
+        }
+        insertPolygon(cdt, corridor);
+        insertPolygon(cdt, {{0, 10}, {5, 10}, {5, 15}, {0, 15}});
+        CGAL::mark_domain_in_triangulation(cdt);
+        mesh = std::make_unique<Mesh>(cdt);
+    }
+
+protected:
+    std::unique_ptr<Mesh> mesh{};
+};
+
+TEST_F(RegionGraphOnCorridor, RegionsAreBounded)
+{
+    const RegionGraph graph{*mesh, 8};
+    ASSERT_GT(graph.CountRegions(), 1);
+    ASSERT_GT(graph.CountPortals(), 0);
+
+    std::vector<size_t> regionSizes(graph.CountRegions(), 0);
+    for(size_t polygon = 0; polygon < mesh->CountPolygons(); ++polygon) {
+        ++regionSizes.at(graph.RegionOf(polygon));
+    }
+    for(const auto size : regionSizes) {
+        ASSERT_GT(size, 0);
+        ASSERT_LE(size, 8);
+    }
+}
+
+TEST_F(RegionGraphOnCorridor, CorridorConnectsStartAndTarget)
+{
+    const RegionGraph graph{*mesh, 8};
+    const Point from{0.3, 0.7};
+    const Point to{49.6, 1.3};
+    const auto fromPolygon = polygonContaining(*mesh, from);
+    const auto toPolygon = polygonContaining(*mesh, to);
+    ASSERT_NE(graph.RegionOf(fromPolygon), graph.RegionOf(toPolygon));
+
+    const auto corridor = graph.FindCorridor(*mesh, fromPolygon, from, toPolygon, to);
+    ASSERT_FALSE(corridor.empty());
+    ASSERT_EQ(corridor.front(), fromPolygon);
+    ASSERT_EQ(corridor.back(), toPolygon);
+    ASSERT_TRUE(isConnected(*mesh, corridor));
+}
+
+TEST_F(RegionGraphOnCorridor, CorridorWithinSingleRegion)
+{
+    const RegionGraph graph{*mesh};
+    const Point from{0.3, 0.7};
+    const Point to{3.3, 0.7};
+    const auto fromPolygon = polygonContaining(*mesh, from);
+    const auto toPolygon = polygonContaining(*mesh, to);
+
+    const auto corridor = graph.FindCorridor(*mesh, fromPolygon, from, toPolygon, to);
+    ASSERT_FALSE(corridor.empty());
+    ASSERT_EQ(corridor.front(), fromPolygon);
+    ASSERT_EQ(corridor.back(), toPolygon);
+    ASSERT_TRUE(isConnected(*mesh, corridor));
+}
+
+TEST_F(RegionGraphOnCorridor, UnreachableTargetGivesEmptyCorridor)
+{
+    const RegionGraph graph{*mesh, 8};
+    const Point from{0.3, 0.7};
+    const Point to{1, 12};
+    const auto corridor = graph.FindCorridor(
+        *mesh, polygonContaining(*mesh, from), from, polygonContaining(*mesh, to), to);
+    ASSERT_TRUE(corridor.empty());
+}
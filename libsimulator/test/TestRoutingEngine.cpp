@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AgentStore.hpp"
+#include "CfgCgal.hpp"
+#include "CollisionFreeSpeedModelData.hpp"
+#include "CollisionGeometry.hpp"
+#include "GenericAgent.hpp"
+#include "LineSegment.hpp"
+#include "Point.hpp"
+#include "RoutingEngine.hpp"
+#include "RoutingMode.hpp"
+#include "SimulationError.hpp"
+#include "TacticalDecisionSystem.hpp"
+#include "WorkerPool.hpp"
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+/// Two squares that only touch in (5, 5), no path leads from one to the other.
+PolyWithHoles disconnectedSquares()
+{
+    const std::vector<K::Point_2> boundary{
+        {0, 0}, {5, 0}, {5, 5}, {10, 5}, {10, 10}, {5, 10}, {5, 5}, {0, 5}};
+    return PolyWithHoles{Poly{std::begin(boundary), std::end(boundary)}};
+}
+
+/// Two rooms connected by a 0.3m wide door, narrower than twice the distance kept to corners.
+PolyWithHoles roomsWithNarrowDoor()
+{
+    const std::vector<K::Point_2> boundary{
+        {0, 0},
+        {4, 0},
+        {4, 4},
+        {2.3, 4},
+        {2.3, 5},
+        {4, 5},
+        {4, 9},
+        {0, 9},
+        {0, 5},
+        {2, 5},
+        {2, 4},
+        {0, 4}};
+    return PolyWithHoles{Poly{std::begin(boundary), std::end(boundary)}};
+}
+} // namespace
+
+class RoutingEngineOnDisconnectedGeometry : public ::testing::TestWithParam<RoutingMode>
+{
+};
+
+TEST_P(RoutingEngineOnDisconnectedGeometry, UnreachableTargetThrows)
+{
+    RoutingEngine engine{disconnectedSquares()};
+    engine.SetMode(GetParam());
+
+    ASSERT_EQ(engine.ComputeAllWaypoints({1, 1}, {4, 4}).size(), 2);
+    ASSERT_THROW(engine.ComputeRoute({1, 1}, {9, 9}), SimulationError);
+    ASSERT_THROW(engine.ComputeWaypoint({1, 1}, {9, 9}), SimulationError);
+}
+
+TEST_P(RoutingEngineOnDisconnectedGeometry, UnreachableTargetNamesTheAgent)
+{
+    RoutingEngine engine{disconnectedSquares()};
+    engine.SetMode(GetParam());
+    AgentStore agents{};
+    const GenericAgent agent(
+        GenericAgent::ID::Invalid,
+        jps::UniqueID<Journey>::Invalid,
+        jps::UniqueID<BaseStage>::Invalid,
+        {1, 1},
+        {1, 0},
+        CollisionFreeSpeedModelData{});
+    agents[agents.Add(agent)].target = Point{9, 9};
+    WorkerPool pool{};
+    TacticalDecisionSystem tacticalDecisionSystem{};
+
+    try {
+        tacticalDecisionSystem.Run(engine, agents, pool);
+        FAIL() << "Expected SimulationError";
+    } catch(const SimulationError& error) {
+        ASSERT_NE(
+            std::string(error.what()).find(fmt::format("Agent {}", agent.id)), std::string::npos)
+            << error.what();
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllModes,
+    RoutingEngineOnDisconnectedGeometry,
+    ::testing::Values(
+        RoutingMode::SEARCH,
+        RoutingMode::FLOW_FIELD,
+        RoutingMode::POLYANYA,
+        RoutingMode::HIERARCHICAL));
+
+class RoutingEngineThroughNarrowDoor : public ::testing::TestWithParam<RoutingMode>
+{
+};
+
+TEST_P(RoutingEngineThroughNarrowDoor, PathsStayInsideTheGeometry)
+{
+    const auto geometry = roomsWithNarrowDoor();
+    RoutingEngine engine{geometry};
+    engine.SetMode(GetParam());
+    const CollisionGeometry walls{geometry};
+
+    // Paths starting inside the door enter the narrow door as first portal
+    const std::vector<std::pair<Point, Point>> queries{
+        {{0.5, 1}, {3.5, 8}},
+        {{3.5, 1}, {0.5, 8}},
+        {{2.15, 4.5}, {0.5, 8}},
+        {{2.15, 4.5}, {3.5, 1}}};
+    for(const auto& [from, to] : queries) {
+        const auto waypoints = engine.ComputeAllWaypoints(from, to);
+        ASSERT_GE(waypoints.size(), 3);
+        ASSERT_EQ(waypoints.front(), from);
+        ASSERT_EQ(waypoints.back(), to);
+        for(size_t index = 1; index < waypoints.size(); ++index) {
+            ASSERT_FALSE(walls.IntersectsAny(LineSegment{waypoints[index - 1], waypoints[index]}))
+                << fmt::format("segment={}, from={}, to={}", index, from, to);
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllModes,
+    RoutingEngineThroughNarrowDoor,
+    ::testing::Values(
+        RoutingMode::SEARCH,
+        RoutingMode::FLOW_FIELD,
+        RoutingMode::POLYANYA,
+        RoutingMode::HIERARCHICAL));
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AABB.hpp"
+#include "Point.hpp"
+#include "SpaceFillingCurve.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include <vector>
+
+TEST(MortonCode, InterleavesQuantizedCoordinates)
+{
+    const AABB bounds{Point{0, 0}, Point{1, 1}};
+    ASSERT_EQ(MortonCode({0, 0}, bounds), 0u);
+    ASSERT_EQ(MortonCode({1, 0}, bounds), 0x55555555u);
+    ASSERT_EQ(MortonCode({0, 1}, bounds), 0xaaaaaaaau);
+    ASSERT_EQ(MortonCode({1, 1}, bounds), 0xffffffffu);
+    // Outside of the bounds positions are clamped
+    ASSERT_EQ(MortonCode({-5, 7}, bounds), MortonCode({0, 1}, bounds));
+}
+
+TEST(MortonCode, VisitsQuadrantsInZOrder)
+{
+    const AABB bounds{Point{0, 0}, Point{4, 4}};
+    const auto lowerLeft = MortonCode({1, 1}, bounds);
+    const auto lowerRight = MortonCode({3, 1}, bounds);
+    const auto upperLeft = MortonCode({1, 3}, bounds);
+    const auto upperRight = MortonCode({3, 3}, bounds);
+    ASSERT_LT(lowerLeft, lowerRight);
+    ASSERT_LT(lowerRight, upperLeft);
+    ASSERT_LT(upperLeft, upperRight);
+}
+
+TEST(MortonOrder, IsPermutationSortedByCode)
+{
+    std::mt19937 gen{5};
+    std::uniform_real_distribution<double> coordinate{-50, 50};
+    std::vector<Point> positions{};
+    for(int index = 0; index < 1000; ++index) {
+        positions.push_back({coordinate(gen), coordinate(gen)});
+    }
+    // Duplicates need to be ordered by index
+    positions.push_back(positions[3]);
+
+    const auto order = MortonOrder(positions);
+    ASSERT_EQ(order.size(), positions.size());
+    std::vector<size_t> sorted = order;
+    std::sort(std::begin(sorted), std::end(sorted));
+    std::vector<size_t> expected(positions.size());
+    std::iota(std::begin(expected), std::end(expected), 0);
+    ASSERT_EQ(sorted, expected);
+
+    const AABB bounds{positions};
+    for(size_t index = 1; index < order.size(); ++index) {
+        ASSERT_LE(
+            MortonCode(positions[order[index - 1]], bounds),
+            MortonCode(positions[order[index]], bounds));
+    }
+    const auto first = std::find(std::begin(order), std::end(order), 3);
+    ASSERT_EQ(*std::next(first), positions.size() - 1);
+}
+
+TEST(MortonOrder, ReturnsEmptyOnEmpty)
+{
+    ASSERT_TRUE(MortonOrder({}).empty());
+}
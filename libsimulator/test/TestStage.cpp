@@ -1,14 +1,22 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AgentNeighborhoodSearch.hpp"
+#include "AgentStore.hpp"
 #include "GenericAgent.hpp"
 #include "GeometryBuilder.hpp"
 #include "Journey.hpp"
+#include "SimulationError.hpp"
 #include "Stage.hpp"
+#include "StageDescription.hpp"
 #include "gtest/gtest.h"
 
+#include <utility>
+#include <vector>
+
 class StagesTests : public ::testing::Test
 {
 public:
-    NeighborhoodSearch<GenericAgent> neighborhoodSearch{2};
+    AgentStore agents{};
+    AgentNeighborhoodSearch neighborhoodSearch{agents, 2};
     std::unique_ptr<CollisionGeometry> collisionGeometry{};
 
     void SetUp() override
@@ -36,9 +44,10 @@ TEST_F(StagesTests, NotifiableWaitingSetTargetIsCorrect)
             waitingPoints[i],
             {},
             CollisionFreeSpeedModelData{});
-        neighborhoodSearch.AddAgent(agent);
+        const auto index = agents.Add(agent);
+        neighborhoodSearch.AddAgent(index);
 
-        const auto& target = waitingSet.Target(agent);
+        const auto& target = waitingSet.Target(std::as_const(agents)[index]);
         ASSERT_EQ(target, waitingPoints[i]);
 
         waitingSet.Update(neighborhoodSearch, *collisionGeometry);
@@ -53,8 +62,72 @@ TEST_F(StagesTests, NotifiableWaitingSetTargetIsCorrect)
             {},
             {},
             CollisionFreeSpeedModelData{});
-        neighborhoodSearch.AddAgent(agentToLastWaitingSetPos);
-        const auto& target = waitingSet.Target(agentToLastWaitingSetPos);
+        const auto index = agents.Add(agentToLastWaitingSetPos);
+        neighborhoodSearch.AddAgent(index);
+        const auto& target = waitingSet.Target(std::as_const(agents)[index]);
         ASSERT_EQ(target, waitingPoints.back());
     }
 }
+
+static SourceDescription makeSourceDescription(double rate, std::vector<double> spawnTimes = {})
+{
+    return SourceDescription{
+        Polygon({{0, 0}, {2, 0}, {2, 1}, {0, 1}}),
+        rate,
+        std::move(spawnTimes),
+        0,
+        Journey::ID::Invalid,
+        BaseStage::ID::Invalid,
+        Point{1, 0},
+        CollisionFreeSpeedModelData{},
+        42};
+}
+
+TEST(Source, AgentsAreDueAtRate)
+{
+    Source source(makeSourceDescription(2));
+    ASSERT_EQ(source.CountDue(0), 0);
+    ASSERT_EQ(source.CountDue(0.1), 1);
+    ASSERT_EQ(source.CountDue(1.1), 3);
+
+    source.AgentSpawned();
+    source.AgentSpawned();
+    ASSERT_EQ(source.CountDue(1.1), 1);
+    ASSERT_EQ(source.CountSpawned(), 2);
+}
+
+TEST(Source, MaxCountLimitsAgents)
+{
+    auto description = makeSourceDescription(10);
+    description.maxCount = 4;
+    Source source(description);
+    ASSERT_EQ(source.CountDue(100), 4);
+}
+
+TEST(Source, AgentsAreDueAtSpawnTimes)
+{
+    Source source(makeSourceDescription(0, {2, 0.5, 1}));
+    ASSERT_EQ(source.CountDue(0.5), 0);
+    ASSERT_EQ(source.CountDue(0.6), 1);
+    source.AgentSpawned();
+    ASSERT_EQ(source.CountDue(5), 2);
+}
+
+TEST(Source, RequiresRateOrSpawnTimes)
+{
+    ASSERT_THROW(Source(makeSourceDescription(0)), SimulationError);
+    ASSERT_THROW(Source(makeSourceDescription(0, {1, -1})), SimulationError);
+}
+
+TEST(Source, SampledPositionsAreInsideArea)
+{
+    Source source(makeSourceDescription(1));
+    for(int i = 0; i < 100; ++i) {
+        const auto pos = source.SamplePosition();
+        ASSERT_TRUE(pos.has_value());
+        ASSERT_GE(pos->x, 0);
+        ASSERT_LE(pos->x, 2);
+        ASSERT_GE(pos->y, 0);
+        ASSERT_LE(pos->y, 1);
+    }
+}
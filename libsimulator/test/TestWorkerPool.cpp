@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include "WorkerPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+TEST(WorkerPool, ThreadCountIncludesCaller)
+{
+    ASSERT_EQ(WorkerPool{0}.ThreadCount(), 1);
+    ASSERT_EQ(WorkerPool{1}.ThreadCount(), 1);
+    ASSERT_EQ(WorkerPool{4}.ThreadCount(), 4);
+}
+
+TEST(WorkerPool, VisitsEveryIndexExactlyOnce)
+{
+    for(size_t threadCount : {1, 2, 3, 8}) {
+        WorkerPool pool{threadCount};
+        for(size_t count : {0, 1, 2, 7, 1000}) {
+            std::vector<int> visits(count, 0);
+            pool.ParallelFor(count, [&visits](size_t begin, size_t end) {
+                for(auto index = begin; index < end; ++index) {
+                    ++visits[index];
+                }
+            });
+            for(const auto v : visits) {
+                ASSERT_EQ(v, 1);
+            }
+        }
+    }
+}
+
+TEST(WorkerPool, CanBeReusedManyTimes)
+{
+    WorkerPool pool{4};
+    std::vector<size_t> values(257, 0);
+    for(size_t round = 0; round < 100; ++round) {
+        pool.ParallelFor(values.size(), [&values](size_t begin, size_t end) {
+            for(auto index = begin; index < end; ++index) {
+                values[index] += index;
+            }
+        });
+    }
+    for(size_t index = 0; index < values.size(); ++index) {
+        ASSERT_EQ(values[index], 100 * index);
+    }
+}
+
+TEST(WorkerPool, PropagatesExceptions)
+{
+    WorkerPool pool{4};
+    ASSERT_THROW(
+        pool.ParallelFor(
+            100,
+            [](size_t begin, size_t end) {
+                if(begin <= 42 && 42 < end) {
+                    throw std::runtime_error("failed");
+                }
+            }),
+        std::runtime_error);
+
+    size_t sum = 0;
+    pool.ParallelFor(1, [&sum](size_t, size_t) { ++sum; });
+    ASSERT_EQ(sum, 1);
+}
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
+#include "AgentStore.hpp"
 #include "GeneralizedCentrifugalForceModel.hpp"
 #include "GenericAgent.hpp"
+#include "agent_proxy.hpp"
 #include "conversion.hpp"
 
 #include <pybind11/cast.h>
@@ -55,4 +57,30 @@ void init_agent(py::module_& m)
             "model",
             [](GenericAgent& agent) -> auto& { return agent.model; },
             py::return_value_policy::reference);
+    py::class_<AgentProxy>(m, "AgentProxy")
+        .def_property_readonly("id", [](const AgentProxy& proxy) { return proxy.id.getID(); })
+        .def_property_readonly(
+            "journey_id",
+            [](const AgentProxy& proxy) { return proxy.Agent().journeyId.getID(); })
+        .def_property_readonly(
+            "stage_id", [](const AgentProxy& proxy) { return proxy.Agent().stageId.getID(); })
+        .def_property_readonly(
+            "position", [](const AgentProxy& proxy) { return intoTuple(proxy.Agent().pos); })
+        .def_property_readonly(
+            "orientation",
+            [](const AgentProxy& proxy) { return intoTuple(proxy.Agent().orientation); })
+        .def_property(
+            "target",
+            [](const AgentProxy& proxy) { return intoTuple(proxy.Agent().target); },
+            [](const AgentProxy& proxy, std::tuple<double, double> target) {
+                proxy.Agent().target = intoPoint(target);
+            })
+        .def_property_readonly(
+            "model",
+            [](const AgentProxy& proxy) {
+                return proxy.Agent().model.Visit([](auto& model) {
+                    return py::cast(&model, py::return_value_policy::reference);
+                });
+            },
+            py::keep_alive<0, 1>());
 }
@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#pragma once
+
+#include "AgentStore.hpp"
+#include "GenericAgent.hpp"
+#include "Simulation.hpp"
+
+/// Agent of a simulation as seen from Python.
+///
+/// Agents are stored by value in the simulation and move when other agents are added or
+/// removed, hence the proxy only keeps the id and looks the agent up on each access.
+struct AgentProxy {
+    Simulation* simulation;
+    GenericAgent::ID id;
+
+    AgentRef Agent() const { return simulation->Agent(id); }
+};
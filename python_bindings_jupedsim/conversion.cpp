@@ -3,9 +3,15 @@
 
 #include "Point.hpp"
 
+#include <pybind11/numpy.h>
+
+#include <stdexcept>
+#include <string>
 #include <tuple>
 #include <vector>
 
+namespace py = pybind11;
+
 std::tuple<double, double> intoTuple(const Point& p)
 {
     return std::make_tuple(p.x, p.y);
@@ -35,3 +41,17 @@ std::vector<Point> intoPoints(const std::vector<std::tuple<double, double>>& in)
     }
     return points;
 }
+
+std::vector<Point> pointsFromArray(const PointArray& array, const char* name)
+{
+    if(array.ndim() != 2 || array.shape(1) != 2) {
+        throw std::invalid_argument(std::string(name) + " needs to be an array of shape (n, 2)");
+    }
+    const auto data = array.unchecked<2>();
+    std::vector<Point> points{};
+    points.reserve(data.shape(0));
+    for(py::ssize_t index = 0; index < data.shape(0); ++index) {
+        points.emplace_back(data(index, 0), data(index, 1));
+    }
+    return points;
+}
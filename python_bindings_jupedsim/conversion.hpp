@@ -3,9 +3,14 @@
 
 #include <Point.hpp>
 
+#include <pybind11/numpy.h>
+
 #include <tuple>
 #include <vector>
 
+using PointArray =
+    pybind11::array_t<double, pybind11::array::c_style | pybind11::array::forcecast>;
+
 std::tuple<double, double> intoTuple(const Point& p);
 
 std::vector<std::tuple<double, double>> intoTuples(const std::vector<Point>& in);
@@ -14,6 +19,9 @@ Point intoPoint(const std::tuple<double, double>& p);
 
 std::vector<Point> intoPoints(const std::vector<std::tuple<double, double>>& in);
 
+/// Converts an array of shape (n, 2), throws std::invalid_argument mentioning 'name' otherwise.
+std::vector<Point> pointsFromArray(const PointArray& array, const char* name);
+
 template <typename T, typename U>
 std::vector<T> intoVecT(const std::vector<U>& vec)
 {
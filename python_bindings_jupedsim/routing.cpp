@@ -1,15 +1,20 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 #include "CollisionGeometry.hpp"
 #include "RoutingEngine.hpp"
+#include "RoutingMode.hpp"
+#include "SimulationError.hpp"
+#include "WorkerPool.hpp"
 #include "conversion.hpp"
 
 #include <glm/ext/vector_float2.hpp>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h> // IWYU pragma: keep
 
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <tuple>
 #include <vector>
 
@@ -17,6 +22,12 @@ namespace py = pybind11;
 
 void init_routing(py::module_& m)
 {
+    py::enum_<RoutingMode>(m, "RoutingMode")
+        .value("Search", RoutingMode::SEARCH)
+        .value("FlowField", RoutingMode::FLOW_FIELD)
+        .value("Polyanya", RoutingMode::POLYANYA)
+        .value("Hierarchical", RoutingMode::HIERARCHICAL);
+
     py::class_<RoutingEngine>(m, "RoutingEngine")
         .def(py::init([](const CollisionGeometry& geo) {
             return std::make_unique<RoutingEngine>(geo.Polygon());
@@ -28,6 +39,62 @@ void init_routing(py::module_& m)
                std::tuple<double, double> to) {
                 return intoTuples(engine.ComputeAllWaypoints(intoPoint(from), intoPoint(to)));
             })
+        .def(
+            "compute_waypoints_batch",
+            [](const RoutingEngine& engine,
+               const PointArray& origins,
+               const PointArray& destinations,
+               size_t threadCount) {
+                const auto from = pointsFromArray(origins, "origins");
+                const auto to = pointsFromArray(destinations, "destinations");
+                if(from.size() != to.size()) {
+                    throw std::invalid_argument(
+                        "origins and destinations need to have the same length");
+                }
+
+                std::vector<std::vector<Point>> paths(from.size());
+                {
+                    // Route queries only read the engine and never touch Python objects
+                    py::gil_scoped_release release{};
+                    WorkerPool pool{threadCount};
+                    pool.ParallelFor(from.size(), [&](size_t begin, size_t end) {
+                        for(auto index = begin; index < end; ++index) {
+                            // A point outside of the geometry only fails its own query
+                            try {
+                                paths[index] =
+                                    engine.ComputeAllWaypoints(from[index], to[index]);
+                            } catch(const SimulationError&) {
+                                paths[index].clear();
+                            }
+                        }
+                    });
+                }
+
+                // Pack all paths into one array, path 'i' is stored in the rows 'offsets[i]' up
+                // to 'offsets[i + 1]'
+                py::array_t<int64_t> offsets(static_cast<py::ssize_t>(paths.size() + 1));
+                auto offsetData = offsets.mutable_unchecked<1>();
+                int64_t total = 0;
+                offsetData(0) = 0;
+                for(size_t index = 0; index < paths.size(); ++index) {
+                    total += static_cast<int64_t>(paths[index].size());
+                    offsetData(index + 1) = total;
+                }
+                py::array_t<double> points({static_cast<py::ssize_t>(total), py::ssize_t{2}});
+                auto pointData = points.mutable_unchecked<2>();
+                py::ssize_t row = 0;
+                for(const auto& path : paths) {
+                    for(const auto& p : path) {
+                        pointData(row, 0) = p.x;
+                        pointData(row, 1) = p.y;
+                        ++row;
+                    }
+                }
+                return std::make_tuple(points, offsets);
+            },
+            py::arg("origins"),
+            py::arg("destinations"),
+            py::arg("thread_count"))
         .def("is_routable", &RoutingEngine::IsRoutable)
         .def("mesh", [](const RoutingEngine& routingEngine) {
             using Pt = glm::vec2;
@@ -5,16 +5,20 @@
 #include "Journey.hpp"
 #include "OperationalModel.hpp"
 #include "Polygon.hpp"
+#include "RoutingMode.hpp"
 #include "Stage.hpp"
 #include "StageDescription.hpp"
+#include "agent_proxy.hpp"
 #include "conversion.hpp"
 
 #include <pybind11/attr.h>
 #include <pybind11/cast.h>
 #include <pybind11/detail/common.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h> // IWYU pragma: keep
 
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -28,17 +32,34 @@ void init_simulation(py::module_& m)
 {
     py::class_<Simulation>(m, "Simulation")
         .def(
-            py::init([](const OperationalModel* model, CollisionGeometry geometry, double dT) {
+            py::init([](const OperationalModel* model,
+                        CollisionGeometry geometry,
+                        double dT,
+                        size_t threadCount,
+                        RoutingMode routingMode,
+                        double neighborListSkin,
+                        uint64_t agentReorderInterval) {
                 if(!model) {
                     throw std::invalid_argument("model must not be None");
                 }
-                return std::make_unique<Simulation>(
-                    model->Clone(), std::make_unique<CollisionGeometry>(geometry), dT);
+                if(threadCount < 1) {
+                    throw std::invalid_argument("thread_count must be at least 1");
+                }
+                auto simulation = std::make_unique<Simulation>(
+                    model->Clone(), std::make_unique<CollisionGeometry>(geometry), dT, threadCount);
+                simulation->SetRoutingMode(routingMode);
+                simulation->SetNeighborListSkin(neighborListSkin);
+                simulation->SetAgentReorderInterval(agentReorderInterval);
+                return simulation;
             }),
             py::kw_only(),
             py::arg("model"),
             py::arg("geometry"),
-            py::arg("dt"))
+            py::arg("dt"),
+            py::arg("thread_count") = 1,
+            py::arg("routing_mode") = RoutingMode::SEARCH,
+            py::arg("neighbor_list_skin") = 0.0,
+            py::arg("agent_reorder_interval") = 0)
         .def(
             "add_waypoint_stage",
             [](Simulation& sim, std::tuple<double, double> position, double distance) {
@@ -59,6 +80,41 @@ void init_simulation(py::module_& m)
             [](Simulation& sim, const std::vector<std::tuple<double, double>>& polygon) {
                 return sim.AddStage(ExitDescription{Polygon{intoPoints(polygon)}}).getID();
             })
+        .def(
+            "add_source_stage",
+            [](Simulation& sim,
+               const std::vector<std::tuple<double, double>>& polygon,
+               double rate,
+               const std::vector<double>& spawnTimes,
+               size_t maxCount,
+               uint64_t journeyId,
+               uint64_t stageId,
+               std::tuple<double, double> orientation,
+               GenericAgent::Model model,
+               uint64_t seed) {
+                return sim
+                    .AddStage(SourceDescription{
+                        Polygon{intoPoints(polygon)},
+                        rate,
+                        spawnTimes,
+                        maxCount,
+                        journeyId,
+                        stageId,
+                        intoPoint(orientation),
+                        model,
+                        seed})
+                    .getID();
+            },
+            py::kw_only(),
+            py::arg("polygon"),
+            py::arg("rate"),
+            py::arg("spawn_times"),
+            py::arg("max_count"),
+            py::arg("journey_id"),
+            py::arg("stage_id"),
+            py::arg("orientation"),
+            py::arg("model"),
+            py::arg("seed"))
         .def(
             "add_direct_steering_stage",
             [](Simulation& sim) { return sim.AddStage(DirectSteeringDescription{}).getID(); })
@@ -75,9 +131,48 @@ void init_simulation(py::module_& m)
         .def(
             "add_agent",
             [](Simulation& sim, GenericAgent& agent) { return sim.AddAgent(agent).getID(); })
+        .def(
+            "add_agents",
+            [](Simulation& sim,
+               const PointArray& positions,
+               uint64_t journeyId,
+               uint64_t stageId,
+               std::tuple<double, double> orientation,
+               GenericAgent::Model model) {
+                const auto points = pointsFromArray(positions, "positions");
+                std::vector<GenericAgent> agents{};
+                agents.reserve(points.size());
+                for(const auto& point : points) {
+                    agents.emplace_back(
+                        GenericAgent::ID::Invalid,
+                        journeyId,
+                        stageId,
+                        point,
+                        intoPoint(orientation),
+                        model);
+                }
+                const auto ids = sim.AddAgents(agents);
+                py::array_t<uint64_t> result(static_cast<py::ssize_t>(ids.size()));
+                auto resultData = result.mutable_unchecked<1>();
+                for(size_t index = 0; index < ids.size(); ++index) {
+                    resultData(index) = ids[index].getID();
+                }
+                return result;
+            },
+            py::kw_only(),
+            py::arg("positions"),
+            py::arg("journey_id"),
+            py::arg("stage_id"),
+            py::arg("orientation"),
+            py::arg("model"))
         .def(
             "mark_agent_for_removal",
             [](Simulation& sim, uint64_t id) { sim.MarkAgentForRemoval(id); })
+        .def(
+            "mark_agents_for_removal",
+            [](Simulation& sim, const std::vector<uint64_t>& ids) {
+                sim.MarkAgentsForRemoval({std::begin(ids), std::end(ids)});
+            })
         .def("removed_agents", [](const Simulation& sim) {
             auto removed_agent_ids = sim.RemovedAgents();
             auto agent_ids = std::vector<GenericAgent::ID::underlying_type>();
@@ -100,16 +195,36 @@ void init_simulation(py::module_& m)
         .def("agent_count", [](const Simulation& sim) { return sim.AgentCount(); })
         .def("elapsed_time", [](const Simulation& sim) { return sim.ElapsedTime(); })
         .def("delta_time", [](const Simulation& sim) { return sim.DT(); })
+        .def("thread_count", [](const Simulation& sim) { return sim.ThreadCount(); })
+        .def("routing_mode", [](const Simulation& sim) { return sim.GetRoutingMode(); })
+        .def("set_routing_mode", [](Simulation& sim, RoutingMode mode) { sim.SetRoutingMode(mode); })
+        .def("neighbor_list_skin", [](const Simulation& sim) { return sim.NeighborListSkin(); })
+        .def(
+            "agent_reorder_interval",
+            [](const Simulation& sim) { return sim.AgentReorderInterval(); })
         .def("iteration_count", [](const Simulation& sim) { return sim.Iteration(); })
         .def(
             "agents",
-            [](Simulation& sim) { return py::make_iterator(sim.Agents()); },
-            py::keep_alive<0, 1>())
+            [](py::object self) {
+                auto& sim = self.cast<Simulation&>();
+                // A list cannot keep the simulation alive, each agent in it does
+                py::list agents{};
+                for(const auto id : sim.Agents().Ids()) {
+                    auto agent = py::cast(AgentProxy{&sim, id});
+                    py::detail::keep_alive_impl(agent, self);
+                    agents.append(agent);
+                }
+                return agents;
+            })
         .def(
             "agent",
-            [](Simulation& sim, uint64_t agentId) -> auto& { return sim.Agent(agentId); },
+            [](Simulation& sim, uint64_t agentId) {
+                // Throws for unknown agents
+                sim.Agent(agentId);
+                return AgentProxy{&sim, agentId};
+            },
             py::arg("agent_id"),
-            py::return_value_policy::reference)
+            py::keep_alive<0, 1>())
         .def(
             "agents_in_range",
             [](Simulation& sim, std::tuple<double, double> pos, double distance) {
@@ -30,4 +30,5 @@ void init_stage(py::module_& m)
         .def("count_targeting", &WaypointProxy::CountTargeting);
     py::class_<ExitProxy>(m, "ExitProxy").def("count_targeting", &ExitProxy::CountTargeting);
     py::class_<DirectSteeringProxy>(m, "DirectSteeringProxy");
+    py::class_<SourceProxy>(m, "SourceProxy").def("count_spawned", &SourceProxy::CountSpawned);
 }
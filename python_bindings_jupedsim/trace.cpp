@@ -15,10 +15,17 @@ void init_trace(py::module_& m)
         .def_property_readonly(
             "operational_level_duration",
             [](const PerfStats& ps) { return ps.OpDecSystemRunDuration(); })
+        .def_property_readonly(
+            "route_cache_hits", [](const PerfStats& ps) { return ps.RouteCacheHits(); })
+        .def_property_readonly(
+            "route_cache_misses", [](const PerfStats& ps) { return ps.RouteCacheMisses(); })
         .def("__repr__", [](const PerfStats& ps) {
             return fmt::format(
-                "Trace( Iteration: {:d}us, OperationalLevel {:d}us)",
+                "Trace( Iteration: {:d}us, OperationalLevel {:d}us, RouteCache {:d} hits / {:d} "
+                "misses)",
                 ps.IterationDuration(),
-                ps.OpDecSystemRunDuration());
+                ps.OpDecSystemRunDuration(),
+                ps.RouteCacheHits(),
+                ps.RouteCacheMisses());
         });
 }
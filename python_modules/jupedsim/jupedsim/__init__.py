@@ -50,13 +50,14 @@ from jupedsim.models.social_force import (
     SocialForceModelState,
 )
 from jupedsim.recording import Recording, RecordingAgent, RecordingFrame
-from jupedsim.routing import RoutingEngine
+from jupedsim.routing import RoutingEngine, RoutingMode
 from jupedsim.serialization import TrajectoryWriter
 from jupedsim.simulation import Simulation
 from jupedsim.sqlite_serialization import SqliteTrajectoryWriter
 from jupedsim.stages import (
     ExitStage,
     NotifiableQueueStage,
+    SourceStage,
     WaitingSetStage,
     WaitingSetState,
     WaypointStage,
@@ -98,7 +99,9 @@ __all__ = [
     "RecordingAgent",
     "RecordingFrame",
     "RoutingEngine",
+    "RoutingMode",
     "Simulation",
+    "SourceStage",
     "SqliteTrajectoryWriter",
     "Trace",
     "TrajectoryWriter",
@@ -34,5 +34,23 @@ class Trace:
 
         return self._obj.operational_level_duration
 
+    @property
+    def route_cache_hits(self) -> int:
+        """Number of agents whose cached route was reused in the last iteration.
+
+        Returns:
+             Number of route cache hits in the last iteration
+        """
+        return self._obj.route_cache_hits
+
+    @property
+    def route_cache_misses(self) -> int:
+        """Number of agents whose route had to be computed in the last iteration.
+
+        Returns:
+             Number of route cache misses in the last iteration
+        """
+        return self._obj.route_cache_misses
+
     def __str__(self) -> str:
         return self._obj.__repr__()
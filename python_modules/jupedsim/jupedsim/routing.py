@@ -1,13 +1,46 @@
 # SPDX-License-Identifier: LGPL-3.0-or-later
 
+import os
+from enum import Enum
 from typing import Any
 
+import numpy as np
+import numpy.typing as npt
 import shapely
 
 import jupedsim.native as py_jps
 from jupedsim.geometry_utils import build_geometry
 
 
+class RoutingMode(Enum):
+    """Selects how routes of agents are computed.
+
+    SEARCH: Searches the navigation mesh for each agent individually.
+
+    FLOW_FIELD: Computes a distance field over the navigation mesh once per
+    target and lets all agents heading to this target follow it. Preferable
+    when many agents share few targets, e.g. in evacuation scenarios.
+
+    POLYANYA: Searches the merged convex polygons of the navigation mesh for
+    the shortest any-angle path of each agent individually. Finds optimal paths
+    while expanding fewer nodes than SEARCH.
+
+    HIERARCHICAL: Clusters the navigation mesh into regions and searches a
+    graph of precomputed distances between region borders before refining the
+    route inside the regions passed. Routes may be slightly longer than the
+    shortest ones, preferable for city scale geometries.
+
+    In all modes the route of an agent is kept and only straightened from its
+    new position while the agent stays within the triangles the route passes
+    and its target does not change. Otherwise the route is computed again.
+    """
+
+    SEARCH = py_jps.RoutingMode.Search
+    FLOW_FIELD = py_jps.RoutingMode.FlowField
+    POLYANYA = py_jps.RoutingMode.Polyanya
+    HIERARCHICAL = py_jps.RoutingMode.Hierarchical
+
+
 class RoutingEngine:
     """RoutingEngine to compute the shortest paths with navigation meshes."""
 
@@ -58,9 +91,47 @@ class RoutingEngine:
         Returns:
             List of points (path) from 'frm' to 'to' including from and to.
 
+        Raises:
+            :class:`RuntimeError`: if 'frm' or 'to' is outside of the
+                geometry or 'to' cannot be reached from 'frm'.
+
         """
         return self._obj.compute_waypoints(frm, to)
 
+    def compute_waypoints_batch(
+        self,
+        origins: npt.ArrayLike,
+        destinations: npt.ArrayLike,
+        thread_count: int | None = None,
+    ) -> tuple[np.ndarray, np.ndarray]:
+        """Computes shortest paths for many pairs of points at once.
+
+        The queries are distributed on multiple threads and run without
+        holding the GIL.
+
+        Arguments:
+            origins: array of shape (n, 2) with the start points
+            destinations: array of shape (n, 2) with the target points
+            thread_count: number of threads to use, defaults to the number
+                of CPUs
+
+        Returns:
+            Tuple of all path points packed in one array of shape (m, 2) and
+            an array of n + 1 offsets. The path from 'origins[i]' to
+            'destinations[i]' is 'points[offsets[i]:offsets[i + 1]]' and
+            includes start and target. Paths from or to points outside of
+            the geometry and paths to unreachable targets are empty, the
+            other queries of the batch are not affected.
+
+        """
+        if thread_count is None:
+            thread_count = os.cpu_count() or 1
+        return self._obj.compute_waypoints_batch(
+            np.asarray(origins, dtype=np.float64),
+            np.asarray(destinations, dtype=np.float64),
+            thread_count,
+        )
+
     def is_routable(self, p: tuple[float, float]) -> bool:
         """Tests if the supplied point is inside the underlying geometry.
 
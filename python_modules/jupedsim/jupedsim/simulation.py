@@ -2,6 +2,8 @@
 
 from typing import Any, Iterable
 
+import numpy as np
+import numpy.typing as npt
 import shapely
 
 import jupedsim.native as py_jps
@@ -30,15 +32,82 @@ from jupedsim.models.social_force import (
     SocialForceModel,
     SocialForceModelAgentParameters,
 )
+from jupedsim.routing import RoutingMode
 from jupedsim.serialization import TrajectoryWriter
 from jupedsim.stages import (
     ExitStage,
     NotifiableQueueStage,
+    SourceStage,
     WaitingSetStage,
     WaypointStage,
 )
 
 
+def _native_model(parameters):
+    if isinstance(
+        parameters, GeneralizedCentrifugalForceModelAgentParameters
+    ):
+        return py_jps.GeneralizedCentrifugalForceModelState(
+            speed=parameters.speed,
+            desired_direction=parameters.desired_direction,
+            mass=parameters.mass,
+            tau=parameters.tau,
+            desired_speed=parameters.desired_speed,
+            a_v=parameters.a_v,
+            a_min=parameters.a_min,
+            b_min=parameters.b_min,
+            b_max=parameters.b_max,
+        )
+    elif isinstance(parameters, CollisionFreeSpeedModelAgentParameters):
+        return py_jps.CollisionFreeSpeedModelState(
+            time_gap=parameters.time_gap,
+            desired_speed=parameters.desired_speed,
+            radius=parameters.radius,
+        )
+    elif isinstance(parameters, CollisionFreeSpeedModelV2AgentParameters):
+        return py_jps.CollisionFreeSpeedModelV2State(
+            strength_neighbor_repulsion=parameters.strength_neighbor_repulsion,
+            range_neighbor_repulsion=parameters.range_neighbor_repulsion,
+            strength_geometry_repulsion=parameters.strength_geometry_repulsion,
+            range_geometry_repulsion=parameters.range_geometry_repulsion,
+            time_gap=parameters.time_gap,
+            desired_speed=parameters.desired_speed,
+            radius=parameters.radius,
+        )
+    elif isinstance(parameters, AnticipationVelocityModelAgentParameters):
+        return py_jps.AnticipationVelocityModelState(
+            strength_neighbor_repulsion=parameters.strength_neighbor_repulsion,
+            range_neighbor_repulsion=parameters.range_neighbor_repulsion,
+            wall_buffer_distance=parameters.wall_buffer_distance,
+            anticipation_time=parameters.anticipation_time,
+            reaction_time=parameters.reaction_time,
+            time_gap=parameters.time_gap,
+            desired_speed=parameters.desired_speed,
+            radius=parameters.radius,
+        )
+    elif isinstance(parameters, SocialForceModelAgentParameters):
+        return py_jps.SocialForceModelState(
+            velocity=parameters.velocity,
+            mass=parameters.mass,
+            desired_speed=parameters.desired_speed,
+            reaction_time=parameters.reaction_time,
+            agent_scale=parameters.agent_scale,
+            obstacle_scale=parameters.obstacle_scale,
+            force_distance=parameters.force_distance,
+            radius=parameters.radius,
+        )
+
+
+# TODO(kkratz): Some models do not have an orientation as part of their
+# state, but we initially designed it to be. This needs to be first
+# fixed on the C++ Level and then later here. Fix is: Move orientation
+# into model specific data.
+def _orientation_or_zero(param):
+    if hasattr(param, "orientation"):
+        return param.orientation
+    return (0.0, 0.0)
+
+
 class Simulation:
     """Defines a simulation of pedestrian movement over a continuous walkable area.
 
@@ -69,6 +138,10 @@ class Simulation:
         ),
         dt: float = 0.01,
         trajectory_writer: TrajectoryWriter | None = None,
+        thread_count: int = 1,
+        routing_mode: RoutingMode = RoutingMode.SEARCH,
+        neighbor_list_skin: float = 0.0,
+        agent_reorder_interval: int = 0,
         **kwargs: Any,
     ) -> None:
         """Creates a Simulation.
@@ -97,6 +170,21 @@ class Simulation:
                 TrajectoryWriter interface. JuPedSim provides a writer that outputs trajectory data
                 in a sqlite database. If you want other formats such as CSV you need to provide
                 your own custom implementation.
+            thread_count: Number of threads used to compute the movement of
+                the agents. The simulation results do not depend on this
+                value.
+            routing_mode: Defines how the routes of the agents are computed.
+            neighbor_list_skin: Margin in meters added to the interaction
+                range of the model to build neighbor lists, which are
+                reused until an agent moved more than half of the margin.
+                0 disables neighbor lists. Neighbors are then visited in a
+                different order, so results may differ slightly due to
+                floating point rounding.
+            agent_reorder_interval: Number of iterations after which the
+                agents are sorted by their position, so that agents close to
+                each other are also close in memory. 0 disables sorting.
+                Agent ids are not affected, but :meth:`agents` then no
+                longer yields the agents in the order they have been added.
 
         Keyword Arguments:
             excluded_areas: describes exclusions
@@ -140,7 +228,13 @@ class Simulation:
             raise Exception("Unknown model type supplied")
         self._writer = trajectory_writer
         self._obj = py_jps.Simulation(
-            model=py_jps_model, geometry=build_geometry(geometry)._obj, dt=dt
+            model=py_jps_model,
+            geometry=build_geometry(geometry)._obj,
+            dt=dt,
+            thread_count=thread_count,
+            routing_mode=routing_mode.value,
+            neighbor_list_skin=neighbor_list_skin,
+            agent_reorder_interval=agent_reorder_interval,
         )
 
     def add_waypoint_stage(
@@ -222,6 +316,70 @@ class Simulation:
         exit_geometry = build_geometry(polygon)
         return self._obj.add_exit_stage(exit_geometry.boundary())
 
+    def add_source_stage(
+        self,
+        polygon: (
+            str
+            | shapely.GeometryCollection
+            | shapely.Polygon
+            | shapely.MultiPolygon
+            | shapely.MultiPoint
+            | list[tuple[float, float]]
+        ),
+        parameters: (
+            GeneralizedCentrifugalForceModelAgentParameters
+            | CollisionFreeSpeedModelAgentParameters
+            | CollisionFreeSpeedModelV2AgentParameters
+            | AnticipationVelocityModelAgentParameters
+            | SocialForceModelAgentParameters
+        ),
+        *,
+        rate: float | None = None,
+        spawn_times: Iterable[float] | None = None,
+        max_count: int = 0,
+        seed: int = 0,
+    ) -> int:
+        """Add a source stage to the simulation.
+
+        A source creates new agents inside the given polygon, either at a
+        constant rate or at the given spawn times. Agents are placed at random
+        free positions at the beginning of an iteration, without a round trip
+        to Python. If there is no room inside the polygon, agents are delayed
+        until there is.
+
+        New agents use ``parameters`` for everything except their position,
+        they start with the journey and stage given there. A source can not be
+        part of a journey.
+
+        Arguments:
+            polygon: Polygon without holes in which agents are placed, see
+                :func:`add_exit_stage` for the supported formats.
+            parameters: Agent parameters of the new agents, their position is
+                ignored.
+            rate: Agents entering per second.
+            spawn_times: Times in seconds at which one agent each enters,
+                alternative to ``rate``.
+            max_count: Number of agents entering at ``rate``, 0 for no limit.
+            seed: Seed of the random placement of the agents.
+
+        Returns:
+            Id of the added source stage.
+        """
+        if (rate is None) == (spawn_times is None):
+            raise ValueError("Either rate or spawn_times needs to be given")
+        source_geometry = build_geometry(polygon)
+        return self._obj.add_source_stage(
+            polygon=source_geometry.boundary(),
+            rate=0.0 if rate is None else rate,
+            spawn_times=[] if spawn_times is None else list(spawn_times),
+            max_count=max_count,
+            journey_id=parameters.journey_id,
+            stage_id=parameters.stage_id,
+            orientation=_orientation_or_zero(parameters),
+            model=_native_model(parameters),
+            seed=seed,
+        )
+
     def add_direct_steering_stage(self) -> int:
         """Add an direct steering stage to the simulation.
 
@@ -272,77 +430,53 @@ class Simulation:
             Returns:
                 Id of the added agent.
         """
-        if isinstance(
-            parameters, GeneralizedCentrifugalForceModelAgentParameters
-        ):
-            model = py_jps.GeneralizedCentrifugalForceModelState(
-                speed=parameters.speed,
-                desired_direction=parameters.desired_direction,
-                mass=parameters.mass,
-                tau=parameters.tau,
-                desired_speed=parameters.desired_speed,
-                a_v=parameters.a_v,
-                a_min=parameters.a_min,
-                b_min=parameters.b_min,
-                b_max=parameters.b_max,
-            )
-        elif isinstance(parameters, CollisionFreeSpeedModelAgentParameters):
-            model = py_jps.CollisionFreeSpeedModelState(
-                time_gap=parameters.time_gap,
-                desired_speed=parameters.desired_speed,
-                radius=parameters.radius,
-            )
-        elif isinstance(parameters, CollisionFreeSpeedModelV2AgentParameters):
-            model = py_jps.CollisionFreeSpeedModelV2State(
-                strength_neighbor_repulsion=parameters.strength_neighbor_repulsion,
-                range_neighbor_repulsion=parameters.range_neighbor_repulsion,
-                strength_geometry_repulsion=parameters.strength_geometry_repulsion,
-                range_geometry_repulsion=parameters.range_geometry_repulsion,
-                time_gap=parameters.time_gap,
-                desired_speed=parameters.desired_speed,
-                radius=parameters.radius,
-            )
-        elif isinstance(parameters, AnticipationVelocityModelAgentParameters):
-            model = py_jps.AnticipationVelocityModelState(
-                strength_neighbor_repulsion=parameters.strength_neighbor_repulsion,
-                range_neighbor_repulsion=parameters.range_neighbor_repulsion,
-                wall_buffer_distance=parameters.wall_buffer_distance,
-                anticipation_time=parameters.anticipation_time,
-                reaction_time=parameters.reaction_time,
-                time_gap=parameters.time_gap,
-                desired_speed=parameters.desired_speed,
-                radius=parameters.radius,
-            )
-        elif isinstance(parameters, SocialForceModelAgentParameters):
-            model = py_jps.SocialForceModelState(
-                velocity=parameters.velocity,
-                mass=parameters.mass,
-                desired_speed=parameters.desired_speed,
-                reaction_time=parameters.reaction_time,
-                agent_scale=parameters.agent_scale,
-                obstacle_scale=parameters.obstacle_scale,
-                force_distance=parameters.force_distance,
-                radius=parameters.radius,
-            )
-
-        # TODO(kkratz): Some models do not have an orientation as part of their
-        # state, but we initially designed it to be. This needs to be first
-        # fixed on the C++ Level and then later here. Fix is: Move orientation
-        # into model specific data.
-        def orientation_or_zero(param):
-            if hasattr(param, "orientation"):
-                return param.orientation
-            return (0.0, 0.0)
-
         agent = py_jps.Agent(
             journey_id=parameters.journey_id,
             stage_id=parameters.stage_id,
             position=parameters.position,
-            orientation=orientation_or_zero(parameters),
-            model=model,
+            orientation=_orientation_or_zero(parameters),
+            model=_native_model(parameters),
         )
         return self._obj.add_agent(agent)
 
+    def add_agents(
+        self,
+        parameters: (
+            GeneralizedCentrifugalForceModelAgentParameters
+            | CollisionFreeSpeedModelAgentParameters
+            | CollisionFreeSpeedModelV2AgentParameters
+            | AnticipationVelocityModelAgentParameters
+            | SocialForceModelAgentParameters
+        ),
+        positions: npt.ArrayLike,
+    ) -> npt.NDArray[np.uint64]:
+        """Add many agents sharing the same parameters to the simulation.
+
+        Adds one agent per position, all other parameters are taken from
+        ``parameters``, its position is ignored. The agents are validated in
+        parallel, including their distance to each other, and their initial
+        routes are computed in one batch. This is much faster than calling
+        :func:`add_agent` for each agent.
+
+        If any agent is invalid, none of the agents is added and the error of
+        the first invalid agent is raised.
+
+        Arguments:
+            parameters: Agent parameters of the newly added agents, see
+                :func:`add_agent`.
+            positions: Positions of the new agents, array of shape (n, 2).
+
+        Returns:
+            Ids of the added agents, in the order of ``positions``.
+        """
+        return self._obj.add_agents(
+            positions=np.asarray(positions, dtype=np.float64),
+            journey_id=parameters.journey_id,
+            stage_id=parameters.stage_id,
+            orientation=_orientation_or_zero(parameters),
+            model=_native_model(parameters),
+        )
+
     def mark_agent_for_removal(self, agent_id: int):
         """Marks an agent for removal.
 
@@ -357,6 +491,19 @@ class Simulation:
 
         self._obj.mark_agent_for_removal(agent_id)
 
+    def mark_agents_for_removal(self, agent_ids: Iterable[int]):
+        """Marks multiple agents for removal.
+
+        Behaves like :func:`mark_agent_for_removal` for each of the given
+        agents, but crosses into the native simulation only once. If any of
+        the ids is unknown no agent is marked.
+
+        Arguments:
+            agent_ids: Ids of the agents marked for removal
+        """
+
+        self._obj.mark_agents_for_removal([int(agent_id) for agent_id in agent_ids])
+
     def removed_agents(self) -> list[int]:
         """All agents (given by Id) removed in the last iteration.
 
@@ -421,6 +568,30 @@ class Simulation:
         """
         return self._obj.delta_time()
 
+    def thread_count(self) -> int:
+        """Number of threads used to compute the movement of the agents.
+
+        Returns:
+            Number of threads used.
+        """
+        return self._obj.thread_count()
+
+    def neighbor_list_skin(self) -> float:
+        """Margin used to build the neighbor lists, 0 if they are disabled.
+
+        Returns:
+            Neighbor list margin in meters.
+        """
+        return self._obj.neighbor_list_skin()
+
+    def agent_reorder_interval(self) -> int:
+        """Number of iterations after which the agents are sorted by position.
+
+        Returns:
+            Sorting interval in iterations, 0 if sorting is disabled.
+        """
+        return self._obj.agent_reorder_interval()
+
     def iteration_count(self) -> int:
         """Number of iterations performed since start of the simulation.
 
@@ -523,6 +694,8 @@ class Simulation:
                 return NotifiableQueueStage(stage)
             case py_jps.WaitingSetProxy():
                 return WaitingSetStage(stage)
+            case py_jps.SourceProxy():
+                return SourceStage(stage)
             case _:
                 raise Exception(
                     f"Internal error, unexpected type: {type(stage)}"
@@ -554,3 +727,19 @@ class Simulation:
         """
         internal_geometry = build_geometry(geometry)
         self._obj.switch_geometry(internal_geometry._obj)
+
+    def routing_mode(self) -> RoutingMode:
+        """Mode used to compute the routes of the agents.
+
+        Returns:
+            The current routing mode.
+        """
+        return RoutingMode(self._obj.routing_mode())
+
+    def set_routing_mode(self, mode: RoutingMode) -> None:
+        """Change how the routes of the agents are computed.
+
+        Arguments:
+            mode: The routing mode to use from now on.
+        """
+        self._obj.set_routing_mode(mode.value)
@@ -146,3 +146,22 @@ class ExitStage:
             Number of agents currently targeting this stage.
         """
         return self._obj.count_targeting()
+
+
+class SourceStage:
+    """Models a source of new agents.
+
+    Agents are created inside the polygon of the source, either at a constant
+    rate or at given times. Agents that do not find room inside the polygon
+    are delayed until there is room.
+    """
+
+    def __init__(self, backing):
+        self._obj = backing
+
+    def count_spawned(self) -> int:
+        """
+        Returns:
+            Number of agents created by this source so far.
+        """
+        return self._obj.count_spawned()
@@ -0,0 +1,43 @@
+# SPDX-License-Identifier: LGPL-3.0-or-later
+import jupedsim as jps
+import numpy as np
+
+
+def create_room(agent_reorder_interval):
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (20, 0), (20, 20), (0, 20)],
+        agent_reorder_interval=agent_reorder_interval,
+    )
+    exit = simulation.add_exit_stage([(19, 9), (20, 9), (20, 11), (19, 11)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit]))
+    rng = np.random.default_rng(7)
+    positions = rng.permutation(
+        [(x, y) for x in np.arange(1, 15, 0.8) for y in np.arange(1, 19, 0.8)]
+    )
+    agent_ids = [
+        simulation.add_agent(
+            jps.CollisionFreeSpeedModelAgentParameters(
+                position=tuple(position), journey_id=journey_id, stage_id=exit
+            )
+        )
+        for position in positions
+    ]
+    return simulation, agent_ids
+
+
+def test_reordering_does_not_change_agents():
+    expected_simulation, expected_ids = create_room(0)
+    actual_simulation, actual_ids = create_room(10)
+    assert actual_simulation.agent_reorder_interval() == 10
+
+    expected_simulation.iterate(100)
+    actual_simulation.iterate(100)
+
+    assert actual_ids == expected_ids
+    for agent_id in expected_ids:
+        np.testing.assert_allclose(
+            actual_simulation.agent(agent_id).position,
+            expected_simulation.agent(agent_id).position,
+            atol=1e-6,
+        )
@@ -0,0 +1,59 @@
+# SPDX-License-Identifier: LGPL-3.0-or-later
+import jupedsim as jps
+import numpy as np
+import pytest
+
+
+def run_bottleneck(neighbor_list_skin):
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[
+            (0, 0),
+            (10, 0),
+            (10, 4),
+            (12, 4),
+            (12, 6),
+            (10, 6),
+            (10, 10),
+            (0, 10),
+        ],
+        neighbor_list_skin=neighbor_list_skin,
+    )
+    exit = simulation.add_exit_stage([(11.5, 4), (12, 4), (12, 6), (11.5, 6)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit]))
+    for x in np.arange(1, 9, 0.8):
+        for y in np.arange(1, 9, 0.8):
+            simulation.add_agent(
+                jps.CollisionFreeSpeedModelAgentParameters(
+                    position=(x, y), journey_id=journey_id, stage_id=exit
+                )
+            )
+    simulation.iterate(200)
+    return {agent.id: agent.position for agent in simulation.agents()}
+
+
+def test_neighbor_lists_match_grid_queries():
+    expected = run_bottleneck(0)
+    actual = run_bottleneck(0.5)
+
+    assert actual.keys() == expected.keys()
+    for agent_id, position in expected.items():
+        np.testing.assert_allclose(actual[agent_id], position, atol=1e-6)
+
+
+def test_neighbor_list_skin_is_reported():
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (10, 0), (10, 10), (0, 10)],
+        neighbor_list_skin=0.3,
+    )
+    assert simulation.neighbor_list_skin() == pytest.approx(0.3)
+
+
+def test_negative_neighbor_list_skin_is_rejected():
+    with pytest.raises(RuntimeError):
+        jps.Simulation(
+            model=jps.CollisionFreeSpeedModel(),
+            geometry=[(0, 0), (10, 0), (10, 10), (0, 10)],
+            neighbor_list_skin=-1,
+        )
@@ -1,5 +1,6 @@
 # SPDX-License-Identifier: LGPL-3.0-or-later
 import jupedsim as jps
+import numpy as np
 import pytest
 import shapely
 
@@ -356,6 +357,32 @@ def test_get_single_agent_from_simulation():
         assert simulation.agent(agent_id).id == agent_id
 
 
+def test_iterated_agents_outlive_the_simulation():
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (10, 0), (10, 10), (0, 10)],
+    )
+    exit_id = simulation.add_exit_stage([(8, 4), (10, 4), (10, 6), (8, 6)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit_id]))
+    positions = {}
+    for position in [(1, 1), (1, 3), (3, 5)]:
+        agent_id = simulation.add_agent(
+            jps.CollisionFreeSpeedModelAgentParameters(
+                position=position,
+                journey_id=journey_id,
+                stage_id=exit_id,
+            )
+        )
+        positions[agent_id] = position
+
+    assert {agent.id for agent in simulation.agents()} == positions.keys()
+
+    agents = list(simulation.agents())
+    del simulation
+    for agent in agents:
+        assert agent.position == positions[agent.id]
+
+
 def test_get_agent_non_existing_agent_from_simulation():
     messages = []
 
@@ -459,6 +486,102 @@ def test_agent_can_be_removed_from_simulation():
     assert actual_agent_ids == expected_agent_ids
 
 
+def test_agents_can_be_removed_in_bulk():
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (20, 0), (20, 20), (0, 20)],
+    )
+    exit_stage_id = simulation.add_exit_stage(
+        [(18, 18), (20, 18), (20, 20), (18, 20)]
+    )
+    journey_id = simulation.add_journey(
+        jps.JourneyDescription([exit_stage_id])
+    )
+    agent_ids = [
+        simulation.add_agent(
+            jps.CollisionFreeSpeedModelAgentParameters(
+                position=(1 + x, 1 + y),
+                journey_id=journey_id,
+                stage_id=exit_stage_id,
+            )
+        )
+        for x in range(10)
+        for y in range(10)
+    ]
+
+    removed = agent_ids[::3]
+    simulation.mark_agents_for_removal(removed)
+    # marking an agent twice is harmless
+    simulation.mark_agent_for_removal(removed[0])
+    simulation.iterate()
+
+    remaining = {agent.id for agent in simulation.agents()}
+    assert remaining == set(agent_ids) - set(removed)
+
+    with pytest.raises(RuntimeError, match=r"Unknown agent id \d+"):
+        simulation.mark_agents_for_removal([agent_ids[1], removed[1]])
+    simulation.iterate()
+    assert agent_ids[1] in {agent.id for agent in simulation.agents()}
+
+
+def test_agents_can_be_added_in_bulk():
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (20, 0), (20, 20), (0, 20)],
+        thread_count=4,
+    )
+    exit_stage_id = simulation.add_exit_stage(
+        [(18, 18), (20, 18), (20, 20), (18, 20)]
+    )
+    journey_id = simulation.add_journey(
+        jps.JourneyDescription([exit_stage_id])
+    )
+    parameters = jps.CollisionFreeSpeedModelAgentParameters(
+        journey_id=journey_id, stage_id=exit_stage_id, radius=0.2
+    )
+    positions = np.array(
+        [(1 + x, 1 + y) for x in range(10) for y in range(10)], dtype=float
+    )
+
+    agent_ids = simulation.add_agents(parameters, positions)
+
+    assert len(agent_ids) == len(positions)
+    assert simulation.agent_count() == len(positions)
+    for agent_id, position in zip(agent_ids, positions):
+        agent = simulation.agent(agent_id)
+        assert agent.position == pytest.approx(tuple(position))
+        assert agent.stage_id == exit_stage_id
+    simulation.iterate()
+
+
+def test_bulk_add_is_rejected_as_a_whole():
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (20, 0), (20, 20), (0, 20)],
+    )
+    exit_stage_id = simulation.add_exit_stage(
+        [(18, 18), (20, 18), (20, 20), (18, 20)]
+    )
+    journey_id = simulation.add_journey(
+        jps.JourneyDescription([exit_stage_id])
+    )
+    parameters = jps.CollisionFreeSpeedModelAgentParameters(
+        journey_id=journey_id, stage_id=exit_stage_id, radius=0.2
+    )
+
+    with pytest.raises(RuntimeError, match=r"not inside walkable area"):
+        simulation.add_agents(parameters, [(1, 1), (30, 1)])
+    assert simulation.agent_count() == 0
+
+    # the new agents are too close to each other
+    with pytest.raises(RuntimeError, match=r"Model constraint violation"):
+        simulation.add_agents(parameters, [(1, 1), (5, 5), (5.1, 5)])
+    assert simulation.agent_count() == 0
+
+    simulation.add_agents(parameters, [(1, 1), (5, 5)])
+    assert simulation.agent_count() == 2
+
+
 def test_agent_can_not_be_added_outside_geometry():
     messages = []
 
@@ -501,3 +624,65 @@ def test_agent_can_not_be_added_outside_geometry():
                 stage_id=exit_id,
             )
         )
+
+
+@pytest.mark.parametrize(
+    "routing_mode", [jps.RoutingMode.SEARCH, jps.RoutingMode.POLYANYA]
+)
+def test_route_cache_is_reported_in_trace(routing_mode):
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (10, 0), (10, 10), (5, 10), (5, 5), (0, 5)],
+        routing_mode=routing_mode,
+    )
+    exit = simulation.add_exit_stage([(6, 9), (9, 9), (9, 10), (6, 10)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit]))
+    for position in [(1, 1), (1, 3), (3, 1)]:
+        simulation.add_agent(
+            jps.CollisionFreeSpeedModelAgentParameters(
+                position=position,
+                journey_id=journey_id,
+                stage_id=exit,
+            )
+        )
+
+    simulation.set_tracing(True)
+    simulation.iterate()
+    simulation.iterate()
+
+    trace = simulation.get_last_trace()
+    assert trace.route_cache_hits + trace.route_cache_misses == 3
+    assert trace.route_cache_hits > 0
+
+
+@pytest.mark.parametrize(
+    "routing_mode",
+    [
+        jps.RoutingMode.SEARCH,
+        jps.RoutingMode.FLOW_FIELD,
+        jps.RoutingMode.POLYANYA,
+        jps.RoutingMode.HIERARCHICAL,
+    ],
+)
+def test_agents_reach_exit_with_routing_mode(routing_mode):
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (10, 0), (10, 10), (5, 10), (5, 5), (0, 5)],
+        routing_mode=routing_mode,
+    )
+    assert simulation.routing_mode() == routing_mode
+    exit = simulation.add_exit_stage([(6, 9), (9, 9), (9, 10), (6, 10)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit]))
+    for position in [(1, 1), (1, 3), (3, 1), (3, 3)]:
+        simulation.add_agent(
+            jps.CollisionFreeSpeedModelAgentParameters(
+                position=position,
+                journey_id=journey_id,
+                stage_id=exit,
+            )
+        )
+
+    while simulation.agent_count() > 0 and simulation.iteration_count() < 5000:
+        simulation.iterate()
+
+    assert simulation.agent_count() == 0
@@ -1,5 +1,7 @@
 # SPDX-License-Identifier: LGPL-3.0-or-later
 import jupedsim as jps
+import numpy as np
+import pytest
 
 
 def test_routing_engine_with_excluded_areas():
@@ -18,3 +20,53 @@ def test_routing_engine_without_excluded_areas():
     outer = [(0, 0), (100, 0), (100, 100), (0, 100)]
     engine = jps.RoutingEngine(geometry=outer)
     assert engine is not None
+
+
+def test_compute_waypoints_batch_matches_single_queries():
+    engine = jps.RoutingEngine(
+        geometry=[(0, 0), (10, 0), (10, 10), (5, 10), (5, 5), (0, 5)]
+    )
+    origins = np.array([(1, 1), (2, 4), (9, 9)])
+    destinations = np.array([(9, 9), (3, 3), (1, 1)])
+
+    points, offsets = engine.compute_waypoints_batch(
+        origins, destinations, thread_count=2
+    )
+
+    assert offsets.shape == (len(origins) + 1,)
+    assert offsets[0] == 0
+    assert offsets[-1] == len(points)
+    for index, (frm, to) in enumerate(zip(origins, destinations)):
+        expected = engine.compute_waypoints(tuple(frm), tuple(to))
+        path = points[offsets[index] : offsets[index + 1]]
+        np.testing.assert_allclose(path, np.array(expected))
+
+
+def test_compute_waypoints_batch_returns_empty_paths_for_outside_points():
+    engine = jps.RoutingEngine(
+        geometry=[(0, 0), (10, 0), (10, 10), (5, 10), (5, 5), (0, 5)]
+    )
+    origins = np.array([(1, 1), (-5, 1), (1, 1), (2, 4)])
+    destinations = np.array([(9, 9), (9, 9), (1, 8), (3, 3)])
+
+    points, offsets = engine.compute_waypoints_batch(
+        origins, destinations, thread_count=2
+    )
+
+    assert offsets.shape == (len(origins) + 1,)
+    assert offsets[2] == offsets[1]
+    assert offsets[3] == offsets[2]
+    for index in [0, 3]:
+        expected = engine.compute_waypoints(
+            tuple(origins[index]), tuple(destinations[index])
+        )
+        path = points[offsets[index] : offsets[index + 1]]
+        np.testing.assert_allclose(path, np.array(expected))
+
+
+def test_compute_waypoints_batch_rejects_mismatched_inputs():
+    engine = jps.RoutingEngine(geometry=[(0, 0), (10, 0), (10, 10), (0, 10)])
+    with pytest.raises(ValueError):
+        engine.compute_waypoints_batch(
+            np.array([(1, 1), (2, 2)]), np.array([(3, 3)])
+        )
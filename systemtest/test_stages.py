@@ -254,3 +254,97 @@ def test_can_not_add_notifiable_queue_outside_geometry(square_room_5x5):
         match=r"NotifiableQueue point .* not inside walkable area",
     ):
         simulation.add_queue_stage([(2, -2), (-10, -10)])
+
+
+@pytest.fixture
+def corridor_with_exit():
+    simulation = jps.Simulation(
+        model=jps.CollisionFreeSpeedModel(),
+        geometry=[(0, 0), (20, 0), (20, 4), (0, 4)],
+        dt=0.01,
+    )
+    exit_id = simulation.add_exit_stage([(19, 0), (20, 0), (20, 4), (19, 4)])
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit_id]))
+    parameters = jps.CollisionFreeSpeedModelAgentParameters(
+        journey_id=journey_id, stage_id=exit_id, radius=0.2
+    )
+    return simulation, parameters
+
+
+def test_source_spawns_agents_at_rate(corridor_with_exit):
+    simulation, parameters = corridor_with_exit
+    source_id = simulation.add_source_stage(
+        [(0, 0), (3, 0), (3, 4), (0, 4)], parameters, rate=2, max_count=5
+    )
+    source = simulation.get_stage(source_id)
+    assert isinstance(source, jps.SourceStage)
+
+    simulation.iterate()
+    assert source.count_spawned() == 1
+    assert simulation.agent_count() == 1
+
+    simulation.iterate(300)
+    assert source.count_spawned() == 5
+    for agent in simulation.agents():
+        assert agent.journey_id == parameters.journey_id
+        assert agent.stage_id == parameters.stage_id
+
+
+def test_source_spawns_agents_at_spawn_times(corridor_with_exit):
+    simulation, parameters = corridor_with_exit
+    source_id = simulation.add_source_stage(
+        [(0, 0), (3, 0), (3, 4), (0, 4)],
+        parameters,
+        spawn_times=[1.0, 0.0, 0.5, 0.5],
+    )
+    source = simulation.get_stage(source_id)
+
+    simulation.iterate()
+    assert source.count_spawned() == 1
+    simulation.iterate(49)
+    assert source.count_spawned() == 1
+    simulation.iterate()
+    assert source.count_spawned() == 3
+    simulation.iterate(100)
+    assert source.count_spawned() == 4
+
+
+def test_crowded_source_delays_agents(corridor_with_exit):
+    simulation, parameters = corridor_with_exit
+    source_id = simulation.add_source_stage(
+        [(0, 1.5), (1, 1.5), (1, 2.5), (0, 2.5)],
+        parameters,
+        rate=100,
+        max_count=20,
+    )
+    source = simulation.get_stage(source_id)
+
+    simulation.iterate(20)
+    assert 0 < source.count_spawned() < 20
+    while source.count_spawned() < 20 and simulation.iteration_count() < 5000:
+        simulation.iterate()
+    assert source.count_spawned() == 20
+
+
+def test_source_can_not_be_part_of_journey(corridor_with_exit):
+    simulation, parameters = corridor_with_exit
+    source_id = simulation.add_source_stage(
+        [(0, 0), (3, 0), (3, 4), (0, 4)], parameters, rate=1
+    )
+    with pytest.raises(
+        RuntimeError, match=r"Source stages can not be part of a journey"
+    ):
+        simulation.add_journey(jps.JourneyDescription([source_id]))
+
+
+def test_source_requires_either_rate_or_spawn_times(corridor_with_exit):
+    simulation, parameters = corridor_with_exit
+    polygon = [(0, 0), (3, 0), (3, 4), (0, 4)]
+    with pytest.raises(ValueError):
+        simulation.add_source_stage(polygon, parameters)
+    with pytest.raises(ValueError):
+        simulation.add_source_stage(
+            polygon, parameters, rate=1, spawn_times=[0]
+        )
+    with pytest.raises(RuntimeError, match=r"positive rate"):
+        simulation.add_source_stage(polygon, parameters, rate=0)
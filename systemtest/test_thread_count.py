@@ -0,0 +1,73 @@
+# SPDX-License-Identifier: LGPL-3.0-or-later
+import jupedsim as jps
+import pytest
+
+
+def create_bottleneck(model, agent_parameters, thread_count):
+    simulation = jps.Simulation(
+        model=model,
+        geometry=[
+            (0, 0),
+            (10, 0),
+            (10, 4.6),
+            (12, 4.6),
+            (12, 5.4),
+            (10, 5.4),
+            (10, 10),
+            (0, 10),
+        ],
+        thread_count=thread_count,
+    )
+    exit = simulation.add_exit_stage(
+        [(11.5, 4.6), (12, 4.6), (12, 5.4), (11.5, 5.4)]
+    )
+    journey_id = simulation.add_journey(jps.JourneyDescription([exit]))
+    agent_ids = [
+        simulation.add_agent(
+            agent_parameters(
+                position=(x * 0.5, y * 0.5),
+                journey_id=journey_id,
+                stage_id=exit,
+            )
+        )
+        for x in range(2, 19)
+        for y in range(2, 19)
+    ]
+    return simulation, agent_ids
+
+
+@pytest.mark.parametrize(
+    "model, agent_parameters",
+    [
+        (
+            jps.CollisionFreeSpeedModel,
+            jps.CollisionFreeSpeedModelAgentParameters,
+        ),
+        (
+            jps.AnticipationVelocityModel,
+            jps.AnticipationVelocityModelAgentParameters,
+        ),
+    ],
+)
+def test_trajectories_do_not_depend_on_thread_count(model, agent_parameters):
+    expected_simulation, expected_ids = create_bottleneck(
+        model(), agent_parameters, 1
+    )
+    actual_simulation, actual_ids = create_bottleneck(
+        model(), agent_parameters, 4
+    )
+    assert actual_simulation.thread_count() == 4
+
+    # Agents jam in front of the bottleneck, tie breaks are drawn every step
+    for _ in range(50):
+        expected_simulation.iterate(10)
+        actual_simulation.iterate(10)
+        assert (
+            actual_simulation.agent_count()
+            == expected_simulation.agent_count()
+        )
+        for agent in expected_simulation.agents():
+            actual = actual_simulation.agent(agent.id)
+            assert actual.position == agent.position
+            assert actual.orientation == agent.orientation
+    assert actual_ids == expected_ids